@@ -0,0 +1,70 @@
+#pragma once
+
+#include "blas1.h"
+#include "blas2.h"
+#include "blas3.h"
+
+#include <complex.h>
+#include <stddef.h>
+
+// Single precision real kernels (`blas1_saxpy`, `blas2_sgemv`, ...)
+#define BLAS_PREFIX s
+#define BLAS_T float
+#define BLAS_R float
+#define BLAS_COMPLEX 0
+#include "blas_template.h"
+
+// Single precision complex kernels (`blas1_caxpy`, `blas2_cgemv`, ...)
+#define BLAS_PREFIX c
+#define BLAS_T float complex
+#define BLAS_R float
+#define BLAS_COMPLEX 1
+#include "blas_template.h"
+
+// Double precision complex kernels (`blas1_zaxpy`, `blas2_zgemv`, ...)
+#define BLAS_PREFIX z
+#define BLAS_T double complex
+#define BLAS_R double
+#define BLAS_COMPLEX 1
+#include "blas_template.h"
+
+/**
+ * Type-generic front-ends, dispatching to the `s`, `d`, `c` or `z` kernel
+ * based on the element type of the last vector/matrix argument.
+ **/
+#define BLAS_GENERIC(level, name, ptr)                                                             \
+    _Generic(*(ptr),                                                                               \
+        float: level##_s##name,                                                                    \
+        double: level##_d##name,                                                                   \
+        float complex: level##_c##name,                                                            \
+        double complex: level##_z##name)
+
+// Real-only kernels
+#define BLAS_GENERIC_REAL(level, name, ptr)                                                        \
+    _Generic(*(ptr), float: level##_s##name, double: level##_d##name)
+
+#define blas1_axpy(len, a, x, y) BLAS_GENERIC(blas1, axpy, y)(len, a, x, y)
+#define parallel_blas1_axpy(len, a, x, y) BLAS_GENERIC(parallel_blas1, axpy, y)(len, a, x, y)
+#define blas1_scal(len, a, x) BLAS_GENERIC(blas1, scal, x)(len, a, x)
+#define parallel_blas1_scal(len, a, x) BLAS_GENERIC(parallel_blas1, scal, x)(len, a, x)
+#define blas1_copy(len, x, y) BLAS_GENERIC(blas1, copy, y)(len, x, y)
+#define parallel_blas1_copy(len, x, y) BLAS_GENERIC(parallel_blas1, copy, y)(len, x, y)
+#define blas1_dot(len, x, y) BLAS_GENERIC(blas1, dot, y)(len, x, y)
+#define parallel_blas1_dot(len, x, y) BLAS_GENERIC(parallel_blas1, dot, y)(len, x, y)
+#define blas1_nrm2(len, x) BLAS_GENERIC(blas1, nrm2, x)(len, x)
+#define parallel_blas1_nrm2(len, x) BLAS_GENERIC(parallel_blas1, nrm2, x)(len, x)
+#define blas1_max(len, x) BLAS_GENERIC_REAL(blas1, max, x)(len, x)
+#define parallel_blas1_max(len, x) BLAS_GENERIC_REAL(parallel_blas1, max, x)(len, x)
+
+#define blas2_gemv(m, n, alpha, A, x, beta, y)                                                     \
+    BLAS_GENERIC(blas2, gemv, y)(m, n, alpha, A, x, beta, y)
+#define parallel_blas2_gemv(m, n, alpha, A, x, beta, y)                                            \
+    BLAS_GENERIC(parallel_blas2, gemv, y)(m, n, alpha, A, x, beta, y)
+#define blas2_ger(m, n, alpha, A, x, yT) BLAS_GENERIC(blas2, ger, A)(m, n, alpha, A, x, yT)
+#define parallel_blas2_ger(m, n, alpha, A, x, yT)                                                  \
+    BLAS_GENERIC(parallel_blas2, ger, A)(m, n, alpha, A, x, yT)
+
+#define blas3_gemm(l, m, n, alpha, A, B, beta, C)                                                  \
+    BLAS_GENERIC(blas3, gemm, C)(l, m, n, alpha, A, B, beta, C)
+#define parallel_blas3_gemm(l, m, n, alpha, A, B, beta, C)                                         \
+    BLAS_GENERIC(parallel_blas3, gemm, C)(l, m, n, alpha, A, B, beta, C)
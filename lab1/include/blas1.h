@@ -1,7 +1,40 @@
 #pragma once
 
+#include "matrix.h"
+
 #include <stddef.h>
 
+/**
+ * Size in bytes of the output vector from which the `dcopy` routine switches
+ * to non-temporal stores.
+ *
+ * Past the last level cache, writing an output-only vector through the cache
+ * costs an extra read-for-ownership of every line. Streaming stores bypass the
+ * cache hierarchy and write full lines directly to memory instead.
+ *
+ * The in-place `daxpy` and `dscal` routines already load every line they
+ * write, so they only stream when the `*_stream` variants are called
+ * explicitly.
+ **/
+#ifndef BLAS1_STREAM_THRESHOLD
+    #define BLAS1_STREAM_THRESHOLD (32 * 1024 * 1024)
+#endif
+
+/**
+ * Sets the size in bytes of the output vector from which the `dcopy` routine
+ * uses non-temporal stores.
+ *
+ * Setting it to `SIZE_MAX` always selects the regular (cached) path, setting
+ * it to 0 always selects the streaming path.
+ **/
+void blas1_set_stream_threshold(size_t nb_bytes);
+
+/**
+ * Returns the size in bytes of the output vector from which the `dcopy`
+ * routine uses non-temporal stores.
+ **/
+size_t blas1_get_stream_threshold();
+
 /**
  * Computes a double precision scalar-vector product and adds the result to a
  * vector.
@@ -30,6 +63,104 @@ void blas1_daxpy(size_t len, double a, double const* x, double* y);
  **/
 void parallel_blas1_daxpy(size_t len, double a, double const* x, double* y);
 
+/**
+ * Computes a double precision scalar-vector product and adds the result to a
+ * vector, writing `y` with non-temporal stores.
+ *
+ * Only worth it when `y` is not reused afterwards, as it is evicted from the
+ * cache hierarchy. The stores are fenced before returning.
+ **/
+void blas1_daxpy_stream(size_t len, double a, double const* x, double* y);
+
+/**
+ * Computes a double precision scalar-vector product and adds the result to a
+ * vector in parallel using OpenMP, writing `y` with non-temporal stores.
+ *
+ * Only worth it when `y` is not reused afterwards, as it is evicted from the
+ * cache hierarchy. The stores are fenced before returning.
+ **/
+void parallel_blas1_daxpy_stream(size_t len, double a, double const* x, double* y);
+
+/**
+ * Scales a double precision vector by a scalar.
+ *
+ * The `dscal` routine performs a vector operation defined as:
+ *   x = a * x
+ *
+ * Where:
+ * - `a` is a scalar.
+ * - `x` is a vector.
+ * - `len` is the number of elements in the vector.
+ **/
+void blas1_dscal(size_t len, double a, double* x);
+
+/**
+ * Scales a double precision vector by a scalar in parallel using OpenMP.
+ *
+ * The `dscal` routine performs a vector operation defined as:
+ *   x = a * x
+ *
+ * Where:
+ * - `a` is a scalar.
+ * - `x` is a vector.
+ * - `len` is the number of elements in the vector.
+ **/
+void parallel_blas1_dscal(size_t len, double a, double* x);
+
+/**
+ * Scales a double precision vector by a scalar, writing `x` with non-temporal
+ * stores.
+ **/
+void blas1_dscal_stream(size_t len, double a, double* x);
+
+/**
+ * Scales a double precision vector by a scalar in parallel using OpenMP,
+ * writing `x` with non-temporal stores.
+ **/
+void parallel_blas1_dscal_stream(size_t len, double a, double* x);
+
+/**
+ * Copies a double precision vector into another.
+ *
+ * The `dcopy` routine performs a vector operation defined as:
+ *   y = x
+ *
+ * Where:
+ * - `x` and `y` are vectors.
+ * - `len` is the number of elements in the vectors.
+ *
+ * Switches to non-temporal stores when `y` is larger than the stream
+ * threshold.
+ **/
+void blas1_dcopy(size_t len, double const* x, double* y);
+
+/**
+ * Copies a double precision vector into another in parallel using OpenMP.
+ *
+ * The `dcopy` routine performs a vector operation defined as:
+ *   y = x
+ *
+ * Where:
+ * - `x` and `y` are vectors.
+ * - `len` is the number of elements in the vectors.
+ *
+ * Switches to non-temporal stores when `y` is larger than the stream
+ * threshold.
+ **/
+void parallel_blas1_dcopy(size_t len, double const* x, double* y);
+
+/**
+ * Copies a double precision vector into another, writing `y` with
+ * non-temporal stores.
+ **/
+void blas1_dcopy_stream(size_t len, double const* x, double* y);
+
+/**
+ * Copies a double precision vector into another in parallel using OpenMP,
+ * writing `y` with non-temporal stores.
+ **/
+void parallel_blas1_dcopy_stream(size_t len, double const* x, double* y);
+
 /**
  * Computes a double precision vector-vector dot product.
  *
@@ -114,3 +245,40 @@ double blas1_dmax(size_t len, double const* x);
  * branching.
  **/
 double parallel_blas1_dmax(size_t len, double const* x);
+
+/**
+ * Computes a scalar-vector product and adds the result to a vector, both
+ * stored in bfloat16.
+ *
+ * The `daxpy_bf16` routine performs a vector-vector operation defined as:
+ *   y = a * x + y
+ *
+ * Elements are widened to single precision in registers, the result is
+ * computed in single precision and rounded back to bfloat16 when stored. It
+ * moves a quarter of the bytes of `blas1_daxpy`.
+ **/
+void blas1_daxpy_bf16(size_t len, double a, bf16_t const* x, bf16_t* y);
+
+/**
+ * Computes a scalar-vector product and adds the result to a vector, both
+ * stored in bfloat16, in parallel using OpenMP.
+ **/
+void parallel_blas1_daxpy_bf16(size_t len, double a, bf16_t const* x, bf16_t* y);
+
+/**
+ * Computes a vector-vector dot product of two vectors stored in bfloat16.
+ *
+ * The `ddot_bf16` routine performs a vector-vector operation defined as:
+ *   res = x * y
+ *
+ * Elements are widened to single precision in registers, where their products
+ * are exact, and accumulated in single precision. It moves a quarter of the
+ * bytes of `blas1_ddot`.
+ **/
+double blas1_ddot_bf16(size_t len, bf16_t const* x, bf16_t const* y);
+
+/**
+ * Computes a vector-vector dot product of two vectors stored in bfloat16 in
+ * parallel using OpenMP.
+ **/
+double parallel_blas1_ddot_bf16(size_t len, bf16_t const* x, bf16_t const* y);
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "matrix.h"
+
 #include <stddef.h>
 
 /**
@@ -67,3 +69,24 @@ void blas2_dger(size_t m, size_t n, double alpha, double* restrict A, double con
  **/
 void parallel_blas2_dger(size_t m, size_t n, double alpha, double* restrict A,
                          double const* restrict x, double const* restrict yT);
+
+/**
+ * Computes a matrix-vector product, with `A` and `x` stored in bfloat16, and
+ * adds the result to the double precision `y` vector.
+ *
+ * The `dgemv_bf16` routine performs a matrix-vector operation defined as:
+ *   y = alpha * A * x + beta * y
+ *
+ * Elements of `A` and `x` are widened to single precision in registers and
+ * each row is accumulated in single precision. It moves a quarter of the bytes
+ * of `blas2_dgemv`.
+ **/
+void blas2_dgemv_bf16(size_t m, size_t n, double alpha, bf16_t const* restrict A,
+                      bf16_t const* restrict x, double beta, double* restrict y);
+
+/**
+ * Computes a matrix-vector product, with `A` and `x` stored in bfloat16, and
+ * adds the result to the double precision `y` vector in parallel using OpenMP.
+ **/
+void parallel_blas2_dgemv_bf16(size_t m, size_t n, double alpha, bf16_t const* restrict A,
+                               bf16_t const* restrict x, double beta, double* restrict y);
@@ -0,0 +1,207 @@
+/**
+ * Declaration template of the BLAS kernels, instantiated once per precision
+ * by `blas.h`.
+ *
+ * Before including this file, define:
+ * - `BLAS_PREFIX` to the precision prefix (`s`, `c` or `z`).
+ * - `BLAS_T` to the element type (e.g. `float complex` for `c`).
+ * - `BLAS_R` to the matching real type (e.g. `float` for `c`).
+ * - `BLAS_COMPLEX` to 1 for complex precisions, 0 otherwise.
+ *
+ * These macros are undefined at the end of the file.
+ *
+ * The double precision kernels are not instantiated from this template: they
+ * are the hand-tuned ones from `blas1.h`, `blas2.h` and `blas3.h`.
+ *
+ * No `#pragma once` on purpose.
+ **/
+
+#ifndef BLAS_CAT
+    #define BLAS_CAT_(a, b, c) a##_##b##c
+    #define BLAS_CAT(a, b, c) BLAS_CAT_(a, b, c)
+    #define BLAS_FN(level, name) BLAS_CAT(level, BLAS_PREFIX, name)
+#endif
+
+/**
+ * Computes a scalar-vector product and adds the result to a vector.
+ *
+ * The `?axpy` routine performs a vector-vector operation defined as:
+ *   y = a * x + y
+ *
+ * Where:
+ * - `a` is a scalar.
+ * - `x` and `y` are vectors.
+ * - `len` is the number of elements in the vectors.
+ **/
+void BLAS_FN(blas1, axpy)(size_t len, BLAS_T a, BLAS_T const* x, BLAS_T* y);
+
+/**
+ * Computes a scalar-vector product and adds the result to a vector in
+ * parallel using OpenMP.
+ **/
+void BLAS_FN(parallel_blas1, axpy)(size_t len, BLAS_T a, BLAS_T const* x, BLAS_T* y);
+
+/**
+ * Scales a vector by a scalar.
+ *
+ * The `?scal` routine performs a vector operation defined as:
+ *   x = a * x
+ *
+ * Where:
+ * - `a` is a scalar.
+ * - `x` is a vector.
+ * - `len` is the number of elements in the vector.
+ **/
+void BLAS_FN(blas1, scal)(size_t len, BLAS_T a, BLAS_T* x);
+
+/**
+ * Scales a vector by a scalar in parallel using OpenMP.
+ **/
+void BLAS_FN(parallel_blas1, scal)(size_t len, BLAS_T a, BLAS_T* x);
+
+/**
+ * Copies a vector into another.
+ *
+ * The `?copy` routine performs a vector operation defined as:
+ *   y = x
+ *
+ * Where:
+ * - `x` and `y` are vectors.
+ * - `len` is the number of elements in the vectors.
+ **/
+void BLAS_FN(blas1, copy)(size_t len, BLAS_T const* x, BLAS_T* y);
+
+/**
+ * Copies a vector into another in parallel using OpenMP.
+ **/
+void BLAS_FN(parallel_blas1, copy)(size_t len, BLAS_T const* x, BLAS_T* y);
+
+/**
+ * Computes a vector-vector dot product.
+ *
+ * The `?dot` routine performs a vector-vector operation defined as:
+ *   res = xH * y
+ *
+ * Where:
+ * - `x` and `y` are vectors (`x` is conjugated for complex precisions, as in
+ *   the `?dotc` routines of the reference BLAS).
+ * - `len` is the number of elements in the vectors.
+ **/
+BLAS_T BLAS_FN(blas1, dot)(size_t len, BLAS_T const* x, BLAS_T const* y);
+
+/**
+ * Computes a vector-vector dot product in parallel using OpenMP.
+ **/
+BLAS_T BLAS_FN(parallel_blas1, dot)(size_t len, BLAS_T const* x, BLAS_T const* y);
+
+/**
+ * Computes the Euclidean/L2 norm of a vector.
+ *
+ * The `?nrm2` routine performs a vector reduction operation defined as:
+ *   res = ||x||
+ *
+ * Where:
+ * - `x` is a vector.
+ * - `len` is the number of elements in the vector.
+ **/
+BLAS_R BLAS_FN(blas1, nrm2)(size_t len, BLAS_T const* x);
+
+/**
+ * Computes the Euclidean/L2 norm of a vector in parallel using OpenMP.
+ **/
+BLAS_R BLAS_FN(parallel_blas1, nrm2)(size_t len, BLAS_T const* x);
+
+#if !BLAS_COMPLEX
+/**
+ * Finds the maximum element of a vector (real precisions only).
+ *
+ * The `?max` routine performs a vector reduction operation defined as:
+ *   res = max(x)
+ *
+ * Where:
+ * - `x` is a vector.
+ * - `len` is the number of elements in the vector.
+ **/
+BLAS_T BLAS_FN(blas1, max)(size_t len, BLAS_T const* x);
+
+/**
+ * Finds the maximum element of a vector in parallel using OpenMP (real
+ * precisions only).
+ **/
+BLAS_T BLAS_FN(parallel_blas1, max)(size_t len, BLAS_T const* x);
+#endif
+
+/**
+ * Computes a matrix-vector product and adds the result to the `y` vector.
+ *
+ * The `?gemv` routine performs a matrix-vector operation defined as:
+ *   y = alpha * A * x + beta * y
+ *
+ * Where:
+ * - `alpha` and `beta` are scalars.
+ * - `x` and `y` are vectors.
+ * - `A` is a matrix.
+ * - `m` is the number of elements in the matrix rows.
+ * - `n` is the number of elements in the matrix columns and in the vectors.
+ **/
+void BLAS_FN(blas2, gemv)(size_t m, size_t n, BLAS_T alpha, BLAS_T const* restrict A,
+                          BLAS_T const* restrict x, BLAS_T beta, BLAS_T* restrict y);
+
+/**
+ * Computes a matrix-vector product and adds the result to the `y` vector in
+ * parallel using OpenMP.
+ **/
+void BLAS_FN(parallel_blas2, gemv)(size_t m, size_t n, BLAS_T alpha, BLAS_T const* restrict A,
+                                   BLAS_T const* restrict x, BLAS_T beta, BLAS_T* restrict y);
+
+/**
+ * Performs a rank-1 update of a matrix.
+ *
+ * The `?ger` routine performs a matrix-vector operation defined as:
+ *   A = alpha * x * yT + A
+ *
+ * Where:
+ * - `alpha` is a scalar.
+ * - `x` and `yT` are vectors (`yT` is transposed, not conjugated).
+ * - `A` is a matrix.
+ * - `m` is the number of elements in the matrix rows.
+ * - `n` is the number of elements in the matrix columns and in the vectors.
+ **/
+void BLAS_FN(blas2, ger)(size_t m, size_t n, BLAS_T alpha, BLAS_T* restrict A,
+                         BLAS_T const* restrict x, BLAS_T const* restrict yT);
+
+/**
+ * Performs a rank-1 update of a matrix in parallel using OpenMP.
+ **/
+void BLAS_FN(parallel_blas2, ger)(size_t m, size_t n, BLAS_T alpha, BLAS_T* restrict A,
+                                  BLAS_T const* restrict x, BLAS_T const* restrict yT);
+
+/**
+ * Computes a matrix-matrix product and adds the result to the `C` matrix.
+ *
+ * The `?gemm` routine performs a matrix-matrix operation defined as:
+ *   C = alpha * A * B + beta * C
+ *
+ * Where:
+ * - `alpha` and `beta` are scalars.
+ * - `A`, `B` and `C` are matrices.
+ * - `l` is the number of elements in the rows of the `A` and `C` matrices.
+ * - `m` is the number of elements in the columns of the `B` and `C` matrices.
+ * - `n` is the number of elements in the columns of the `A` matrix and in the
+ *   rows of the `B` matrix.
+ **/
+void BLAS_FN(blas3, gemm)(size_t l, size_t m, size_t n, BLAS_T alpha, BLAS_T const* restrict A,
+                          BLAS_T const* restrict B, BLAS_T beta, BLAS_T* restrict C);
+
+/**
+ * Computes a matrix-matrix product and adds the result to the `C` matrix in
+ * parallel using OpenMP.
+ **/
+void BLAS_FN(parallel_blas3, gemm)(size_t l, size_t m, size_t n, BLAS_T alpha,
+                                   BLAS_T const* restrict A, BLAS_T const* restrict B, BLAS_T beta,
+                                   BLAS_T* restrict C);
+
+#undef BLAS_PREFIX
+#undef BLAS_T
+#undef BLAS_R
+#undef BLAS_COMPLEX
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "matrix.h"
 #include "utils.h"
 
 #include <stdbool.h>
@@ -22,9 +23,12 @@ typedef enum blas_level_e {
 
 typedef struct config_s {
     bool is_verbose;
+    bool is_tuning;
     blas_level_t blas_level;
     size_t nb_threads;
     size_t nb_reps;
+    size_t prefetch_dist;
+    alloc_policy_t hugepages;
     char* output_filename;
     union {
         size_t len;
@@ -5,6 +5,13 @@
 #include "stats.h"
 
 stats_t* driver_daxpy(config_t cfg, double alpha, vector_t* x, vector_t* y);
+stats_t* driver_daxpy_stream(config_t cfg, double alpha, vector_t* x, vector_t* y);
+stats_t* driver_dscal(config_t cfg, double alpha, vector_t* x);
+stats_t* driver_dscal_stream(config_t cfg, double alpha, vector_t* x);
+stats_t* driver_dcopy(config_t cfg, vector_t* x, vector_t* y);
+stats_t* driver_dcopy_stream(config_t cfg, vector_t* x, vector_t* y);
+stats_t* driver_daxpy_bf16(config_t cfg, double alpha, vector_t* x, vector_t* y);
+stats_t* driver_ddot_bf16(config_t cfg, vector_t* x, vector_t* y);
 stats_t* driver_ddot(config_t cfg, vector_t* x, vector_t* y);
 stats_t* driver_dnrm2(config_t cfg, vector_t* x);
 stats_t* driver_dmax(config_t cfg, vector_t* x);
@@ -14,8 +21,34 @@ stats_t* driver_dgemv(config_t cfg, double alpha, matrix_t* A, vector_t* x, doub
 stats_t* driver_dgemv_var(config_t cfg, double alpha, matrix_t* A, vector_t* x, double beta,
                           vector_t* y);
 stats_t* driver_dger(config_t cfg, double alpha, matrix_t* A, vector_t* x, vector_t* yT);
+stats_t* driver_dgemv_bf16(config_t cfg, double alpha, matrix_t* A, vector_t* x, double beta,
+                           vector_t* y);
+stats_t* driver_dgemv_hugepages(config_t cfg, double alpha, matrix_t* A, vector_t* x, double beta,
+                                vector_t* y);
+
+/**
+ * Single precision `sgemv` on a copy of the operands, with its relative error
+ * against `blas2_dgemv`.
+ **/
+stats_t* driver_sgemv(config_t cfg, double alpha, matrix_t* A, vector_t* x, double beta,
+                      vector_t* y);
 
 stats_t* driver_dgemm(config_t cfg, double alpha, matrix_t* A, matrix_t* B, double beta,
                       matrix_t* C);
 stats_t* driver_dgemm_var(config_t cfg, double alpha, matrix_t* A, matrix_t* B, double beta,
                           matrix_t* C);
+stats_t* driver_dgemm_hugepages(config_t cfg, double alpha, matrix_t* A, matrix_t* B, double beta,
+                                matrix_t* C);
+
+/**
+ * Double precision complex `zgemm` on operands built from `A` and `B`, with
+ * its relative error against a product assembled from `blas2_dgemv`.
+ **/
+stats_t* driver_zgemm(config_t cfg, double alpha, matrix_t* A, matrix_t* B, double beta);
+
+/**
+ * Sweeps the software prefetch distance of every streaming kernel, for a
+ * working set in each size class, and records the fastest one in the prefetch
+ * table used by the kernels.
+ **/
+void driver_prefetch_tune(config_t cfg);
@@ -1,15 +1,43 @@
 #pragma once
 
 #include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// Size of a transparent/explicit huge page on x86-64
+#define HUGEPAGE_SIZE (2UL * 1024 * 1024)
+
+/**
+ * Policy used to allocate the elements of new matrices:
+ * - `ALLOC_DEFAULT`: `aligned_alloc`, backed by regular 4 KiB pages.
+ * - `ALLOC_THP`: anonymous `mmap` aligned on `HUGEPAGE_SIZE` and advised with
+ *   `MADV_HUGEPAGE`, so that the kernel backs it with transparent huge pages.
+ * - `ALLOC_HUGETLBFS`: explicit huge pages from the hugetlbfs pool
+ *   (`MAP_HUGETLB`), which must have been reserved beforehand.
+ *
+ * Allocations smaller than `HUGEPAGE_SIZE` always use `ALLOC_DEFAULT`. If a
+ * policy is not available, allocation falls back to the next one down the
+ * list (`ALLOC_HUGETLBFS`, then `ALLOC_THP`, then `ALLOC_DEFAULT`).
+ **/
+typedef enum alloc_policy_e {
+    ALLOC_DEFAULT,
+    ALLOC_THP,
+    ALLOC_HUGETLBFS,
+} alloc_policy_t;
 
 /**
  * Represents a matrix storing double precision floating-point values stored
  * contiguously in memory, of dimensions `rows * cols`.
+ *
+ * `alloc` is the policy its elements were actually allocated with, and
+ * `alloc_size` the number of bytes mapped for them (0 when on the heap).
  **/
 typedef struct matrix_s {
     double* data;
     size_t rows;
     size_t cols;
+    alloc_policy_t alloc;
+    size_t alloc_size;
 } matrix_t;
 
 /**
@@ -18,6 +46,69 @@ typedef struct matrix_s {
  **/
 typedef matrix_t vector_t;
 
+/**
+ * Represents a bfloat16 value: the upper half of an IEEE-754 single precision
+ * float (same exponent range, 8 bits of mantissa).
+ *
+ * Used as a compressed storage format for bandwidth-bound kernels, which widen
+ * it to `float` in registers and never compute in it.
+ **/
+typedef uint16_t bf16_t;
+
+/**
+ * Represents a matrix storing bfloat16 values stored contiguously in memory,
+ * of dimensions `rows * cols`.
+ **/
+typedef struct matrix_bf16_s {
+    bf16_t* data;
+    size_t rows;
+    size_t cols;
+} matrix_bf16_t;
+
+/**
+ * Represents a vector storing bfloat16 values.
+ * Actually just a matrix with one of its dimensions set to 1.
+ **/
+typedef matrix_bf16_t vector_bf16_t;
+
+/**
+ * Widens a bfloat16 value to single precision (exact).
+ **/
+static inline float bf16_to_float(bf16_t h)
+{
+    uint32_t bits = (uint32_t)(h) << 16;
+    float f;
+    memcpy(&f, &bits, sizeof(f));
+    return f;
+}
+
+/**
+ * Narrows a single precision value to bfloat16, rounding to nearest even.
+ **/
+static inline bf16_t bf16_from_float(float f)
+{
+    uint32_t bits;
+    memcpy(&bits, &f, sizeof(bits));
+    bits += 0x7FFF + ((bits >> 16) & 1);
+    return (bf16_t)(bits >> 16);
+}
+
+/**
+ * Sets the policy used to allocate the elements of the matrices created
+ * afterwards, see `alloc_policy_t`.
+ **/
+void matrix_set_alloc_policy(alloc_policy_t policy);
+
+/**
+ * Returns the current allocation policy of new matrices.
+ **/
+alloc_policy_t matrix_get_alloc_policy(void);
+
+/**
+ * Returns a printable name for an allocation policy.
+ **/
+char const* alloc_policy_to_str(alloc_policy_t policy);
+
 /**
  * Creates a new column vector of `len` elements, initialized with zeroes.
  **/
@@ -47,9 +138,18 @@ vector_t* vector_rand_init(size_t len);
 /**
  * Creates a new matrix of `rows * cols` elements, initialized with random
  * values ranging in the interval of ]-1.0, 1.0[.
+ *
+ * Elements are drawn in parallel from a counter-based generator, so the
+ * result only depends on the seed and on the number of matrices initialized
+ * since it was set, not on the number of threads.
  **/
 matrix_t* matrix_rand_init(size_t rows, size_t cols);
 
+/**
+ * Sets the seed of `matrix_rand_init` and restarts its sequence of matrices.
+ **/
+void matrix_rand_seed(uint64_t seed);
+
 /**
  * Deallocates a vector.
  **/
@@ -66,10 +166,16 @@ void matrix_deinit(matrix_t* self);
 void vector_transpose(vector_t* self);
 
 /**
- * Transposes a matrix.
+ * Transposes a matrix. `transposed` must hold as many elements as `self` and
+ * gets its dimensions swapped.
  **/
 void matrix_transpose(matrix_t const* self, matrix_t* transposed);
 
+/**
+ * Transposes a matrix in place, without allocating a second matrix.
+ **/
+void matrix_transpose_inplace(matrix_t* self);
+
 /**
  * Prints a given vector.
  **/
@@ -83,3 +189,28 @@ void print_matrix(matrix_t const* self, char const* name);
 size_t matrix_nb_elems(matrix_t const* self);
 size_t vector_nb_elems(vector_t const* self);
 matrix_t* matrix_copy(matrix_t const* self);
+
+/**
+ * Creates a bfloat16 copy of a matrix, rounding every element to nearest even.
+ **/
+matrix_bf16_t* matrix_to_bf16(matrix_t const* self);
+
+/**
+ * Creates a bfloat16 copy of a vector, rounding every element to nearest even.
+ **/
+vector_bf16_t* vector_to_bf16(vector_t const* self);
+
+/**
+ * Creates a double precision copy of a bfloat16 matrix (exact).
+ **/
+matrix_t* matrix_from_bf16(matrix_bf16_t const* self);
+
+/**
+ * Deallocates a bfloat16 matrix.
+ **/
+void matrix_bf16_deinit(matrix_bf16_t* self);
+
+/**
+ * Deallocates a bfloat16 vector.
+ **/
+void vector_bf16_deinit(vector_bf16_t* self);
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <stddef.h>
+
+/**
+ * Streaming kernels that support explicit software prefetching.
+ **/
+typedef enum prefetch_kernel_e {
+    PREFETCH_DAXPY,
+    PREFETCH_DDOT,
+    PREFETCH_DNRM2,
+    PREFETCH_DMAX,
+    PREFETCH_DSCAL,
+    PREFETCH_DCOPY,
+    PREFETCH_DGEMV,
+    PREFETCH_NB_KERNELS,
+} prefetch_kernel_t;
+
+/**
+ * Cache level a kernel's working set fits in, matching the `L1`, `L2`, `L3`
+ * and `RAM` weak-scaling benchmark points.
+ **/
+typedef enum size_class_e {
+    SIZE_CLASS_L1,
+    SIZE_CLASS_L2,
+    SIZE_CLASS_L3,
+    SIZE_CLASS_RAM,
+    NB_SIZE_CLASSES,
+} size_class_t;
+
+/**
+ * Distances (in number of elements) swept by the prefetch tuning mode. A
+ * distance of 0 disables software prefetching.
+ **/
+#define NB_PREFETCH_DISTANCES 9
+extern size_t const PREFETCH_DISTANCES[NB_PREFETCH_DISTANCES];
+
+char const* prefetch_kernel_to_str(prefetch_kernel_t kernel);
+char const* size_class_to_str(size_class_t size_class);
+
+/**
+ * Returns the size in bytes of the cache backing a given size class, as
+ * reported by the system (`SIZE_MAX` for `SIZE_CLASS_RAM`).
+ **/
+size_t size_class_capacity(size_class_t size_class);
+
+/**
+ * Returns the size class of a working set of `nb_bytes` bytes.
+ **/
+size_class_t size_class_of(size_t nb_bytes);
+
+/**
+ * Returns the prefetch distance (in number of elements) to use for a given
+ * kernel on a working set of `nb_bytes` bytes. A distance of 0 means software
+ * prefetching is disabled and the hardware prefetcher is relied upon.
+ **/
+size_t prefetch_distance(prefetch_kernel_t kernel, size_t nb_bytes);
+
+/**
+ * Sets the prefetch distance (in number of elements) of a given kernel for a
+ * given size class.
+ **/
+void prefetch_set_distance(prefetch_kernel_t kernel, size_class_t size_class, size_t dist);
+
+/**
+ * Sets the prefetch distance (in number of elements) of all kernels for all
+ * size classes.
+ **/
+void prefetch_set_all(size_t dist);
+
+/**
+ * Dumps the table of prefetch distances, one line per kernel and one column
+ * per size class.
+ **/
+int prefetch_table_dump(char const* filename);
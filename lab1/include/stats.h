@@ -20,6 +20,7 @@ typedef struct stats_s {
     double stddevp;
     double mem_throughput;
     double ops_throughput;
+    double error;
 } stats_t;
 
 stats_t* stats_init(char const* title, uint8_t blas_lvl, size_t nb_threads, size_t nb_elems,
@@ -0,0 +1,23 @@
+#include "blas.h"
+
+#include <assert.h>
+#include <complex.h>
+#include <math.h>
+
+#define BLAS_PREFIX s
+#define BLAS_T float
+#define BLAS_R float
+#define BLAS_COMPLEX 0
+#include "blas_template.inc"
+
+#define BLAS_PREFIX c
+#define BLAS_T float complex
+#define BLAS_R float
+#define BLAS_COMPLEX 1
+#include "blas_template.inc"
+
+#define BLAS_PREFIX z
+#define BLAS_T double complex
+#define BLAS_R double
+#define BLAS_COMPLEX 1
+#include "blas_template.inc"
@@ -1,28 +1,350 @@
 #include "blas1.h"
 
+#include "prefetch.h"
+
 #include <math.h>
+#include <omp.h>
+#include <stdbool.h>
+#include <stdint.h>
+#if defined(__AVX__)
+    #include <immintrin.h>
+#endif
+
+// Number of doubles in a cache line
+#define LINE_LEN 8
+
+static size_t stream_threshold = BLAS1_STREAM_THRESHOLD;
+
+void blas1_set_stream_threshold(size_t nb_bytes)
+{
+    stream_threshold = nb_bytes;
+}
+
+size_t blas1_get_stream_threshold()
+{
+    return stream_threshold;
+}
+
+static inline bool use_stream(size_t len)
+{
+    return len * sizeof(double) >= stream_threshold;
+}
+
+/**
+ * Computes the range of elements `[begin, end[` processed by the calling
+ * thread. Chunks are rounded to whole cache lines so that no two threads
+ * write-combine into the same line.
+ **/
+static inline void thread_range(size_t len, size_t* begin, size_t* end)
+{
+    size_t nb_threads = (size_t)(omp_get_num_threads());
+    size_t tid = (size_t)(omp_get_thread_num());
+    size_t chunk = (len + nb_threads - 1) / nb_threads;
+    chunk = (chunk + LINE_LEN - 1) / LINE_LEN * LINE_LEN;
+
+    *begin = tid * chunk < len ? tid * chunk : len;
+    *end = *begin + chunk < len ? *begin + chunk : len;
+}
+
+/**
+ * Prefetches the cache line `dist` elements ahead of `ptr[i]` for reading,
+ * unless it lies past the end of the array.
+ **/
+static inline void prefetch_read(double const* ptr, size_t i, size_t dist, size_t len)
+{
+    if (i + dist < len) {
+        __builtin_prefetch(ptr + i + dist, 0);
+    }
+}
+
+/**
+ * Prefetches the cache line `dist` elements ahead of `ptr[i]` for writing,
+ * unless it lies past the end of the array.
+ **/
+static inline void prefetch_write(double const* ptr, size_t i, size_t dist, size_t len)
+{
+    if (i + dist < len) {
+        __builtin_prefetch(ptr + i + dist, 1);
+    }
+}
+
+/**
+ * Returns the number of leading elements of `ptr` to process with scalar
+ * stores before it is aligned for `_mm256_stream_pd`.
+ **/
+static inline size_t stream_peel(double const* ptr, size_t len)
+{
+    size_t misalign = ((uintptr_t)(ptr) & 31) / sizeof(double);
+    size_t peel = misalign ? 4 - misalign : 0;
+    return peel < len ? peel : len;
+}
 
 void blas1_daxpy(size_t len, double a, double const* x, double* y)
 {
-    for (size_t i = 0; i < len; ++i) {
-        y[i] += a * x[i];
+    size_t dist = prefetch_distance(PREFETCH_DAXPY, 2 * len * sizeof(double));
+    if (dist == 0) {
+        for (size_t i = 0; i < len; ++i) {
+            y[i] += a * x[i];
+        }
+        return;
+    }
+
+    for (size_t i = 0; i < len; i += LINE_LEN) {
+        prefetch_read(x, i, dist, len);
+        prefetch_write(y, i, dist, len);
+        size_t end = i + LINE_LEN < len ? i + LINE_LEN : len;
+        for (size_t j = i; j < end; ++j) {
+            y[j] += a * x[j];
+        }
     }
 }
 
 void parallel_blas1_daxpy(size_t len, double a, double const* x, double* y)
 {
+    size_t dist = prefetch_distance(PREFETCH_DAXPY, 2 * len * sizeof(double));
+    if (dist == 0) {
 #pragma omp parallel for
-    for (size_t i = 0; i < len; ++i) {
+        for (size_t i = 0; i < len; ++i) {
+            y[i] += a * x[i];
+        }
+        return;
+    }
+
+#pragma omp parallel for schedule(static)
+    for (size_t i = 0; i < len; i += LINE_LEN) {
+        prefetch_read(x, i, dist, len);
+        prefetch_write(y, i, dist, len);
+        size_t end = i + LINE_LEN < len ? i + LINE_LEN : len;
+        for (size_t j = i; j < end; ++j) {
+            y[j] += a * x[j];
+        }
+    }
+}
+
+void blas1_daxpy_stream(size_t len, double a, double const* x, double* y)
+{
+    size_t i = 0;
+
+#if defined(__AVX__)
+    for (; i < stream_peel(y, len); ++i) {
         y[i] += a * x[i];
     }
+
+    __m256d va = _mm256_set1_pd(a);
+    for (; i + 8 <= len; i += 8) {
+        __m256d x0 = _mm256_loadu_pd(x + i);
+        __m256d x1 = _mm256_loadu_pd(x + i + 4);
+        __m256d y0 = _mm256_add_pd(_mm256_mul_pd(va, x0), _mm256_load_pd(y + i));
+        __m256d y1 = _mm256_add_pd(_mm256_mul_pd(va, x1), _mm256_load_pd(y + i + 4));
+        _mm256_stream_pd(y + i, y0);
+        _mm256_stream_pd(y + i + 4, y1);
+    }
+#endif
+
+    for (; i < len; ++i) {
+        y[i] += a * x[i];
+    }
+
+#if defined(__AVX__)
+    // Streaming stores are weakly ordered, make them globally visible
+    _mm_sfence();
+#endif
+}
+
+void parallel_blas1_daxpy_stream(size_t len, double a, double const* x, double* y)
+{
+#pragma omp parallel
+    {
+        size_t begin, end;
+        thread_range(len, &begin, &end);
+        blas1_daxpy_stream(end - begin, a, x + begin, y + begin);
+    }
+}
+
+void blas1_dscal(size_t len, double a, double* x)
+{
+    size_t dist = prefetch_distance(PREFETCH_DSCAL, len * sizeof(double));
+    if (dist == 0) {
+        for (size_t i = 0; i < len; ++i) {
+            x[i] *= a;
+        }
+        return;
+    }
+
+    for (size_t i = 0; i < len; i += LINE_LEN) {
+        prefetch_write(x, i, dist, len);
+        size_t end = i + LINE_LEN < len ? i + LINE_LEN : len;
+        for (size_t j = i; j < end; ++j) {
+            x[j] *= a;
+        }
+    }
+}
+
+void parallel_blas1_dscal(size_t len, double a, double* x)
+{
+    size_t dist = prefetch_distance(PREFETCH_DSCAL, len * sizeof(double));
+    if (dist == 0) {
+#pragma omp parallel for
+        for (size_t i = 0; i < len; ++i) {
+            x[i] *= a;
+        }
+        return;
+    }
+
+#pragma omp parallel for schedule(static)
+    for (size_t i = 0; i < len; i += LINE_LEN) {
+        prefetch_write(x, i, dist, len);
+        size_t end = i + LINE_LEN < len ? i + LINE_LEN : len;
+        for (size_t j = i; j < end; ++j) {
+            x[j] *= a;
+        }
+    }
+}
+
+void blas1_dscal_stream(size_t len, double a, double* x)
+{
+    size_t i = 0;
+
+#if defined(__AVX__)
+    for (; i < stream_peel(x, len); ++i) {
+        x[i] *= a;
+    }
+
+    __m256d va = _mm256_set1_pd(a);
+    for (; i + 8 <= len; i += 8) {
+        __m256d x0 = _mm256_mul_pd(va, _mm256_load_pd(x + i));
+        __m256d x1 = _mm256_mul_pd(va, _mm256_load_pd(x + i + 4));
+        _mm256_stream_pd(x + i, x0);
+        _mm256_stream_pd(x + i + 4, x1);
+    }
+#endif
+
+    for (; i < len; ++i) {
+        x[i] *= a;
+    }
+
+#if defined(__AVX__)
+    // Streaming stores are weakly ordered, make them globally visible
+    _mm_sfence();
+#endif
+}
+
+void parallel_blas1_dscal_stream(size_t len, double a, double* x)
+{
+#pragma omp parallel
+    {
+        size_t begin, end;
+        thread_range(len, &begin, &end);
+        blas1_dscal_stream(end - begin, a, x + begin);
+    }
+}
+
+void blas1_dcopy(size_t len, double const* x, double* y)
+{
+    if (use_stream(len)) {
+        blas1_dcopy_stream(len, x, y);
+        return;
+    }
+
+    size_t dist = prefetch_distance(PREFETCH_DCOPY, 2 * len * sizeof(double));
+    if (dist == 0) {
+        for (size_t i = 0; i < len; ++i) {
+            y[i] = x[i];
+        }
+        return;
+    }
+
+    for (size_t i = 0; i < len; i += LINE_LEN) {
+        prefetch_read(x, i, dist, len);
+        size_t end = i + LINE_LEN < len ? i + LINE_LEN : len;
+        for (size_t j = i; j < end; ++j) {
+            y[j] = x[j];
+        }
+    }
+}
+
+void parallel_blas1_dcopy(size_t len, double const* x, double* y)
+{
+    if (use_stream(len)) {
+        parallel_blas1_dcopy_stream(len, x, y);
+        return;
+    }
+
+    size_t dist = prefetch_distance(PREFETCH_DCOPY, 2 * len * sizeof(double));
+    if (dist == 0) {
+#pragma omp parallel for
+        for (size_t i = 0; i < len; ++i) {
+            y[i] = x[i];
+        }
+        return;
+    }
+
+#pragma omp parallel for schedule(static)
+    for (size_t i = 0; i < len; i += LINE_LEN) {
+        prefetch_read(x, i, dist, len);
+        size_t end = i + LINE_LEN < len ? i + LINE_LEN : len;
+        for (size_t j = i; j < end; ++j) {
+            y[j] = x[j];
+        }
+    }
+}
+
+void blas1_dcopy_stream(size_t len, double const* x, double* y)
+{
+    size_t i = 0;
+
+#if defined(__AVX__)
+    for (; i < stream_peel(y, len); ++i) {
+        y[i] = x[i];
+    }
+
+    for (; i + 8 <= len; i += 8) {
+        __m256d y0 = _mm256_loadu_pd(x + i);
+        __m256d y1 = _mm256_loadu_pd(x + i + 4);
+        _mm256_stream_pd(y + i, y0);
+        _mm256_stream_pd(y + i + 4, y1);
+    }
+#endif
+
+    for (; i < len; ++i) {
+        y[i] = x[i];
+    }
+
+#if defined(__AVX__)
+    // Streaming stores are weakly ordered, make them globally visible
+    _mm_sfence();
+#endif
+}
+
+void parallel_blas1_dcopy_stream(size_t len, double const* x, double* y)
+{
+#pragma omp parallel
+    {
+        size_t begin, end;
+        thread_range(len, &begin, &end);
+        blas1_dcopy_stream(end - begin, x + begin, y + begin);
+    }
 }
 
 double blas1_ddot(size_t len, double const* x, double const* y)
 {
     double res = 0.0;
 
-    for (size_t i = 0; i < len; ++i) {
-        res += x[i] * y[i];
+    size_t dist = prefetch_distance(PREFETCH_DDOT, 2 * len * sizeof(double));
+    if (dist == 0) {
+        for (size_t i = 0; i < len; ++i) {
+            res += x[i] * y[i];
+        }
+        return res;
+    }
+
+    for (size_t i = 0; i < len; i += LINE_LEN) {
+        prefetch_read(x, i, dist, len);
+        prefetch_read(y, i, dist, len);
+        size_t end = i + LINE_LEN < len ? i + LINE_LEN : len;
+        for (size_t j = i; j < end; ++j) {
+            res += x[j] * y[j];
+        }
     }
 
     return res;
@@ -32,9 +354,23 @@ double parallel_blas1_ddot(size_t len, double const* x, double const* y)
 {
     double res = 0.0;
 
+    size_t dist = prefetch_distance(PREFETCH_DDOT, 2 * len * sizeof(double));
+    if (dist == 0) {
 #pragma omp parallel for reduction(+ : res)
-    for (size_t i = 0; i < len; ++i) {
-        res += x[i] * y[i];
+        for (size_t i = 0; i < len; ++i) {
+            res += x[i] * y[i];
+        }
+        return res;
+    }
+
+#pragma omp parallel for schedule(static) reduction(+ : res)
+    for (size_t i = 0; i < len; i += LINE_LEN) {
+        prefetch_read(x, i, dist, len);
+        prefetch_read(y, i, dist, len);
+        size_t end = i + LINE_LEN < len ? i + LINE_LEN : len;
+        for (size_t j = i; j < end; ++j) {
+            res += x[j] * y[j];
+        }
     }
 
     return res;
@@ -44,8 +380,20 @@ double blas1_dnrm2(size_t len, double const* x)
 {
     double res = 0.0;
 
-    for (size_t i = 0; i < len; ++i) {
-        res += x[i] * x[i];
+    size_t dist = prefetch_distance(PREFETCH_DNRM2, len * sizeof(double));
+    if (dist == 0) {
+        for (size_t i = 0; i < len; ++i) {
+            res += x[i] * x[i];
+        }
+        return sqrt(res);
+    }
+
+    for (size_t i = 0; i < len; i += LINE_LEN) {
+        prefetch_read(x, i, dist, len);
+        size_t end = i + LINE_LEN < len ? i + LINE_LEN : len;
+        for (size_t j = i; j < end; ++j) {
+            res += x[j] * x[j];
+        }
     }
 
     return sqrt(res);
@@ -55,9 +403,22 @@ double parallel_blas1_dnrm2(size_t len, double const* x)
 {
     double res = 0.0;
 
+    size_t dist = prefetch_distance(PREFETCH_DNRM2, len * sizeof(double));
+    if (dist == 0) {
 #pragma omp parallel for reduction(+ : res)
-    for (size_t i = 0; i < len; ++i) {
-        res += x[i] * x[i];
+        for (size_t i = 0; i < len; ++i) {
+            res += x[i] * x[i];
+        }
+        return sqrt(res);
+    }
+
+#pragma omp parallel for schedule(static) reduction(+ : res)
+    for (size_t i = 0; i < len; i += LINE_LEN) {
+        prefetch_read(x, i, dist, len);
+        size_t end = i + LINE_LEN < len ? i + LINE_LEN : len;
+        for (size_t j = i; j < end; ++j) {
+            res += x[j] * x[j];
+        }
     }
 
     return sqrt(res);
@@ -67,8 +428,20 @@ double blas1_dmax(size_t len, double const* x)
 {
     double res = x[0];
 
-    for (size_t i = 0; i < len; ++i) {
-        res = (x[i] > res) ? x[i] : res;
+    size_t dist = prefetch_distance(PREFETCH_DMAX, len * sizeof(double));
+    if (dist == 0) {
+        for (size_t i = 0; i < len; ++i) {
+            res = (x[i] > res) ? x[i] : res;
+        }
+        return res;
+    }
+
+    for (size_t i = 0; i < len; i += LINE_LEN) {
+        prefetch_read(x, i, dist, len);
+        size_t end = i + LINE_LEN < len ? i + LINE_LEN : len;
+        for (size_t j = i; j < end; ++j) {
+            res = (x[j] > res) ? x[j] : res;
+        }
     }
 
     return res;
@@ -78,10 +451,65 @@ double parallel_blas1_dmax(size_t len, double const* x)
 {
     double res = x[0];
 
+    size_t dist = prefetch_distance(PREFETCH_DMAX, len * sizeof(double));
+    if (dist == 0) {
 #pragma omp parallel for reduction(max : res)
-    for (size_t i = 0; i < len; ++i) {
-        res = (x[i] > res) ? x[i] : res;
+        for (size_t i = 0; i < len; ++i) {
+            res = (x[i] > res) ? x[i] : res;
+        }
+        return res;
+    }
+
+#pragma omp parallel for schedule(static) reduction(max : res)
+    for (size_t i = 0; i < len; i += LINE_LEN) {
+        prefetch_read(x, i, dist, len);
+        size_t end = i + LINE_LEN < len ? i + LINE_LEN : len;
+        for (size_t j = i; j < end; ++j) {
+            res = (x[j] > res) ? x[j] : res;
+        }
     }
 
     return res;
 }
+
+void blas1_daxpy_bf16(size_t len, double a, bf16_t const* x, bf16_t* y)
+{
+    float af = (float)(a);
+
+    for (size_t i = 0; i < len; ++i) {
+        y[i] = bf16_from_float(af * bf16_to_float(x[i]) + bf16_to_float(y[i]));
+    }
+}
+
+void parallel_blas1_daxpy_bf16(size_t len, double a, bf16_t const* x, bf16_t* y)
+{
+    float af = (float)(a);
+
+#pragma omp parallel for
+    for (size_t i = 0; i < len; ++i) {
+        y[i] = bf16_from_float(af * bf16_to_float(x[i]) + bf16_to_float(y[i]));
+    }
+}
+
+double blas1_ddot_bf16(size_t len, bf16_t const* x, bf16_t const* y)
+{
+    float res = 0.0f;
+
+    for (size_t i = 0; i < len; ++i) {
+        res += bf16_to_float(x[i]) * bf16_to_float(y[i]);
+    }
+
+    return (double)(res);
+}
+
+double parallel_blas1_ddot_bf16(size_t len, bf16_t const* x, bf16_t const* y)
+{
+    float res = 0.0f;
+
+#pragma omp parallel for reduction(+ : res)
+    for (size_t i = 0; i < len; ++i) {
+        res += bf16_to_float(x[i]) * bf16_to_float(y[i]);
+    }
+
+    return (double)(res);
+}
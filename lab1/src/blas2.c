@@ -1,7 +1,29 @@
 #include "blas2.h"
 
+#include "prefetch.h"
+
 #include <assert.h>
 
+// Number of doubles in a cache line
+#define LINE_LEN 8
+
+/**
+ * Prefetches `A` and `x` `dist` elements ahead of `A[i][j]` and `x[j]`.
+ *
+ * `A` is walked as one contiguous stream, so its prefetches run over into the
+ * next row. `x` is re-read for every row and is only prefetched within it.
+ **/
+static inline void prefetch_row(double const* A, double const* x, size_t i, size_t j, size_t m,
+                                size_t n, size_t dist)
+{
+    if (i * n + j + dist < m * n) {
+        __builtin_prefetch(A + i * n + j + dist, 0);
+    }
+    if (j + dist < n) {
+        __builtin_prefetch(x + j + dist, 0);
+    }
+}
+
 void blas2_dgemv(size_t m, size_t n, double alpha, double const* restrict A,
                  double const* restrict x, double beta, double* restrict y)
 {
@@ -9,10 +31,26 @@ void blas2_dgemv(size_t m, size_t n, double alpha, double const* restrict A,
         return;
     assert((m != 0 && n != 0) && "`m` and `n` must be different than 0.");
 
+    size_t dist = prefetch_distance(PREFETCH_DGEMV, (m * n + m + n) * sizeof(double));
+    if (dist == 0) {
+        for (size_t i = 0; i < m; ++i) {
+            double tmp = 0.0;
+            for (size_t j = 0; j < n; ++j) {
+                tmp += A[i * n + j] * x[j];
+            }
+            y[i] = alpha * tmp + beta * y[i];
+        }
+        return;
+    }
+
     for (size_t i = 0; i < m; ++i) {
         double tmp = 0.0;
-        for (size_t j = 0; j < n; ++j) {
-            tmp += A[i * n + j] * x[j];
+        for (size_t j = 0; j < n; j += LINE_LEN) {
+            prefetch_row(A, x, i, j, m, n, dist);
+            size_t end = j + LINE_LEN < n ? j + LINE_LEN : n;
+            for (size_t jj = j; jj < end; ++jj) {
+                tmp += A[i * n + jj] * x[jj];
+            }
         }
         y[i] = alpha * tmp + beta * y[i];
     }
@@ -25,11 +63,28 @@ void parallel_blas2_dgemv(size_t m, size_t n, double alpha, double const* restri
         return;
     assert((m != 0 && n != 0) && "`m` and `n` must be different than 0.");
 
+    size_t dist = prefetch_distance(PREFETCH_DGEMV, (m * n + m + n) * sizeof(double));
+    if (dist == 0) {
+#pragma omp parallel for schedule(static)
+        for (size_t i = 0; i < m; ++i) {
+            double tmp = 0.0;
+            for (size_t j = 0; j < n; ++j) {
+                tmp += A[i * n + j] * x[j];
+            }
+            y[i] = alpha * tmp + beta * y[i];
+        }
+        return;
+    }
+
 #pragma omp parallel for schedule(static)
     for (size_t i = 0; i < m; ++i) {
         double tmp = 0.0;
-        for (size_t j = 0; j < n; ++j) {
-            tmp += A[i * n + j] * x[j];
+        for (size_t j = 0; j < n; j += LINE_LEN) {
+            prefetch_row(A, x, i, j, m, n, dist);
+            size_t end = j + LINE_LEN < n ? j + LINE_LEN : n;
+            for (size_t jj = j; jj < end; ++jj) {
+                tmp += A[i * n + jj] * x[jj];
+            }
         }
         y[i] = alpha * tmp + beta * y[i];
     }
@@ -62,4 +117,37 @@ void parallel_blas2_dger(size_t m, size_t n, double alpha, double* restrict A,
             A[i * n + j] += alpha * x[i] * yT[j];
         }
     }
-}
\ No newline at end of file
+}
+
+void blas2_dgemv_bf16(size_t m, size_t n, double alpha, bf16_t const* restrict A,
+                      bf16_t const* restrict x, double beta, double* restrict y)
+{
+    if (!A || !x || !y)
+        return;
+    assert((m != 0 && n != 0) && "`m` and `n` must be different than 0.");
+
+    for (size_t i = 0; i < m; ++i) {
+        float tmp = 0.0f;
+        for (size_t j = 0; j < n; ++j) {
+            tmp += bf16_to_float(A[i * n + j]) * bf16_to_float(x[j]);
+        }
+        y[i] = alpha * (double)(tmp) + beta * y[i];
+    }
+}
+
+void parallel_blas2_dgemv_bf16(size_t m, size_t n, double alpha, bf16_t const* restrict A,
+                               bf16_t const* restrict x, double beta, double* restrict y)
+{
+    if (!A || !x || !y)
+        return;
+    assert((m != 0 && n != 0) && "`m` and `n` must be different than 0.");
+
+#pragma omp parallel for schedule(static)
+    for (size_t i = 0; i < m; ++i) {
+        float tmp = 0.0f;
+        for (size_t j = 0; j < n; ++j) {
+            tmp += bf16_to_float(A[i * n + j]) * bf16_to_float(x[j]);
+        }
+        y[i] = alpha * (double)(tmp) + beta * y[i];
+    }
+}
@@ -7,21 +7,21 @@ void blas3_dgemm(size_t l, size_t m, size_t n, double alpha, double const* restr
 {
     if (!A || !B || !C)
         return;
-    assert((l != 0 && m != 0 && n != 0) && "`l`, `m` and `l` must be different than 0.");
+    assert((l != 0 && m != 0 && n != 0) && "`l`, `m` and `n` must be different than 0.");
 
     // if `alpha` and/or `beta` are zero
     if (alpha == 0.0) {
         if (beta == 0.0) {
             for (size_t i = 0; i < l; ++i) {
                 for (size_t j = 0; j < m; ++j) {
-                    C[i * l + j] = 0.0;
+                    C[i * m + j] = 0.0;
                 }
             }
         }
         else {
             for (size_t i = 0; i < l; ++i) {
                 for (size_t j = 0; j < m; ++j) {
-                    C[i * l + j] *= beta;
+                    C[i * m + j] *= beta;
                 }
             }
         }
@@ -34,7 +34,7 @@ void blas3_dgemm(size_t l, size_t m, size_t n, double alpha, double const* restr
             for (size_t k = 0; k < n; ++k) {
                 tmp += A[i * n + k] * B[k * m + j];
             }
-            C[i * l + j] *= beta + alpha * tmp;
+            C[i * m + j] = (beta == 0.0 ? 0.0 : beta * C[i * m + j]) + alpha * tmp;
         }
     }
 }
@@ -44,7 +44,7 @@ void parallel_blas3_dgemm(size_t l, size_t m, size_t n, double alpha, double con
 {
     if (!A || !B || !C)
         return;
-    assert((l != 0 && m != 0 && n != 0) && "`l`, `m` and `l` must be different than 0.");
+    assert((l != 0 && m != 0 && n != 0) && "`l`, `m` and `n` must be different than 0.");
 
     // if `alpha` and/or `beta` are zero
     if (alpha == 0.0) {
@@ -52,7 +52,7 @@ void parallel_blas3_dgemm(size_t l, size_t m, size_t n, double alpha, double con
 #pragma omp parallel for collapse(2) schedule(static)
             for (size_t i = 0; i < l; ++i) {
                 for (size_t j = 0; j < m; ++j) {
-                    C[i * l + j] = 0.0;
+                    C[i * m + j] = 0.0;
                 }
             }
         }
@@ -60,7 +60,7 @@ void parallel_blas3_dgemm(size_t l, size_t m, size_t n, double alpha, double con
 #pragma omp parallel for collapse(2) schedule(static)
             for (size_t i = 0; i < l; ++i) {
                 for (size_t j = 0; j < m; ++j) {
-                    C[i * l + j] *= beta;
+                    C[i * m + j] *= beta;
                 }
             }
         }
@@ -74,7 +74,7 @@ void parallel_blas3_dgemm(size_t l, size_t m, size_t n, double alpha, double con
             for (size_t k = 0; k < n; ++k) {
                 tmp += A[i * n + k] * B[k * m + j];
             }
-            C[i * l + j] *= beta + alpha * tmp;
+            C[i * m + j] = (beta == 0.0 ? 0.0 : beta * C[i * m + j]) + alpha * tmp;
         }
     }
 }
\ No newline at end of file
@@ -14,7 +14,9 @@ void help(char const* bin)
     fprintf(stderr, "%s [FLAGS] [OPTIONS]\n\n", bin);
     fprintf(stderr, BOLD "Flags:\n" RESET);
     fprintf(stderr, "  -h, --help                  Print help information.\n");
-    fprintf(stderr, "  -v, --verbose               Be verbose.\n\n");
+    fprintf(stderr, "  -v, --verbose               Be verbose.\n");
+    fprintf(stderr, "  -t, --tune                  Tune the software prefetch distance of the "
+                    "streaming kernels.\n\n");
     fprintf(stderr, BOLD "Options:\n" RESET);
     fprintf(stderr, "  -1, --blas1                 Run BLAS1 routines.\n");
     fprintf(stderr, "  -2, --blas2                 Run BLAS2 routines.\n");
@@ -24,6 +26,10 @@ void help(char const* bin)
                     "number of threads.\n");
     fprintf(stderr,
             "  -r, --repetitions <NB_REPS> Specify number of repetitions of the BLAS kernel.\n");
+    fprintf(stderr, "  -d, --prefetch-distance <N> Prefetch `N` elements ahead in the streaming "
+                    "kernels (0 disables).\n");
+    fprintf(stderr, "  -g, --hugepages [POLICY]    Also benchmark DGEMV/DGEMM on huge pages, "
+                    "`thp` (default) or `hugetlbfs`.\n");
     fprintf(stderr,
             "  -o, --output <FILENAME>     Specify the output filename (stdout by default).\n\n");
 }
@@ -58,6 +64,9 @@ config_t config_init()
         .blas_level = BLAS_ALL,
         .nb_threads = 1,
         .nb_reps = DEFAULT_REPS,
+        .prefetch_dist = 0,
+        .hugepages = ALLOC_DEFAULT,
+        .is_tuning = false,
         .pair = { DEFAULT_LEN, DEFAULT_LEN },
         .output_filename = NULL,
     };
@@ -74,18 +83,21 @@ config_t config_from(int argc, char* argv[argc + 1])
         static struct option long_opts[] = {
             { "help", no_argument, NULL, 'h' },
             { "verbose", no_argument, NULL, 'v' },
+            { "tune", no_argument, NULL, 't' },
             { "blas1", no_argument, NULL, '1' },
             { "blas2", no_argument, NULL, '2' },
             { "blas3", no_argument, NULL, '3' },
             { "blas-all", no_argument, NULL, 'a' },
             { "parallel", optional_argument, NULL, 'p' },
             { "repetitions", required_argument, NULL, 'r' },
+            { "prefetch-distance", required_argument, NULL, 'd' },
+            { "hugepages", optional_argument, NULL, 'g' },
             { "output", required_argument, NULL, 'o' },
             { NULL, 0, NULL, 0 },
         };
 
         int opt_idx = 0;
-        curr_opt = getopt_long(argc, argv, "hv123ap::r:o:", long_opts, &opt_idx);
+        curr_opt = getopt_long(argc, argv, "hvt123ap::g::r:d:o:", long_opts, &opt_idx);
         if (curr_opt == -1)
             break;
 
@@ -98,6 +110,10 @@ config_t config_from(int argc, char* argv[argc + 1])
                 self.is_verbose = true;
                 break;
 
+            case 't':
+                self.is_tuning = true;
+                break;
+
             case 'p':
                 if (optarg != NULL) {
                     self.nb_threads = (size_t)(atoi(optarg));
@@ -111,6 +127,24 @@ config_t config_from(int argc, char* argv[argc + 1])
                 self.nb_reps = (size_t)(atoi(optarg));
                 break;
 
+            case 'd':
+                self.prefetch_dist = (size_t)(atoi(optarg));
+                break;
+
+            case 'g':
+                if (optarg != NULL && strcmp(optarg, "hugetlbfs") == 0) {
+                    self.hugepages = ALLOC_HUGETLBFS;
+                }
+                else if (optarg == NULL || strcmp(optarg, "thp") == 0) {
+                    self.hugepages = ALLOC_THP;
+                }
+                else {
+                    fprintf(stderr, BOLD RED "error:" RESET " unknown huge page policy `%s`.\n",
+                            optarg);
+                    exit(EXIT_FAILURE);
+                }
+                break;
+
             case 'o':
                 self.output_filename = strdup(optarg);
                 break;
@@ -182,6 +216,10 @@ void config_print(config_t self)
     printf("  BLAS level:        " BLUE "%s" RESET "\n", blas_level_to_str(self.blas_level));
     printf("  number of threads: " BLUE "%zu" RESET "\n", self.nb_threads);
     printf("  number of reps:    " BLUE "%zu" RESET "\n", self.nb_reps);
+    printf("  prefetch distance: " BLUE "%zu" RESET "\n", self.prefetch_dist);
+    printf("  prefetch tuning:   " BLUE "%s" RESET "\n", self.is_tuning == true ? "yes" : "no");
+    printf("  huge pages:        " BLUE "%s" RESET "\n",
+           self.hugepages != ALLOC_DEFAULT ? alloc_policy_to_str(self.hugepages) : "no");
     printf("  output filename:   " BLUE "%s" RESET "\n",
            self.output_filename ? self.output_filename : "stdout");
 }
\ No newline at end of file
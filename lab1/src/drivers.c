@@ -1,15 +1,57 @@
 #include "drivers.h"
 
+#include "blas.h"
 #include "blas1.h"
 #include "blas2.h"
 #include "blas3.h"
+#include "prefetch.h"
 #include "utils.h"
 
+#include <assert.h>
+#include <complex.h>
+#include <math.h>
 #include <omp.h>
+#include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 #define REPS 1000
+#define PREFETCH_TUNE_SAMPLES 5
+
+/**
+ * Computes the relative error `||val - ref|| / ||ref||` of a vector against a
+ * reference.
+ **/
+static double relative_error(size_t len, double const* ref, double const* val)
+{
+    double diff = 0.0;
+    double norm = 0.0;
+
+    for (size_t i = 0; i < len; ++i) {
+        diff += (val[i] - ref[i]) * (val[i] - ref[i]);
+        norm += ref[i] * ref[i];
+    }
+
+    return norm != 0.0 ? sqrt(diff / norm) : sqrt(diff);
+}
+
+/**
+ * Suffixes the title of `stats` with the name of the allocation policy that
+ * backed the benchmarked operands.
+ **/
+static void stats_retitle(stats_t* stats, char const* kernel, alloc_policy_t policy)
+{
+    char title[BUF_LEN];
+    snprintf(title, BUF_LEN, "%s_%s", kernel, alloc_policy_to_str(policy));
+
+    char* dup = strdup(title);
+    if (dup) {
+        free(stats->title);
+        stats->title = dup;
+    }
+}
 
 stats_t* driver_daxpy(config_t cfg, double a, vector_t* x, vector_t* y)
 {
@@ -43,6 +85,272 @@ stats_t* driver_daxpy(config_t cfg, double a, vector_t* x, vector_t* y)
     return stats;
 }
 
+stats_t* driver_daxpy_stream(config_t cfg, double a, vector_t* x, vector_t* y)
+{
+    stats_t* stats =
+        stats_init("daxpy_nt", 1, cfg.nb_threads, vector_nb_elems(x) + vector_nb_elems(y), 2);
+    if (!stats)
+        return NULL;
+
+    double elapsed;
+    if (cfg.nb_threads != 1) {
+        omp_set_num_threads(cfg.nb_threads);
+    }
+    for (size_t i = 0; i < MAX_SAMPLES; ++i) {
+        do {
+            instant_t start = instant_now();
+            for (size_t _ = 0; _ < cfg.nb_reps; ++_) {
+                if (cfg.nb_threads != 1) {
+                    parallel_blas1_daxpy_stream(vector_nb_elems(y), a, x->data, y->data);
+                }
+                else {
+                    blas1_daxpy_stream(vector_nb_elems(y), a, x->data, y->data);
+                }
+            }
+            instant_t stop = instant_now();
+            elapsed = compute_avg_latency(start, stop, cfg.nb_reps);
+        } while (elapsed <= 0.0);
+        stats->samples[i] = elapsed;
+    }
+
+    stats_compute(stats);
+    return stats;
+}
+
+stats_t* driver_dscal(config_t cfg, double a, vector_t* x)
+{
+    stats_t* stats = stats_init("dscal", 1, cfg.nb_threads, vector_nb_elems(x), 1);
+    if (!stats)
+        return NULL;
+
+    double elapsed;
+    if (cfg.nb_threads != 1) {
+        omp_set_num_threads(cfg.nb_threads);
+    }
+    for (size_t i = 0; i < MAX_SAMPLES; ++i) {
+        do {
+            instant_t start = instant_now();
+            for (size_t _ = 0; _ < cfg.nb_reps; ++_) {
+                if (cfg.nb_threads != 1) {
+                    parallel_blas1_dscal(vector_nb_elems(x), a, x->data);
+                }
+                else {
+                    blas1_dscal(vector_nb_elems(x), a, x->data);
+                }
+            }
+            instant_t stop = instant_now();
+            elapsed = compute_avg_latency(start, stop, cfg.nb_reps);
+        } while (elapsed <= 0.0);
+        stats->samples[i] = elapsed;
+    }
+
+    stats_compute(stats);
+    return stats;
+}
+
+stats_t* driver_dscal_stream(config_t cfg, double a, vector_t* x)
+{
+    stats_t* stats = stats_init("dscal_nt", 1, cfg.nb_threads, vector_nb_elems(x), 1);
+    if (!stats)
+        return NULL;
+
+    double elapsed;
+    if (cfg.nb_threads != 1) {
+        omp_set_num_threads(cfg.nb_threads);
+    }
+    for (size_t i = 0; i < MAX_SAMPLES; ++i) {
+        do {
+            instant_t start = instant_now();
+            for (size_t _ = 0; _ < cfg.nb_reps; ++_) {
+                if (cfg.nb_threads != 1) {
+                    parallel_blas1_dscal_stream(vector_nb_elems(x), a, x->data);
+                }
+                else {
+                    blas1_dscal_stream(vector_nb_elems(x), a, x->data);
+                }
+            }
+            instant_t stop = instant_now();
+            elapsed = compute_avg_latency(start, stop, cfg.nb_reps);
+        } while (elapsed <= 0.0);
+        stats->samples[i] = elapsed;
+    }
+
+    stats_compute(stats);
+    return stats;
+}
+
+stats_t* driver_dcopy(config_t cfg, vector_t* x, vector_t* y)
+{
+    stats_t* stats =
+        stats_init("dcopy", 1, cfg.nb_threads, vector_nb_elems(x) + vector_nb_elems(y), 0);
+    if (!stats)
+        return NULL;
+
+    // Always measure the regular path, `driver_dcopy_stream` measures the other one
+    size_t threshold = blas1_get_stream_threshold();
+    blas1_set_stream_threshold(SIZE_MAX);
+
+    double elapsed;
+    if (cfg.nb_threads != 1) {
+        omp_set_num_threads(cfg.nb_threads);
+    }
+    for (size_t i = 0; i < MAX_SAMPLES; ++i) {
+        do {
+            instant_t start = instant_now();
+            for (size_t _ = 0; _ < cfg.nb_reps; ++_) {
+                if (cfg.nb_threads != 1) {
+                    parallel_blas1_dcopy(vector_nb_elems(x), x->data, y->data);
+                }
+                else {
+                    blas1_dcopy(vector_nb_elems(x), x->data, y->data);
+                }
+            }
+            instant_t stop = instant_now();
+            elapsed = compute_avg_latency(start, stop, cfg.nb_reps);
+        } while (elapsed <= 0.0);
+        stats->samples[i] = elapsed;
+    }
+
+    blas1_set_stream_threshold(threshold);
+    stats_compute(stats);
+    return stats;
+}
+
+stats_t* driver_dcopy_stream(config_t cfg, vector_t* x, vector_t* y)
+{
+    stats_t* stats =
+        stats_init("dcopy_nt", 1, cfg.nb_threads, vector_nb_elems(x) + vector_nb_elems(y), 0);
+    if (!stats)
+        return NULL;
+
+    double elapsed;
+    if (cfg.nb_threads != 1) {
+        omp_set_num_threads(cfg.nb_threads);
+    }
+    for (size_t i = 0; i < MAX_SAMPLES; ++i) {
+        do {
+            instant_t start = instant_now();
+            for (size_t _ = 0; _ < cfg.nb_reps; ++_) {
+                if (cfg.nb_threads != 1) {
+                    parallel_blas1_dcopy_stream(vector_nb_elems(x), x->data, y->data);
+                }
+                else {
+                    blas1_dcopy_stream(vector_nb_elems(x), x->data, y->data);
+                }
+            }
+            instant_t stop = instant_now();
+            elapsed = compute_avg_latency(start, stop, cfg.nb_reps);
+        } while (elapsed <= 0.0);
+        stats->samples[i] = elapsed;
+    }
+
+    stats_compute(stats);
+    return stats;
+}
+
+stats_t* driver_daxpy_bf16(config_t cfg, double a, vector_t* x, vector_t* y)
+{
+    stats_t* stats =
+        stats_init("daxpy_bf16", 1, cfg.nb_threads, vector_nb_elems(x) + vector_nb_elems(y), 2);
+    if (!stats)
+        return NULL;
+    stats->nb_bytes = stats->nb_elems * sizeof(bf16_t);
+
+    vector_bf16_t* x16 = vector_to_bf16(x);
+    vector_bf16_t* y16 = vector_to_bf16(y);
+    vector_t* y_ref = matrix_copy(y);
+    if (!x16 || !y16 || !y_ref) {
+        vector_bf16_deinit(x16);
+        vector_bf16_deinit(y16);
+        vector_deinit(y_ref);
+        return NULL;
+    }
+
+    // Error of a single call against the double precision kernel
+    blas1_daxpy(vector_nb_elems(y), a, x->data, y_ref->data);
+    blas1_daxpy_bf16(vector_nb_elems(y), a, x16->data, y16->data);
+    vector_t* y_bf16 = matrix_from_bf16(y16);
+    if (y_bf16) {
+        stats->error = relative_error(vector_nb_elems(y), y_ref->data, y_bf16->data);
+    }
+    vector_deinit(y_bf16);
+    vector_deinit(y_ref);
+
+    double elapsed;
+    if (cfg.nb_threads != 1) {
+        omp_set_num_threads(cfg.nb_threads);
+    }
+    for (size_t i = 0; i < MAX_SAMPLES; ++i) {
+        do {
+            instant_t start = instant_now();
+            for (size_t _ = 0; _ < cfg.nb_reps; ++_) {
+                if (cfg.nb_threads != 1) {
+                    parallel_blas1_daxpy_bf16(vector_nb_elems(y), a, x16->data, y16->data);
+                }
+                else {
+                    blas1_daxpy_bf16(vector_nb_elems(y), a, x16->data, y16->data);
+                }
+            }
+            instant_t stop = instant_now();
+            elapsed = compute_avg_latency(start, stop, cfg.nb_reps);
+        } while (elapsed <= 0.0);
+        stats->samples[i] = elapsed;
+    }
+
+    vector_bf16_deinit(x16);
+    vector_bf16_deinit(y16);
+    stats_compute(stats);
+    return stats;
+}
+
+stats_t* driver_ddot_bf16(config_t cfg, vector_t* x, vector_t* y)
+{
+    stats_t* stats =
+        stats_init("ddot_bf16", 1, cfg.nb_threads, vector_nb_elems(x) + vector_nb_elems(y), 2);
+    if (!stats)
+        return NULL;
+    stats->nb_bytes = stats->nb_elems * sizeof(bf16_t);
+
+    vector_bf16_t* x16 = vector_to_bf16(x);
+    vector_bf16_t* y16 = vector_to_bf16(y);
+    if (!x16 || !y16) {
+        vector_bf16_deinit(x16);
+        vector_bf16_deinit(y16);
+        return NULL;
+    }
+
+    // Error of a single call against the double precision kernel
+    double ref = blas1_ddot(vector_nb_elems(x), x->data, y->data);
+    double res = blas1_ddot_bf16(vector_nb_elems(x), x16->data, y16->data);
+    stats->error = relative_error(1, &ref, &res);
+
+    double elapsed;
+    if (cfg.nb_threads != 1) {
+        omp_set_num_threads(cfg.nb_threads);
+    }
+    for (size_t i = 0; i < MAX_SAMPLES; ++i) {
+        do {
+            instant_t start = instant_now();
+            for (size_t _ = 0; _ < cfg.nb_reps; ++_) {
+                if (cfg.nb_threads != 1) {
+                    parallel_blas1_ddot_bf16(vector_nb_elems(x), x16->data, y16->data);
+                }
+                else {
+                    blas1_ddot_bf16(vector_nb_elems(x), x16->data, y16->data);
+                }
+            }
+            instant_t stop = instant_now();
+            elapsed = compute_avg_latency(start, stop, cfg.nb_reps);
+        } while (elapsed <= 0.0);
+        stats->samples[i] = elapsed;
+    }
+
+    vector_bf16_deinit(x16);
+    vector_bf16_deinit(y16);
+    stats_compute(stats);
+    return stats;
+}
+
 stats_t* driver_ddot(config_t cfg, vector_t* x, vector_t* y)
 {
     stats_t* stats =
@@ -247,6 +555,164 @@ stats_t* driver_dger(config_t cfg, double alpha, matrix_t* A, vector_t* x, vecto
     return stats;
 }
 
+stats_t* driver_dgemv_bf16(config_t cfg, double alpha, matrix_t* A, vector_t* x, double beta,
+                           vector_t* y)
+{
+    stats_t* stats = stats_init("dgemv_bf16", 2, cfg.nb_threads,
+                                matrix_nb_elems(A) + vector_nb_elems(x) + vector_nb_elems(y),
+                                3 * A->rows * (2 * A->cols));
+    if (!stats)
+        return NULL;
+    // `y` is kept in double precision
+    stats->nb_bytes = (matrix_nb_elems(A) + vector_nb_elems(x)) * sizeof(bf16_t) +
+                      vector_nb_elems(y) * sizeof(double);
+
+    matrix_bf16_t* A16 = matrix_to_bf16(A);
+    vector_bf16_t* x16 = vector_to_bf16(x);
+    vector_t* y_ref = matrix_copy(y);
+    vector_t* y_bf16 = matrix_copy(y);
+    if (!A16 || !x16 || !y_ref || !y_bf16) {
+        matrix_bf16_deinit(A16);
+        vector_bf16_deinit(x16);
+        vector_deinit(y_ref);
+        vector_deinit(y_bf16);
+        return NULL;
+    }
+
+    // Error of a single call against the double precision kernel
+    blas2_dgemv(A->rows, A->cols, alpha, A->data, x->data, beta, y_ref->data);
+    blas2_dgemv_bf16(A->rows, A->cols, alpha, A16->data, x16->data, beta, y_bf16->data);
+    stats->error = relative_error(vector_nb_elems(y), y_ref->data, y_bf16->data);
+    vector_deinit(y_ref);
+    vector_deinit(y_bf16);
+
+    double elapsed;
+    if (cfg.nb_threads != 1) {
+        omp_set_num_threads(cfg.nb_threads);
+    }
+    for (size_t i = 0; i < MAX_SAMPLES; ++i) {
+        do {
+            instant_t start = instant_now();
+            for (size_t _ = 0; _ < cfg.nb_reps; ++_) {
+                if (cfg.nb_threads != 1) {
+                    parallel_blas2_dgemv_bf16(A->rows, A->cols, alpha, A16->data, x16->data, beta,
+                                              y->data);
+                }
+                else {
+                    blas2_dgemv_bf16(A->rows, A->cols, alpha, A16->data, x16->data, beta, y->data);
+                }
+            }
+            instant_t stop = instant_now();
+            elapsed = compute_avg_latency(start, stop, cfg.nb_reps);
+        } while (elapsed <= 0.0);
+        stats->samples[i] = elapsed;
+    }
+
+    matrix_bf16_deinit(A16);
+    vector_bf16_deinit(x16);
+    stats_compute(stats);
+    return stats;
+}
+
+stats_t* driver_dgemv_hugepages(config_t cfg, double alpha, matrix_t* A, vector_t* x, double beta,
+                                vector_t* y)
+{
+    // Copy the operands under the huge page policy, then restore the previous one
+    alloc_policy_t prev = matrix_get_alloc_policy();
+    matrix_set_alloc_policy(cfg.hugepages);
+    matrix_t* A_huge = matrix_copy(A);
+    vector_t* x_huge = matrix_copy(x);
+    vector_t* y_huge = matrix_copy(y);
+    matrix_set_alloc_policy(prev);
+
+    stats_t* stats = NULL;
+    if (A_huge && x_huge && y_huge) {
+        stats = driver_dgemv(cfg, alpha, A_huge, x_huge, beta, y_huge);
+    }
+    // `A` dominates the working set, report the policy it actually got
+    if (stats) {
+        stats_retitle(stats, "dgemv", A_huge->alloc);
+    }
+
+    matrix_deinit(A_huge);
+    vector_deinit(x_huge);
+    vector_deinit(y_huge);
+    return stats;
+}
+
+stats_t* driver_sgemv(config_t cfg, double alpha, matrix_t* A, vector_t* x, double beta,
+                      vector_t* y)
+{
+    stats_t* stats = stats_init("sgemv", 2, cfg.nb_threads,
+                                matrix_nb_elems(A) + vector_nb_elems(x) + vector_nb_elems(y),
+                                3 * A->rows * (2 * A->cols));
+    if (!stats)
+        return NULL;
+    stats->nb_bytes = stats->nb_elems * sizeof(float);
+
+    size_t const m = A->rows;
+    size_t const n = A->cols;
+    float* A32 = malloc(m * n * sizeof(float));
+    float* x32 = malloc(n * sizeof(float));
+    float* y32 = malloc(m * sizeof(float));
+    vector_t* y_ref = matrix_copy(y);
+    if (!A32 || !x32 || !y32 || !y_ref) {
+        free(A32);
+        free(x32);
+        free(y32);
+        vector_deinit(y_ref);
+        return NULL;
+    }
+    for (size_t i = 0; i < m * n; ++i) {
+        A32[i] = (float)(A->data[i]);
+    }
+    for (size_t i = 0; i < n; ++i) {
+        x32[i] = (float)(x->data[i]);
+    }
+    for (size_t i = 0; i < m; ++i) {
+        y32[i] = (float)(y->data[i]);
+    }
+
+    // Error of a single call against the double precision kernel
+    blas2_dgemv(m, n, alpha, A->data, x->data, beta, y_ref->data);
+    blas2_sgemv(m, n, (float)(alpha), A32, x32, (float)(beta), y32);
+    double diff = 0.0;
+    double norm = 0.0;
+    for (size_t i = 0; i < m; ++i) {
+        diff += ((double)(y32[i]) - y_ref->data[i]) * ((double)(y32[i]) - y_ref->data[i]);
+        norm += y_ref->data[i] * y_ref->data[i];
+    }
+    stats->error = norm > 0.0 ? sqrt(diff / norm) : sqrt(diff);
+    vector_deinit(y_ref);
+
+    double elapsed;
+    if (cfg.nb_threads != 1) {
+        omp_set_num_threads(cfg.nb_threads);
+    }
+    for (size_t i = 0; i < MAX_SAMPLES; ++i) {
+        do {
+            instant_t start = instant_now();
+            for (size_t _ = 0; _ < cfg.nb_reps; ++_) {
+                if (cfg.nb_threads != 1) {
+                    parallel_blas2_sgemv(m, n, (float)(alpha), A32, x32, (float)(beta), y32);
+                }
+                else {
+                    blas2_sgemv(m, n, (float)(alpha), A32, x32, (float)(beta), y32);
+                }
+            }
+            instant_t stop = instant_now();
+            elapsed = compute_avg_latency(start, stop, cfg.nb_reps);
+        } while (elapsed <= 0.0);
+        stats->samples[i] = elapsed;
+    }
+
+    free(A32);
+    free(x32);
+    free(y32);
+    stats_compute(stats);
+    return stats;
+}
+
 stats_t* driver_dgemm(config_t cfg, double alpha, matrix_t* A, matrix_t* B, double beta,
                       matrix_t* C)
 {
@@ -256,6 +722,43 @@ stats_t* driver_dgemm(config_t cfg, double alpha, matrix_t* A, matrix_t* B, doub
     if (!stats)
         return NULL;
 
+    // Error of a single call against `dgemv`, one column of `C` at a time. `C`
+    // may alias `B` in the benchmark, so the checked call writes to a copy.
+    size_t const l = A->rows;
+    size_t const n = A->cols;
+    size_t const m = B->cols;
+    matrix_t* C_chk = matrix_copy(C);
+    matrix_t* BT = matrix_zeroes(m, n);
+    vector_t* col = vector_zeroes(l);
+    vector_t* C_ref = vector_zeroes(l * m);
+    if (!C_chk || !BT || !col || !C_ref) {
+        matrix_deinit(C_chk);
+        matrix_deinit(BT);
+        vector_deinit(col);
+        vector_deinit(C_ref);
+        return NULL;
+    }
+    for (size_t k = 0; k < n; ++k) {
+        for (size_t j = 0; j < m; ++j) {
+            BT->data[j * n + k] = B->data[k * m + j];
+        }
+    }
+    for (size_t j = 0; j < m; ++j) {
+        for (size_t i = 0; i < l; ++i) {
+            col->data[i] = C->data[i * m + j];
+        }
+        blas2_dgemv(l, n, alpha, A->data, BT->data + j * n, beta, col->data);
+        for (size_t i = 0; i < l; ++i) {
+            C_ref->data[i * m + j] = col->data[i];
+        }
+    }
+    blas3_dgemm(l, m, n, alpha, A->data, B->data, beta, C_chk->data);
+    stats->error = relative_error(l * m, C_ref->data, C_chk->data);
+    matrix_deinit(C_chk);
+    matrix_deinit(BT);
+    vector_deinit(col);
+    vector_deinit(C_ref);
+
     double elapsed;
     if (cfg.nb_threads != 1) {
         omp_set_num_threads(cfg.nb_threads);
@@ -331,3 +834,269 @@ stats_t* driver_dgemm_var(config_t cfg, double alpha, matrix_t* A, matrix_t* B,
     stats_compute(stats);
     return stats;
 }
+
+stats_t* driver_dgemm_hugepages(config_t cfg, double alpha, matrix_t* A, matrix_t* B, double beta,
+                                matrix_t* C)
+{
+    // Copy the operands under the huge page policy, then restore the previous one
+    alloc_policy_t prev = matrix_get_alloc_policy();
+    matrix_set_alloc_policy(cfg.hugepages);
+    matrix_t* A_huge = matrix_copy(A);
+    matrix_t* B_huge = matrix_copy(B);
+    // `C` may alias `B`, keep the aliasing on the copies
+    matrix_t* C_huge = C == B ? B_huge : matrix_copy(C);
+    matrix_set_alloc_policy(prev);
+
+    stats_t* stats = NULL;
+    if (A_huge && B_huge && C_huge) {
+        stats = driver_dgemm(cfg, alpha, A_huge, B_huge, beta, C_huge);
+    }
+    if (stats) {
+        stats_retitle(stats, "dgemm", A_huge->alloc);
+    }
+
+    matrix_deinit(A_huge);
+    matrix_deinit(B_huge);
+    if (C_huge != B_huge) {
+        matrix_deinit(C_huge);
+    }
+    return stats;
+}
+
+stats_t* driver_zgemm(config_t cfg, double alpha, matrix_t* A, matrix_t* B, double beta)
+{
+    size_t const l = A->rows;
+    size_t const n = A->cols;
+    size_t const m = B->cols;
+    stats_t* stats = stats_init("zgemm", 3, cfg.nb_threads, l * n + n * m + l * m,
+                                3 * l * m * (8 * n));
+    if (!stats)
+        return NULL;
+    stats->nb_bytes = stats->nb_elems * sizeof(double complex);
+
+    // Complex operands whose imaginary parts are the real ones in reverse order
+    double complex* Az = malloc(l * n * sizeof(double complex));
+    double complex* Bz = malloc(n * m * sizeof(double complex));
+    double complex* Cz = malloc(l * m * sizeof(double complex));
+    double complex* C_ref = malloc(l * m * sizeof(double complex));
+    matrix_t* A_im = matrix_copy(A);
+    matrix_t* BT_re = matrix_zeroes(m, n);
+    matrix_t* BT_im = matrix_zeroes(m, n);
+    vector_t* re = vector_zeroes(l);
+    vector_t* im = vector_zeroes(l);
+    if (!Az || !Bz || !Cz || !C_ref || !A_im || !BT_re || !BT_im || !re || !im) {
+        free(Az);
+        free(Bz);
+        free(Cz);
+        free(C_ref);
+        matrix_deinit(A_im);
+        matrix_deinit(BT_re);
+        matrix_deinit(BT_im);
+        vector_deinit(re);
+        vector_deinit(im);
+        return NULL;
+    }
+    for (size_t i = 0; i < l * n; ++i) {
+        A_im->data[i] = A->data[l * n - 1 - i];
+        Az[i] = A->data[i] + I * A_im->data[i];
+    }
+    for (size_t k = 0; k < n; ++k) {
+        for (size_t j = 0; j < m; ++j) {
+            double const b_im = B->data[n * m - 1 - (k * m + j)];
+            Bz[k * m + j] = B->data[k * m + j] + I * b_im;
+            BT_re->data[j * n + k] = B->data[k * m + j];
+            BT_im->data[j * n + k] = b_im;
+        }
+    }
+
+    // Reference from the double precision kernel, one column of `C` at a time:
+    // `Re(C) = A_re B_re - A_im B_im` and `Im(C) = A_re B_im + A_im B_re`
+    for (size_t j = 0; j < m; ++j) {
+        blas2_dgemv(l, n, 1.0, A->data, BT_re->data + j * n, 0.0, re->data);
+        blas2_dgemv(l, n, -1.0, A_im->data, BT_im->data + j * n, 1.0, re->data);
+        blas2_dgemv(l, n, 1.0, A->data, BT_im->data + j * n, 0.0, im->data);
+        blas2_dgemv(l, n, 1.0, A_im->data, BT_re->data + j * n, 1.0, im->data);
+        for (size_t i = 0; i < l; ++i) {
+            C_ref[i * m + j] = alpha * (re->data[i] + I * im->data[i]);
+        }
+    }
+    blas3_zgemm(l, m, n, alpha, Az, Bz, 0.0, Cz);
+    // Complex numbers are laid out as pairs of doubles
+    stats->error = relative_error(2 * l * m, (double const*)(C_ref), (double const*)(Cz));
+    free(C_ref);
+    matrix_deinit(A_im);
+    matrix_deinit(BT_re);
+    matrix_deinit(BT_im);
+    vector_deinit(re);
+    vector_deinit(im);
+
+    double elapsed;
+    if (cfg.nb_threads != 1) {
+        omp_set_num_threads(cfg.nb_threads);
+    }
+    for (size_t i = 0; i < MAX_SAMPLES; ++i) {
+        do {
+            instant_t start = instant_now();
+            for (size_t _ = 0; _ < cfg.nb_reps; ++_) {
+                if (cfg.nb_threads != 1) {
+                    parallel_blas3_zgemm(l, m, n, alpha, Az, Bz, beta, Cz);
+                }
+                else {
+                    blas3_zgemm(l, m, n, alpha, Az, Bz, beta, Cz);
+                }
+            }
+            instant_t stop = instant_now();
+            elapsed = compute_avg_latency(start, stop, cfg.nb_reps);
+        } while (elapsed <= 0.0);
+        stats->samples[i] = elapsed;
+    }
+
+    free(Az);
+    free(Bz);
+    free(Cz);
+    stats_compute(stats);
+    return stats;
+}
+
+/**
+ * Calls a prefetch-enabled kernel once on vectors of `len` elements (or on a
+ * `len * len` matrix for `dgemv`).
+ **/
+static void run_prefetch_kernel(config_t cfg, prefetch_kernel_t kernel, size_t len, matrix_t* A,
+                                vector_t* x, vector_t* y)
+{
+    bool par = cfg.nb_threads != 1;
+
+    switch (kernel) {
+        case PREFETCH_DAXPY:
+            par ? parallel_blas1_daxpy(len, 0.5, x->data, y->data)
+                : blas1_daxpy(len, 0.5, x->data, y->data);
+            break;
+        case PREFETCH_DDOT:
+            par ? parallel_blas1_ddot(len, x->data, y->data) : blas1_ddot(len, x->data, y->data);
+            break;
+        case PREFETCH_DNRM2:
+            par ? parallel_blas1_dnrm2(len, x->data) : blas1_dnrm2(len, x->data);
+            break;
+        case PREFETCH_DMAX:
+            par ? parallel_blas1_dmax(len, x->data) : blas1_dmax(len, x->data);
+            break;
+        case PREFETCH_DSCAL:
+            par ? parallel_blas1_dscal(len, 1.0, x->data) : blas1_dscal(len, 1.0, x->data);
+            break;
+        case PREFETCH_DCOPY:
+            par ? parallel_blas1_dcopy(len, x->data, y->data) : blas1_dcopy(len, x->data, y->data);
+            break;
+        case PREFETCH_DGEMV:
+            par ? parallel_blas2_dgemv(len, len, 1.0, A->data, x->data, 0.0, y->data)
+                : blas2_dgemv(len, len, 1.0, A->data, x->data, 0.0, y->data);
+            break;
+        case PREFETCH_NB_KERNELS:
+            break;
+    }
+}
+
+/**
+ * Returns the number of elements `len` a kernel runs on, and in `nb_bytes`
+ * its working set as the kernel itself passes it to `prefetch_distance`,
+ * for a target working set of `target` bytes.
+ **/
+static size_t prefetch_kernel_len(prefetch_kernel_t kernel, size_t target, size_t* nb_bytes)
+{
+    size_t len;
+    switch (kernel) {
+        case PREFETCH_DGEMV:
+            len = (size_t)(sqrt((double)(target / sizeof(double))));
+            *nb_bytes = (len * len + 2 * len) * sizeof(double);
+            return len;
+        // Single-array kernels
+        case PREFETCH_DNRM2:
+        case PREFETCH_DMAX:
+        case PREFETCH_DSCAL:
+            len = target / sizeof(double);
+            *nb_bytes = len * sizeof(double);
+            return len;
+        default:
+            len = target / (2 * sizeof(double));
+            *nb_bytes = 2 * len * sizeof(double);
+            return len;
+    }
+}
+
+void driver_prefetch_tune(config_t cfg)
+{
+    // Tune the regular path of `dcopy` rather than its streaming one
+    size_t threshold = blas1_get_stream_threshold();
+    blas1_set_stream_threshold(SIZE_MAX);
+    if (cfg.nb_threads != 1) {
+        omp_set_num_threads(cfg.nb_threads);
+    }
+
+    for (size_class_t c = SIZE_CLASS_L1; c < NB_SIZE_CLASSES; ++c) {
+        // Fill half of the cache level, or twice the last level for `RAM`
+        size_t nb_bytes = c != SIZE_CLASS_RAM ? size_class_capacity(c) / 2
+                                              : size_class_capacity(SIZE_CLASS_L3) * 2;
+        // Vectors as long as those of the single-array kernels, the longest
+        size_t kernel_bytes;
+        size_t vec_len = prefetch_kernel_len(PREFETCH_DNRM2, nb_bytes, &kernel_bytes);
+        size_t mat_len = prefetch_kernel_len(PREFETCH_DGEMV, nb_bytes, &kernel_bytes);
+        // Move at least 256 MiB per sample to amortize timer resolution
+        size_t reps = (256 * 1024 * 1024) / nb_bytes + 1;
+
+        matrix_t* A = matrix_rand_init(mat_len, mat_len);
+        vector_t* x = vector_rand_init(vec_len > mat_len ? vec_len : mat_len);
+        vector_t* y = vector_rand_init(vec_len > mat_len ? vec_len : mat_len);
+        if (!A || !x || !y) {
+            fprintf(stderr, BOLD YELLOW "warning:" RESET " failed allocation, skipping %s.\n",
+                    size_class_to_str(c));
+            matrix_deinit(A);
+            vector_deinit(x);
+            vector_deinit(y);
+            continue;
+        }
+
+        for (prefetch_kernel_t k = PREFETCH_DAXPY; k < PREFETCH_NB_KERNELS; ++k) {
+            // Same working set whatever the number of arrays the kernel streams,
+            // so that it reads the entry of `c` being tuned
+            size_t len = prefetch_kernel_len(k, nb_bytes, &kernel_bytes);
+            assert(size_class_of(kernel_bytes) == c);
+            size_t best_dist = 0;
+            double best_time = INFINITY;
+
+            for (size_t d = 0; d < NB_PREFETCH_DISTANCES; ++d) {
+                prefetch_set_distance(k, c, PREFETCH_DISTANCES[d]);
+                double samples[PREFETCH_TUNE_SAMPLES];
+
+                // Warm up caches and page tables
+                run_prefetch_kernel(cfg, k, len, A, x, y);
+                for (size_t s = 0; s < PREFETCH_TUNE_SAMPLES; ++s) {
+                    instant_t start = instant_now();
+                    for (size_t _ = 0; _ < reps; ++_) {
+                        run_prefetch_kernel(cfg, k, len, A, x, y);
+                    }
+                    instant_t stop = instant_now();
+                    samples[s] = compute_avg_latency(start, stop, reps);
+                }
+
+                sort_double(samples, PREFETCH_TUNE_SAMPLES);
+                double median = samples[PREFETCH_TUNE_SAMPLES >> 1];
+                if (median < best_time) {
+                    best_time = median;
+                    best_dist = PREFETCH_DISTANCES[d];
+                }
+            }
+
+            prefetch_set_distance(k, c, best_dist);
+            if (cfg.is_verbose) {
+                printf("Tuned %-5s (%-3s): distance %4zu, %.3lf ns\n", prefetch_kernel_to_str(k),
+                       size_class_to_str(c), best_dist, best_time);
+            }
+        }
+
+        matrix_deinit(A);
+        vector_deinit(x);
+        vector_deinit(y);
+    }
+
+    blas1_set_stream_threshold(threshold);
+}
@@ -1,6 +1,7 @@
 #include "config.h"
 #include "drivers.h"
 #include "matrix.h"
+#include "prefetch.h"
 #include "stats.h"
 #include "utils.h"
 
@@ -44,6 +45,34 @@ int blas1_runs(config_t cfg)
     stats_dump(dnrm2_stats, cfg.output_filename);
     stats_dump(dmax_stats, cfg.output_filename);
 
+    // Compare the regular and non-temporal store paths
+    stats_t* daxpy_nt_stats = driver_daxpy_stream(cfg, alpha, x, y);
+    stats_t* dscal_stats = driver_dscal(cfg, alpha, x);
+    stats_t* dscal_nt_stats = driver_dscal_stream(cfg, alpha, x);
+    stats_t* dcopy_stats = driver_dcopy(cfg, x, y);
+    stats_t* dcopy_nt_stats = driver_dcopy_stream(cfg, x, y);
+    stats_dump(daxpy_nt_stats, cfg.output_filename);
+    stats_dump(dscal_stats, cfg.output_filename);
+    stats_dump(dscal_nt_stats, cfg.output_filename);
+    stats_dump(dcopy_stats, cfg.output_filename);
+    stats_dump(dcopy_nt_stats, cfg.output_filename);
+
+    // Compare against bfloat16 storage, with the error relative to the double kernels.
+    // The repeated `dscal` calls above drive `x` (and `y` through `dcopy`) towards zero, so
+    // fresh inputs are needed to get a meaningful error.
+    vector_deinit(x);
+    vector_deinit(y);
+    x = vector_rand_init(len);
+    y = vector_rand_init(len);
+    if (!x || !y) {
+        fprintf(stderr, BOLD RED "error:" RESET " failed vector allocation.\n");
+        exit(EXIT_FAILURE);
+    }
+    stats_t* daxpy_bf16_stats = driver_daxpy_bf16(cfg, alpha, x, y);
+    stats_t* ddot_bf16_stats = driver_ddot_bf16(cfg, x, y);
+    stats_dump(daxpy_bf16_stats, cfg.output_filename);
+    stats_dump(ddot_bf16_stats, cfg.output_filename);
+
     // Deallocate vectors
     vector_deinit(x);
     vector_deinit(y);
@@ -79,10 +108,21 @@ int blas2_runs(config_t cfg)
     printf("Running...\n");
     stats_t* dgemv_stats = driver_dgemv(cfg, alpha, A, x, beta, y);
     stats_t* dgemv_var_stats = driver_dgemv_var(cfg, alpha, A, x, beta, y);
+    // Before `dger`, whose repeated rank-1 updates leave `A` badly conditioned for bfloat16
+    stats_t* dgemv_bf16_stats = driver_dgemv_bf16(cfg, alpha, A, x, beta, y);
+    stats_t* sgemv_stats = driver_sgemv(cfg, alpha, A, x, beta, y);
     stats_t* dger_stats = driver_dger(cfg, alpha, A, x, y);
     stats_dump(dgemv_stats, cfg.output_filename);
     stats_dump(dgemv_var_stats, cfg.output_filename);
     stats_dump(dger_stats, cfg.output_filename);
+    stats_dump(dgemv_bf16_stats, cfg.output_filename);
+    stats_dump(sgemv_stats, cfg.output_filename);
+
+    // Compare against operands backed by huge pages
+    if (cfg.hugepages != ALLOC_DEFAULT) {
+        stats_t* dgemv_huge_stats = driver_dgemv_hugepages(cfg, alpha, A, x, beta, y);
+        stats_dump(dgemv_huge_stats, cfg.output_filename);
+    }
 
     // Deallocate matrix and vectors
     matrix_deinit(A);
@@ -117,10 +157,19 @@ int blas3_runs(config_t cfg)
     }
 
     printf("Running...\n");
+    // Before `dgemm`, which overwrites `B`
+    stats_t* zgemm_stats = driver_zgemm(cfg, alpha, A, B, beta);
     stats_t* dgemm_stats = driver_dgemm(cfg, alpha, A, B, beta, B);
     stats_t* dgemm_var_stats = driver_dgemm_var(cfg, alpha, A, B, beta, B);
     stats_dump(dgemm_stats, cfg.output_filename);
     stats_dump(dgemm_var_stats, cfg.output_filename);
+    stats_dump(zgemm_stats, cfg.output_filename);
+
+    // Compare against operands backed by huge pages
+    if (cfg.hugepages != ALLOC_DEFAULT) {
+        stats_t* dgemm_huge_stats = driver_dgemm_hugepages(cfg, alpha, A, B, beta, B);
+        stats_dump(dgemm_huge_stats, cfg.output_filename);
+    }
 
     // Deallocate matrix and vectors
     matrix_deinit(A);
@@ -140,11 +189,23 @@ int main(int argc, char* argv[argc + 1])
     FILE* ofp = cfg.output_filename != NULL ? fopen(cfg.output_filename, "wb") : stdout;
     if (!ofp)
         return -1;
-    fprintf(ofp, "#%s; %s; %s; %s; %s; %s; %s; %s; %s; %s; %s\n", "title", "BLAS_lvl", "threads",
-            "elems", "min", "mean", "max", "median", "stddevp", "GIB/s", "GFLOP/s");
-    fclose(ofp);
+    fprintf(ofp, "#%s; %s; %s; %s; %s; %s; %s; %s; %s; %s; %s; %s\n", "title", "BLAS_lvl",
+            "threads", "elems", "min", "mean", "max", "median", "stddevp", "GIB/s", "GFLOP/s",
+            "rel_error");
+    if (ofp != stdout)
+        fclose(ofp);
 
     srand(0);
+    matrix_rand_seed(0);
+    if (cfg.prefetch_dist != 0) {
+        prefetch_set_all(cfg.prefetch_dist);
+    }
+    if (cfg.is_tuning) {
+        printf("Tuning prefetch distances...\n");
+        driver_prefetch_tune(cfg);
+        prefetch_table_dump(cfg.output_filename);
+    }
+
     if (cfg.blas_level == BLAS_ONE || cfg.blas_level == BLAS_ONE_TWO ||
         cfg.blas_level == BLAS_ONE_THREE || cfg.blas_level == BLAS_ALL) {
         blas1_runs(cfg);
@@ -3,10 +3,133 @@
 #include "utils.h"
 
 #include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
 #include <time.h>
+#if defined(__AVX__)
+    #include <immintrin.h>
+#endif
+
+// Edge of the square tiles processed by the blocked transposes
+#define TRANSPOSE_TILE 32
+
+// Policy used by the matrix constructors to allocate their elements
+static alloc_policy_t alloc_policy = ALLOC_DEFAULT;
+
+void matrix_set_alloc_policy(alloc_policy_t policy)
+{
+    alloc_policy = policy;
+}
+
+alloc_policy_t matrix_get_alloc_policy(void)
+{
+    return alloc_policy;
+}
+
+char const* alloc_policy_to_str(alloc_policy_t policy)
+{
+    switch (policy) {
+        case ALLOC_DEFAULT:
+            return "default";
+        case ALLOC_THP:
+            return "thp";
+        case ALLOC_HUGETLBFS:
+            return "hugetlbfs";
+    }
+
+    // Unreachable
+    return NULL;
+}
+
+/**
+ * Maps `nb_bytes` (a multiple of `HUGEPAGE_SIZE`) from the hugetlbfs pool.
+ * Returns NULL if the pool is empty or not configured.
+ **/
+static void* hugetlbfs_alloc(size_t nb_bytes)
+{
+#if defined(MAP_HUGETLB)
+    void* ptr = mmap(NULL, nb_bytes, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    return ptr != MAP_FAILED ? ptr : NULL;
+#else
+    (void)nb_bytes;
+    return NULL;
+#endif
+}
+
+/**
+ * Maps `nb_bytes` (a multiple of `HUGEPAGE_SIZE`) aligned on a huge page
+ * boundary and asks for transparent huge pages. The mapping is over-allocated
+ * by one huge page and the misaligned head and tail are unmapped.
+ **/
+static void* thp_alloc(size_t nb_bytes)
+{
+    size_t const padded = nb_bytes + HUGEPAGE_SIZE;
+    unsigned char* raw =
+        mmap(NULL, padded, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED)
+        return NULL;
+
+    uintptr_t const addr = (uintptr_t)raw;
+    unsigned char* ptr =
+        (unsigned char*)((addr + HUGEPAGE_SIZE - 1) & ~(uintptr_t)(HUGEPAGE_SIZE - 1));
+    size_t const head = (size_t)(ptr - raw);
+    if (head != 0) {
+        munmap(raw, head);
+    }
+    if (padded - head - nb_bytes != 0) {
+        munmap(ptr + nb_bytes, padded - head - nb_bytes);
+    }
+
+#if defined(MADV_HUGEPAGE)
+    // Only a hint: the mapping stays usable with regular pages if THP is disabled
+    madvise(ptr, nb_bytes, MADV_HUGEPAGE);
+#endif
+    return ptr;
+}
+
+/**
+ * Allocates the elements of `self` according to the current allocation
+ * policy, falling back to the next available policy on failure. Returns
+ * false if no policy succeeded.
+ **/
+static bool matrix_data_alloc(matrix_t* self)
+{
+    size_t const nb_bytes = self->rows * self->cols * sizeof(double);
+    size_t const mapped = (nb_bytes + HUGEPAGE_SIZE - 1) & ~(HUGEPAGE_SIZE - 1);
+
+    self->data = NULL;
+    self->alloc = ALLOC_DEFAULT;
+    self->alloc_size = 0;
+    if (nb_bytes < HUGEPAGE_SIZE || alloc_policy == ALLOC_DEFAULT) {
+        goto heap;
+    }
+
+    if (alloc_policy == ALLOC_HUGETLBFS) {
+        self->data = hugetlbfs_alloc(mapped);
+        if (self->data) {
+            self->alloc = ALLOC_HUGETLBFS;
+            self->alloc_size = mapped;
+            return true;
+        }
+    }
+
+    self->data = thp_alloc(mapped);
+    if (self->data) {
+        self->alloc = ALLOC_THP;
+        self->alloc_size = mapped;
+        return true;
+    }
+
+heap:
+    // `aligned_alloc` requires a size multiple of the alignment
+    self->data = aligned_alloc(ALIGNMENT, (nb_bytes + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT);
+    return self->data != NULL;
+}
 
 vector_t* vector_zeroes(size_t len)
 {
@@ -21,8 +144,7 @@ matrix_t* matrix_zeroes(size_t rows, size_t cols)
 
     self->rows = rows;
     self->cols = cols;
-    self->data = aligned_alloc(ALIGNMENT, rows * cols * sizeof(double));
-    if (!self->data) {
+    if (!matrix_data_alloc(self)) {
         free(self);
         return NULL;
     }
@@ -44,8 +166,7 @@ matrix_t* matrix_ones(size_t rows, size_t cols)
 
     self->rows = rows;
     self->cols = cols;
-    self->data = aligned_alloc(ALIGNMENT, rows * cols * sizeof(double));
-    if (!self->data) {
+    if (!matrix_data_alloc(self)) {
         free(self);
         return NULL;
     }
@@ -57,6 +178,16 @@ matrix_t* matrix_ones(size_t rows, size_t cols)
     return self;
 }
 
+// Seed of `matrix_rand_init` and number of matrices initialized since it was set
+static uint64_t rand_seed = 0;
+static uint64_t rand_stream = 0;
+
+void matrix_rand_seed(uint64_t seed)
+{
+    rand_seed = seed;
+    rand_stream = 0;
+}
+
 vector_t* vector_rand_init(size_t len)
 {
     vector_t* self = matrix_rand_init(len, 1);
@@ -71,14 +202,17 @@ matrix_t* matrix_rand_init(size_t rows, size_t cols)
 
     self->rows = rows;
     self->cols = cols;
-    self->data = aligned_alloc(ALIGNMENT, rows * cols * sizeof(double));
-    if (!self->data) {
+    if (!matrix_data_alloc(self)) {
         free(self);
         return NULL;
     }
 
+    // Each matrix draws from its own stream, derived from the seed
+    uint64_t const key = splitmix64(rand_seed ^ splitmix64(rand_stream++));
+    double* restrict data = self->data;
+#pragma omp parallel for simd schedule(static)
     for (size_t i = 0; i < rows * cols; ++i) {
-        self->data[i] = rand_double_range(-1.0, 1.0);
+        data[i] = counter_double_range(key, i, -1.0, 1.0);
     }
 
     return self;
@@ -94,7 +228,10 @@ void vector_deinit(vector_t* self)
 void matrix_deinit(matrix_t* self)
 {
     if (self) {
-        if (self->data) {
+        if (self->data && self->alloc_size != 0) {
+            munmap(self->data, self->alloc_size);
+        }
+        else if (self->data) {
             free(self->data);
         }
         free(self);
@@ -111,15 +248,191 @@ void vector_transpose(vector_t* self)
     self->cols = tmp;
 }
 
-void matrix_transpose(matrix_t const* self, matrix_t* transposed)
+/**
+ * Transposes a 4x4 block of doubles in registers, reading rows of `src` and
+ * writing them as columns of `dst`.
+ **/
+static inline void transpose_4x4(double const* restrict src, size_t lds, double* restrict dst,
+                                 size_t ldd)
 {
-    for (size_t i = 0; i < self->rows; ++i) {
-        for (size_t j = 0; j < self->cols; ++j) {
-            transposed->data[j * self->cols + i] = self->data[i * self->cols + j];
+#if defined(__AVX__)
+    __m256d r0 = _mm256_loadu_pd(src + 0 * lds);
+    __m256d r1 = _mm256_loadu_pd(src + 1 * lds);
+    __m256d r2 = _mm256_loadu_pd(src + 2 * lds);
+    __m256d r3 = _mm256_loadu_pd(src + 3 * lds);
+
+    // Interleave pairs of rows, then exchange the 128-bit lanes
+    __m256d t0 = _mm256_unpacklo_pd(r0, r1);
+    __m256d t1 = _mm256_unpackhi_pd(r0, r1);
+    __m256d t2 = _mm256_unpacklo_pd(r2, r3);
+    __m256d t3 = _mm256_unpackhi_pd(r2, r3);
+
+    _mm256_storeu_pd(dst + 0 * ldd, _mm256_permute2f128_pd(t0, t2, 0x20));
+    _mm256_storeu_pd(dst + 1 * ldd, _mm256_permute2f128_pd(t1, t3, 0x20));
+    _mm256_storeu_pd(dst + 2 * ldd, _mm256_permute2f128_pd(t0, t2, 0x31));
+    _mm256_storeu_pd(dst + 3 * ldd, _mm256_permute2f128_pd(t1, t3, 0x31));
+#else
+    for (size_t i = 0; i < 4; ++i) {
+        for (size_t j = 0; j < 4; ++j) {
+            dst[j * ldd + i] = src[i * lds + j];
+        }
+    }
+#endif
+}
+
+/**
+ * Transposes two 4x4 blocks `a` and `b` of the same matrix into each other's
+ * place. Both blocks are loaded before anything is stored, so `a` and `b` may
+ * be the same diagonal block.
+ **/
+static inline void transpose_swap_4x4(double* a, double* b, size_t ld)
+{
+    double tmp_a[16];
+    double tmp_b[16];
+
+    transpose_4x4(a, ld, tmp_a, 4);
+    transpose_4x4(b, ld, tmp_b, 4);
+    for (size_t i = 0; i < 4; ++i) {
+        memcpy(b + i * ld, tmp_a + i * 4, 4 * sizeof(double));
+        memcpy(a + i * ld, tmp_b + i * 4, 4 * sizeof(double));
+    }
+}
+
+/**
+ * Out-of-place transpose of the row-major `rows * cols` array `src` into
+ * `dst`, by `TRANSPOSE_TILE`-wide tiles so that both the rows read and the
+ * columns written stay in cache. Tiles are distributed across threads.
+ **/
+static void transpose_blocked(size_t rows, size_t cols, double const* restrict src, size_t lds,
+                              double* restrict dst, size_t ldd)
+{
+#pragma omp parallel for collapse(2) schedule(static)
+    for (size_t ii = 0; ii < rows; ii += TRANSPOSE_TILE) {
+        for (size_t jj = 0; jj < cols; jj += TRANSPOSE_TILE) {
+            size_t const i_end = ii + TRANSPOSE_TILE < rows ? ii + TRANSPOSE_TILE : rows;
+            size_t const j_end = jj + TRANSPOSE_TILE < cols ? jj + TRANSPOSE_TILE : cols;
+
+            size_t i = ii;
+            for (; i + 4 <= i_end; i += 4) {
+                size_t j = jj;
+                for (; j + 4 <= j_end; j += 4) {
+                    transpose_4x4(src + i * lds + j, lds, dst + j * ldd + i, ldd);
+                }
+                // Remainder columns of the tile
+                for (; j < j_end; ++j) {
+                    for (size_t k = i; k < i + 4; ++k) {
+                        dst[j * ldd + k] = src[k * lds + j];
+                    }
+                }
+            }
+            // Remainder rows of the tile
+            for (; i < i_end; ++i) {
+                for (size_t j = jj; j < j_end; ++j) {
+                    dst[j * ldd + i] = src[i * lds + j];
+                }
+            }
         }
     }
 }
 
+/**
+ * In-place transpose of the square row-major `n * n` array `data`. Pairs of
+ * 4x4 blocks on either side of the diagonal are swapped, one tile row per
+ * iteration of the parallel loop.
+ **/
+static void transpose_square_inplace(size_t n, double* data)
+{
+    size_t const n4 = n - n % 4;
+
+#pragma omp parallel for schedule(dynamic)
+    for (size_t ii = 0; ii < n4; ii += TRANSPOSE_TILE) {
+        size_t const i_end = ii + TRANSPOSE_TILE < n4 ? ii + TRANSPOSE_TILE : n4;
+        for (size_t i = ii; i < i_end; i += 4) {
+            for (size_t j = i; j < n4; j += 4) {
+                transpose_swap_4x4(data + i * n + j, data + j * n + i, n);
+            }
+        }
+    }
+
+    // Remainder rows/columns that do not fit in 4x4 blocks
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = i >= n4 ? i + 1 : n4; j < n; ++j) {
+            double tmp = data[i * n + j];
+            data[i * n + j] = data[j * n + i];
+            data[j * n + i] = tmp;
+        }
+    }
+}
+
+/**
+ * In-place transpose of the rectangular row-major `rows * cols` array `data`
+ * by following the cycles of the permutation `p -> p * rows mod (N - 1)`,
+ * where `N = rows * cols`. Visited positions are tracked in a bitset (one
+ * bit per element). If it cannot be allocated, each cycle is only followed
+ * from its smallest position instead, which is slower but needs no memory.
+ **/
+static void transpose_cycles_inplace(size_t rows, size_t cols, double* data)
+{
+    size_t const last = rows * cols - 1;
+    uint64_t* visited = calloc(last / 64 + 1, sizeof(uint64_t));
+
+    for (size_t start = 1; start < last; ++start) {
+        if (visited) {
+            if (visited[start / 64] & (UINT64_C(1) << (start % 64)))
+                continue;
+        }
+        else {
+            // Only follow the cycle from its leader, i.e. its smallest position
+            size_t p = (start * rows) % last;
+            while (p > start) {
+                p = (p * rows) % last;
+            }
+            if (p < start)
+                continue;
+        }
+
+        // Element at position `p = i * cols + j` moves to `j * rows + i`
+        double moving = data[start];
+        size_t p = start;
+        do {
+            size_t const next = (p * rows) % last;
+            double const tmp = data[next];
+            data[next] = moving;
+            moving = tmp;
+            if (visited) {
+                visited[next / 64] |= UINT64_C(1) << (next % 64);
+            }
+            p = next;
+        } while (p != start);
+    }
+
+    free(visited);
+}
+
+void matrix_transpose(matrix_t const* self, matrix_t* transposed)
+{
+    assert(self->rows * self->cols == transposed->rows * transposed->cols);
+
+    transpose_blocked(self->rows, self->cols, self->data, self->cols, transposed->data,
+                      self->rows);
+    transposed->rows = self->cols;
+    transposed->cols = self->rows;
+}
+
+void matrix_transpose_inplace(matrix_t* self)
+{
+    if (self->rows == self->cols) {
+        transpose_square_inplace(self->rows, self->data);
+    }
+    else if (self->rows > 1 && self->cols > 1) {
+        transpose_cycles_inplace(self->rows, self->cols, self->data);
+    }
+
+    size_t tmp = self->rows;
+    self->rows = self->cols;
+    self->cols = tmp;
+}
+
 void print_vector(vector_t const* self, char const* name)
 {
     if (!self)
@@ -203,3 +516,61 @@ matrix_t* matrix_copy(matrix_t const* self)
 
     return copy;
 }
+
+matrix_bf16_t* matrix_to_bf16(matrix_t const* self)
+{
+    matrix_bf16_t* narrow = malloc(sizeof(matrix_bf16_t));
+    if (!narrow)
+        return NULL;
+
+    size_t nb_bytes = self->rows * self->cols * sizeof(bf16_t);
+    narrow->rows = self->rows;
+    narrow->cols = self->cols;
+    // `aligned_alloc` requires a size multiple of the alignment
+    narrow->data = aligned_alloc(ALIGNMENT, (nb_bytes + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT);
+    if (!narrow->data) {
+        free(narrow);
+        return NULL;
+    }
+
+    for (size_t i = 0; i < self->rows * self->cols; ++i) {
+        narrow->data[i] = bf16_from_float((float)(self->data[i]));
+    }
+
+    return narrow;
+}
+
+vector_bf16_t* vector_to_bf16(vector_t const* self)
+{
+    return matrix_to_bf16(self);
+}
+
+matrix_t* matrix_from_bf16(matrix_bf16_t const* self)
+{
+    matrix_t* wide = matrix_zeroes(self->rows, self->cols);
+    if (!wide)
+        return NULL;
+
+    for (size_t i = 0; i < self->rows * self->cols; ++i) {
+        wide->data[i] = (double)(bf16_to_float(self->data[i]));
+    }
+
+    return wide;
+}
+
+void matrix_bf16_deinit(matrix_bf16_t* self)
+{
+    if (self) {
+        if (self->data) {
+            free(self->data);
+        }
+        free(self);
+    }
+}
+
+void vector_bf16_deinit(vector_bf16_t* self)
+{
+    if (!self)
+        return;
+    matrix_bf16_deinit(self);
+}
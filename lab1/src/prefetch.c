@@ -0,0 +1,140 @@
+#include "prefetch.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <unistd.h>
+
+// Fallback cache sizes when they cannot be queried from the system
+#define DEFAULT_L1_SIZE (32 * 1024)
+#define DEFAULT_L2_SIZE (1024 * 1024)
+#define DEFAULT_L3_SIZE (32 * 1024 * 1024)
+
+size_t const PREFETCH_DISTANCES[NB_PREFETCH_DISTANCES] = { 0, 8, 16, 32, 64, 128, 256, 512, 1024 };
+
+// Software prefetching is disabled until set explicitly or tuned
+static size_t prefetch_table[PREFETCH_NB_KERNELS][NB_SIZE_CLASSES] = { 0 };
+
+char const* prefetch_kernel_to_str(prefetch_kernel_t kernel)
+{
+    switch (kernel) {
+        case PREFETCH_DAXPY:
+            return "daxpy";
+        case PREFETCH_DDOT:
+            return "ddot";
+        case PREFETCH_DNRM2:
+            return "dnrm2";
+        case PREFETCH_DMAX:
+            return "dmax";
+        case PREFETCH_DSCAL:
+            return "dscal";
+        case PREFETCH_DCOPY:
+            return "dcopy";
+        case PREFETCH_DGEMV:
+            return "dgemv";
+        case PREFETCH_NB_KERNELS:
+            break;
+    }
+
+    // Unreachable
+    return NULL;
+}
+
+char const* size_class_to_str(size_class_t size_class)
+{
+    switch (size_class) {
+        case SIZE_CLASS_L1:
+            return "L1";
+        case SIZE_CLASS_L2:
+            return "L2";
+        case SIZE_CLASS_L3:
+            return "L3";
+        case SIZE_CLASS_RAM:
+            return "RAM";
+        case NB_SIZE_CLASSES:
+            break;
+    }
+
+    // Unreachable
+    return NULL;
+}
+
+size_t size_class_capacity(size_class_t size_class)
+{
+    long size = 0;
+
+    switch (size_class) {
+        case SIZE_CLASS_L1:
+            size = sysconf(_SC_LEVEL1_DCACHE_SIZE);
+            return size > 0 ? (size_t)(size) : DEFAULT_L1_SIZE;
+        case SIZE_CLASS_L2:
+            size = sysconf(_SC_LEVEL2_CACHE_SIZE);
+            return size > 0 ? (size_t)(size) : DEFAULT_L2_SIZE;
+        case SIZE_CLASS_L3:
+            size = sysconf(_SC_LEVEL3_CACHE_SIZE);
+            return size > 0 ? (size_t)(size) : DEFAULT_L3_SIZE;
+        default:
+            return SIZE_MAX;
+    }
+}
+
+size_class_t size_class_of(size_t nb_bytes)
+{
+    static size_t capacities[NB_SIZE_CLASSES] = { 0 };
+    if (capacities[SIZE_CLASS_L1] == 0) {
+        for (size_t c = 0; c < NB_SIZE_CLASSES; ++c) {
+            capacities[c] = size_class_capacity(c);
+        }
+    }
+
+    size_t c = SIZE_CLASS_L1;
+    while (c < SIZE_CLASS_RAM && nb_bytes > capacities[c]) {
+        c++;
+    }
+
+    return c;
+}
+
+size_t prefetch_distance(prefetch_kernel_t kernel, size_t nb_bytes)
+{
+    return prefetch_table[kernel][size_class_of(nb_bytes)];
+}
+
+void prefetch_set_distance(prefetch_kernel_t kernel, size_class_t size_class, size_t dist)
+{
+    prefetch_table[kernel][size_class] = dist;
+}
+
+void prefetch_set_all(size_t dist)
+{
+    for (size_t k = 0; k < PREFETCH_NB_KERNELS; ++k) {
+        for (size_t c = 0; c < NB_SIZE_CLASSES; ++c) {
+            prefetch_table[k][c] = dist;
+        }
+    }
+}
+
+int prefetch_table_dump(char const* filename)
+{
+    FILE* ofp = (filename == NULL) ? stdout : fopen(filename, "ab");
+    if (!ofp)
+        return -1;
+
+    fprintf(ofp, "#%s", "kernel");
+    for (size_t c = 0; c < NB_SIZE_CLASSES; ++c) {
+        fprintf(ofp, "; %s", size_class_to_str(c));
+    }
+    fprintf(ofp, "\n");
+
+    for (size_t k = 0; k < PREFETCH_NB_KERNELS; ++k) {
+        fprintf(ofp, "%s", prefetch_kernel_to_str(k));
+        for (size_t c = 0; c < NB_SIZE_CLASSES; ++c) {
+            fprintf(ofp, "; %zu", prefetch_table[k][c]);
+        }
+        fprintf(ofp, "\n");
+    }
+
+    if (filename) {
+        fclose(ofp);
+    }
+    return 0;
+}
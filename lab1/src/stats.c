@@ -19,6 +19,7 @@ stats_t* stats_init(char const* title, uint8_t blas_lvl, size_t nb_threads, size
     self->nb_elems = nb_elems;
     self->nb_bytes = nb_elems * (sizeof(double));
     self->nb_flops = nb_flops;
+    self->error = 0.0;
 
     return self;
 }
@@ -55,9 +56,11 @@ int stats_dump(stats_t const* self, char const* filename)
     if (!ofp)
         return -1;
 
-    fprintf(ofp, "%s; %u; %zu; %zu; %2.3lf; %2.3lf; %2.3lf; %2.3lf; %2.3lf%%; %2.3lf; %2.3lf\n",
+    fprintf(ofp,
+            "%s; %u; %zu; %zu; %2.3lf; %2.3lf; %2.3lf; %2.3lf; %2.3lf%%; %2.3lf; %2.3lf; %.3e\n",
             self->title, self->blas_lvl, self->nb_threads, self->nb_elems, self->min, self->mean,
-            self->max, self->median, self->stddevp, self->mem_throughput, self->ops_throughput);
+            self->max, self->median, self->stddevp, self->mem_throughput, self->ops_throughput,
+            self->error);
 
     if (filename) {
         fclose(ofp);
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "matrix.h"
+
+#include <stddef.h>
+
+/**
+ * Represents a workspace arena: a single aligned buffer from which
+ * allocations are carved by bumping an offset. Nothing is freed
+ * individually; instead, the offset is reset to a previously saved mark,
+ * which releases everything allocated since in O(1).
+ *
+ * Routines that need scratch memory take an arena and reset it before
+ * returning, so that repeated calls on the same arena do not allocate.
+ **/
+typedef struct arena_s {
+    unsigned char* data;
+    size_t capacity;
+    size_t offset;
+} arena_t;
+
+/**
+ * Creates a new arena able to hold `capacity` bytes.
+ **/
+arena_t* arena_init(size_t capacity);
+
+/**
+ * Deallocates an arena and everything allocated from it.
+ **/
+void arena_deinit(arena_t* self);
+
+/**
+ * Returns `size` bytes aligned on `ALIGNMENT` bytes from the arena, or NULL
+ * if it does not have enough room left.
+ **/
+void* arena_alloc(arena_t* self, size_t size);
+
+/**
+ * Returns the current position of the arena, to be given to `arena_reset`.
+ **/
+size_t arena_mark(arena_t const* self);
+
+/**
+ * Releases all the allocations made since `mark` was taken.
+ **/
+void arena_reset(arena_t* self, size_t mark);
+
+/**
+ * Returns the number of arena bytes needed by `arena_matrix` for a
+ * `rows * cols` matrix, padding included.
+ **/
+size_t arena_matrix_size(size_t rows, size_t cols);
+
+/**
+ * Creates a new matrix of `rows * cols` elements in the arena, initialized
+ * with zeroes. It must not be given to `matrix_deinit`.
+ **/
+matrix_t* arena_matrix(arena_t* self, size_t rows, size_t cols, layout_t layout);
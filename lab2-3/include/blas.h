@@ -1,79 +1,78 @@
 #pragma once
 
+#include "arena.h"
 #include "matrix.h"
 
+#include <complex.h>
 #include <stddef.h>
 
-/**
- * Computes a double precision scalar-vector product and adds the result to a
- * vector.
- *
- * The `daxpy` routine performs a vector-vector operation defined as:
- *   y = a * x + y
- *
- * Where:
- * - `a` is a scalar.
- * - `x` and `y` are vectors.
- * - `len` is the number of elements in the vectors.
- **/
-void daxpy(size_t len, double alpha, double const* x, double* y);
+// Single precision real kernels (`saxpy`, `sdot`, ...)
+#define BLAS_PREFIX s
+#define BLAS_T float
+#define BLAS_R float
+#include "blas_template.h"
+
+// Double precision real kernels (`daxpy`, `ddot`, ...)
+#define BLAS_PREFIX d
+#define BLAS_T double
+#define BLAS_R double
+#include "blas_template.h"
+
+// Single precision complex kernels (`caxpy`, `cdot`, ...)
+#define BLAS_PREFIX c
+#define BLAS_T float complex
+#define BLAS_R float
+#include "blas_template.h"
+
+// Double precision complex kernels (`zaxpy`, `zdot`, ...)
+#define BLAS_PREFIX z
+#define BLAS_T double complex
+#define BLAS_R double
+#include "blas_template.h"
 
 /**
- * Computes a double precision vector-vector dot product.
- *
- * The `ddot` routine performs a vector-vector operation defined as:
- *   res = x * y
- *
- * Where:
- * - `x` and `y` are vectors.
- * - `len` is the number of elements in the vectors.
+ * Type-generic front-ends, dispatching to the `s`, `d`, `c` or `z` kernel
+ * based on the element type of the last vector/matrix argument.
  **/
-double ddot(size_t len, double const* x, double const* y);
+#define BLAS_GENERIC(name, ptr)                                                                    \
+    _Generic(*(ptr),                                                                               \
+        float: s##name,                                                                            \
+        double: d##name,                                                                           \
+        float complex: c##name,                                                                    \
+        double complex: z##name)
+
+#define axpy(len, alpha, x, y) BLAS_GENERIC(axpy, y)(len, alpha, x, y)
+#define dot(len, x, y) BLAS_GENERIC(dot, y)(len, x, y)
+#define nrm2(len, x) BLAS_GENERIC(nrm2, x)(len, x)
+#define nrmf(rows, cols, A) BLAS_GENERIC(nrmf, A)(rows, cols, A)
+#define gemv(m, n, alpha, A, x, beta, y) BLAS_GENERIC(gemv, y)(m, n, alpha, A, x, beta, y)
+#define gemm(l, m, n, alpha, A, B, beta, C) BLAS_GENERIC(gemm, C)(l, m, n, alpha, A, B, beta, C)
 
 /**
- * Computes the double precision Euclidean/L2 norm of a vector.
- *
- * The `nrm2` routine performs a vector reduction operation defined as:
- *   res = ||x||
- *
- * Where:
- * - `x` is a vector.
- * - `len` is the number of elements in the vector.
+ * Double precision kernels operating directly on matrix/vector views, see
+ * `matrix_view_t`. They forward to the `d?_strided` kernels.
  **/
-double dnrm2(size_t len, double const* x);
+void daxpy_view(double alpha, vector_view_t x, vector_view_t y);
+double ddot_view(vector_view_t x, vector_view_t y);
+double dnrm2_view(vector_view_t x);
+void dgemv_view(double alpha, matrix_view_t A, vector_view_t x, double beta, vector_view_t y);
 
 /**
- * Computes the double precision Frobenius norm of a matrix.
- *
- * The `nrmf` routine performs a matrix operation defined as:
- *   res = ||A||
- *
- * Where:
- * - `A` is a matrix.
- * - `rows` is the number of elements in the matrix's rows.
- * - `cols` is the number of elements in the matrix's cols.
+ * Returns the size in bytes of the workspace needed by
+ * `classical_gram_schmidt` and `modified_gram_schmidt` for vectors of `n`
+ * elements.
  **/
-double dnrmf(size_t rows, size_t cols, double const* A);
+size_t gram_schmidt_workspace(size_t n);
 
 /**
- * Computes a double precision matrix-vector product and adds the result to the
- * `y` vector.
- *
- * The `dgemv` routine performs a matrix-vector operation defined as:
- *   y = alpha * A * x + beta * y
- *
- * Where:
- * - `alpha` and `beta` are scalars.
- * - `x` and `y` are vectors.
- * - `A` is a matrix.
- * - `m` is the number of elements in the matrix rows.
- * - `n` is the number of elements in the matrix columns and in the vectors.
+ * Builds an orthonormal basis `Q` of the Krylov subspace of `A` spanned by
+ * `x` and the Hessenberg matrix `H`, with classical (resp. modified)
+ * Gram-Schmidt. Scratch memory is taken from `ws`, which must hold at least
+ * `gram_schmidt_workspace(n)` bytes and is left as it was given. If `ws` is
+ * NULL, a temporary workspace is allocated for the call.
  **/
-void dgemv(size_t m, size_t n, double alpha, double const* restrict A, double const* restrict x,
-           double beta, double* restrict y);
-
 void classical_gram_schmidt(size_t n, double* restrict x, double* restrict A, size_t deg_m,
-                            matrix_t* mat_Q, matrix_t* mat_H);
+                            matrix_t* mat_Q, matrix_t* mat_H, arena_t* ws);
 
 void modified_gram_schmidt(size_t n, double* restrict x, double* restrict A, size_t deg_m,
-                           matrix_t* mat_Q, matrix_t* mat_H);
+                           matrix_t* mat_Q, matrix_t* mat_H, arena_t* ws);
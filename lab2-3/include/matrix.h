@@ -1,17 +1,31 @@
 #pragma once
 
 #include <stddef.h>
+#include <stdint.h>
 
 #define ALIGNMENT 64
 
+/**
+ * Storage order of the elements of a matrix.
+ **/
+typedef enum layout_e {
+    ROW_MAJOR,
+    COL_MAJOR,
+} layout_t;
+
 /**
  * Represents a matrix storing double precision floating-point values stored
- * contiguously in memory, of dimensions `rows * cols`.
+ * contiguously in memory, of dimensions `rows * cols`, either row by row or
+ * column by column depending on its `layout`.
  **/
 typedef struct matrix_s {
     double* data;
     size_t rows;
     size_t cols;
+    layout_t layout;
+    // File mapping backing `data`, if any (see `matrix_map`)
+    void* mapping;
+    size_t mapping_len;
 } matrix_t;
 
 /**
@@ -20,18 +34,98 @@ typedef struct matrix_s {
  **/
 typedef matrix_t vector_t;
 
+/**
+ * Represents a strided view over the elements of a matrix, without owning
+ * them. Element `(i, j)` of the view is stored at
+ * `data[offset + i * ld + j * stride]`, where:
+ * - `data` is the storage of the viewed matrix.
+ * - `offset` is the position of the view's first element in `data`.
+ * - `ld` (leading dimension) is the distance between two consecutive rows.
+ * - `stride` is the distance between two consecutive columns.
+ *
+ * Rows, columns and submatrices of a row-major matrix can all be described
+ * this way, and so can its transpose by swapping `ld` and `stride`.
+ **/
+typedef struct matrix_view_s {
+    double* data;
+    size_t offset;
+    size_t rows;
+    size_t cols;
+    size_t ld;
+    size_t stride;
+} matrix_view_t;
+
+/**
+ * Represents a strided view over a vector, i.e. a view with one of its
+ * dimensions set to 1.
+ **/
+typedef matrix_view_t vector_view_t;
+
+/**
+ * Magic bytes at the start of a binary matrix file.
+ **/
+#define MATRIX_FILE_MAGIC "MPNAMAT\x01"
+
+/**
+ * Type of the elements stored in a binary matrix file.
+ **/
+typedef enum matrix_dtype_e {
+    DTYPE_F64,
+} matrix_dtype_t;
+
+/**
+ * Header of a binary matrix file. It is followed by padding up to
+ * `data_offset`, then by the `rows * cols` raw elements, in the byte order of
+ * the machine that wrote them and in the given `layout`. `data_offset` is a
+ * multiple of `alignment`, itself a multiple of the page size, so that the
+ * elements can be mapped in place.
+ **/
+typedef struct matrix_file_header_s {
+    char magic[8];
+    uint32_t dtype;
+    uint32_t layout;
+    uint64_t alignment;
+    uint64_t rows;
+    uint64_t cols;
+    uint64_t data_offset;
+} matrix_file_header_t;
+
+/**
+ * Reads a matrix from a file. Binary matrix files (see `matrix_write`) are
+ * mapped with `matrix_map`, other files are parsed as ASCII: the dimensions
+ * followed by the elements in row-major order.
+ **/
 matrix_t* matrix_read(const char* filename);
 
+/**
+ * Writes a matrix to a binary matrix file. Returns 0 on success, -1 on error.
+ **/
+int matrix_write(matrix_t const* self, char const* filename);
+
+/**
+ * Maps a binary matrix file in memory and returns a matrix whose elements
+ * point directly at the mapping, without copying them. The mapping is private:
+ * writes to the matrix are not carried over to the file. Returns NULL on error.
+ **/
+matrix_t* matrix_map(char const* filename);
+
 /**
  * Creates a new column vector of `len` elements, initialized with zeroes.
  **/
 vector_t* vector_zeroes(size_t len);
 
 /**
- * Creates a new matrix of `rows * cols` elements, initialized with zeroes.
+ * Creates a new row-major matrix of `rows * cols` elements, initialized with
+ * zeroes.
  **/
 matrix_t* matrix_zeroes(size_t rows, size_t cols);
 
+/**
+ * Creates a new matrix of `rows * cols` elements with the given storage
+ * layout, initialized with zeroes.
+ **/
+matrix_t* matrix_zeroes_layout(size_t rows, size_t cols, layout_t layout);
+
 /**
  * Creates a new column vector of `len` elements, initialized with ones.
  **/
@@ -51,9 +145,18 @@ vector_t* vector_rand_init(size_t len);
 /**
  * Creates a new matrix of `rows * cols` elements, initialized with random
  * values ranging in the interval of ]-1.0, 1.0[.
+ *
+ * Elements are drawn in parallel from a counter-based generator, so the
+ * result only depends on the seed and on the number of matrices initialized
+ * since it was set, not on the number of threads.
  **/
 matrix_t* matrix_rand_init(size_t rows, size_t cols);
 
+/**
+ * Sets the seed of `matrix_rand_init` and restarts its sequence of matrices.
+ **/
+void matrix_rand_seed(uint64_t seed);
+
 /**
  * Deallocates a vector.
  **/
@@ -70,10 +173,15 @@ void matrix_deinit(matrix_t* self);
 void vector_transpose(vector_t* self);
 
 /**
- * Transposes a matrix.
+ * Transposes a matrix. `self` and `transposed` may have different layouts.
  **/
 void matrix_transpose(matrix_t const* self, matrix_t* transposed);
 
+/**
+ * Transposes a matrix in place, without allocating a second matrix.
+ **/
+void matrix_transpose_inplace(matrix_t* self);
+
 /**
  * Prints a given vector.
  **/
@@ -89,3 +197,63 @@ size_t matrix_nb_elems(matrix_t const* self);
 size_t vector_nb_elems(vector_t const* self);
 
 matrix_t* matrix_copy(matrix_t const* self);
+
+/**
+ * Returns the position of element `(i, j)` in the storage of a matrix,
+ * according to its layout.
+ **/
+static inline size_t matrix_index(matrix_t const* self, size_t i, size_t j)
+{
+    return self->layout == ROW_MAJOR ? i * self->cols + j : j * self->rows + i;
+}
+
+/**
+ * Creates a view over the whole matrix.
+ **/
+matrix_view_t matrix_view(matrix_t const* self);
+
+/**
+ * Creates a view over the `rows * cols` submatrix of `self` whose top-left
+ * element is `(row, col)`.
+ **/
+matrix_view_t matrix_submatrix(matrix_t const* self, size_t row, size_t col, size_t rows,
+                               size_t cols);
+
+/**
+ * Creates a view over the `i`-th row of a matrix, as a row vector.
+ **/
+vector_view_t matrix_row(matrix_t const* self, size_t i);
+
+/**
+ * Creates a view over the `j`-th column of a matrix, as a column vector.
+ **/
+vector_view_t matrix_col(matrix_t const* self, size_t j);
+
+/**
+ * Returns a view over the transpose of `view`, without moving any element.
+ **/
+matrix_view_t matrix_view_transpose(matrix_view_t view);
+
+/**
+ * Returns a pointer to the first element of a view.
+ **/
+static inline double* view_ptr(matrix_view_t view)
+{
+    return view.data + view.offset;
+}
+
+/**
+ * Returns the number of elements of a vector view.
+ **/
+static inline size_t vector_view_len(vector_view_t view)
+{
+    return view.rows * view.cols;
+}
+
+/**
+ * Returns the distance between two consecutive elements of a vector view.
+ **/
+static inline size_t vector_view_inc(vector_view_t view)
+{
+    return view.cols == 1 ? view.ld : view.stride;
+}
@@ -0,0 +1,87 @@
+#include "arena.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Rounds `size` up to the next multiple of `ALIGNMENT`.
+ **/
+static inline size_t align_up(size_t size)
+{
+    return (size + ALIGNMENT - 1) & ~(size_t)(ALIGNMENT - 1);
+}
+
+arena_t* arena_init(size_t capacity)
+{
+    arena_t* self = malloc(sizeof(arena_t));
+    if (!self)
+        return NULL;
+
+    self->capacity = align_up(capacity);
+    self->offset = 0;
+    self->data = aligned_alloc(ALIGNMENT, self->capacity != 0 ? self->capacity : ALIGNMENT);
+    if (!self->data) {
+        free(self);
+        return NULL;
+    }
+
+    return self;
+}
+
+void arena_deinit(arena_t* self)
+{
+    if (self) {
+        free(self->data);
+        free(self);
+    }
+}
+
+void* arena_alloc(arena_t* self, size_t size)
+{
+    size = align_up(size);
+    if (!self || size > self->capacity - self->offset)
+        return NULL;
+
+    void* ptr = self->data + self->offset;
+    self->offset += size;
+    return ptr;
+}
+
+size_t arena_mark(arena_t const* self)
+{
+    return self->offset;
+}
+
+void arena_reset(arena_t* self, size_t mark)
+{
+    if (mark <= self->offset) {
+        self->offset = mark;
+    }
+}
+
+size_t arena_matrix_size(size_t rows, size_t cols)
+{
+    return align_up(sizeof(matrix_t)) + align_up(rows * cols * sizeof(double));
+}
+
+matrix_t* arena_matrix(arena_t* self, size_t rows, size_t cols, layout_t layout)
+{
+    size_t const mark = arena_mark(self);
+    matrix_t* mat = arena_alloc(self, sizeof(matrix_t));
+    if (!mat)
+        return NULL;
+
+    mat->rows = rows;
+    mat->cols = cols;
+    mat->layout = layout;
+    mat->mapping = NULL;
+    mat->mapping_len = 0;
+    mat->data = arena_alloc(self, rows * cols * sizeof(double));
+    if (!mat->data) {
+        arena_reset(self, mark);
+        return NULL;
+    }
+
+    memset(mat->data, 0, rows * cols * sizeof(double));
+    return mat;
+}
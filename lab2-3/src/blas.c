@@ -1,126 +1,112 @@
 #include "blas.h"
+#include "arena.h"
 
 #include "matrix.h"
 
 #include <assert.h>
+#include <complex.h>
 #include <math.h>
 #include <omp.h>
 #include <stdlib.h>
 
-void daxpy(size_t len, double alpha, double const* x, double* y)
-{
-    for (size_t i = 0; i < len; ++i) {
-        y[i] += alpha * x[i];
-    }
-}
+#define BLAS_PREFIX s
+#define BLAS_T float
+#define BLAS_R float
+#include "blas_template.inc"
 
-double ddot(size_t len, double const* restrict x, double const* restrict y)
-{
-    double res = 0.0;
+#define BLAS_PREFIX d
+#define BLAS_T double
+#define BLAS_R double
+#include "blas_template.inc"
 
-    for (size_t i = 0; i < len; ++i) {
-        res += x[i] * y[i];
-    }
+#define BLAS_PREFIX c
+#define BLAS_T float complex
+#define BLAS_R float
+#include "blas_template.inc"
 
-    return res;
-}
+#define BLAS_PREFIX z
+#define BLAS_T double complex
+#define BLAS_R double
+#include "blas_template.inc"
 
-double dnrm2(size_t len, double const* restrict x)
+void daxpy_view(double alpha, vector_view_t x, vector_view_t y)
 {
-    double res = 0.0;
-
-    for (size_t i = 0; i < len; ++i) {
-        res += x[i] * x[i];
-    }
-
-    return sqrt(res);
+    assert(vector_view_len(x) == vector_view_len(y));
+    daxpy_strided(vector_view_len(x), alpha, view_ptr(x), vector_view_inc(x), view_ptr(y),
+                  vector_view_inc(y));
 }
 
-double dnrmf(size_t rows, size_t cols, double const* restrict A)
+double ddot_view(vector_view_t x, vector_view_t y)
 {
-    double res = 0.0;
-
-    for (size_t i = 0; i < rows; ++i) {
-        for (size_t j = 0; j < cols; ++j) {
-            res += fabs(A[i * cols + j] * A[i * cols + j]);
-        }
-    }
+    assert(vector_view_len(x) == vector_view_len(y));
+    return ddot_strided(vector_view_len(x), view_ptr(x), vector_view_inc(x), view_ptr(y),
+                        vector_view_inc(y));
+}
 
-    return sqrt(res);
+double dnrm2_view(vector_view_t x)
+{
+    return dnrm2_strided(vector_view_len(x), view_ptr(x), vector_view_inc(x));
 }
 
-void dgemv(size_t m, size_t n, double alpha, double const* restrict A, double const* restrict x,
-           double beta, double* restrict y)
+void dgemv_view(double alpha, matrix_view_t A, vector_view_t x, double beta, vector_view_t y)
 {
-    if (!A || !x || !y)
-        return;
-    assert((m != 0 && n != 0) && "`m` and `n` must be different than 0.");
+    assert(A.cols == vector_view_len(x) && A.rows == vector_view_len(y));
+    dgemv_strided(A.rows, A.cols, alpha, view_ptr(A), A.ld, A.stride, view_ptr(x),
+                  vector_view_inc(x), beta, view_ptr(y), vector_view_inc(y));
+}
 
-    for (size_t i = 0; i < m; ++i) {
-        double tmp = 0.0;
-        for (size_t j = 0; j < n; ++j) {
-            tmp += A[i * n + j] * x[j];
-        }
-        y[i] = alpha * tmp + beta * y[i];
-    }
+size_t gram_schmidt_workspace(size_t n)
+{
+    return arena_matrix_size(n, 1);
 }
 
 void classical_gram_schmidt(size_t n, double* restrict x, double* restrict A, size_t deg_m,
-                            matrix_t* mat_Q, matrix_t* mat_H)
+                            matrix_t* mat_Q, matrix_t* mat_H, arena_t* ws)
 {
     double epsilon = 1e-12;
     double(*restrict H)[deg_m] = (double(*)[mat_H->cols])mat_H->data;
-    double(*restrict Q)[deg_m] = (double(*)[mat_Q->cols])mat_Q->data;
-    double* q_k = aligned_alloc(64, mat_Q->rows * sizeof(double));
-    if (!q_k)
-        return;
-    double* v = aligned_alloc(64, n * sizeof(double));
-    if (!v)
-        return;
-    double* q_j_T = aligned_alloc(64, mat_Q->rows * sizeof(double));
-    if (!q_j_T)
+    arena_t* tmp_ws = ws ? NULL : arena_init(gram_schmidt_workspace(n));
+    arena_t* arena = ws ? ws : tmp_ws;
+    if (!arena)
         return;
-
-// Normalize first vector
+    size_t const mark = arena_mark(arena);
+    vector_t* mat_v = arena_matrix(arena, n, 1, ROW_MAJOR);
+    if (!mat_v)
+        goto cleanup;
+    vector_view_t v = matrix_col(mat_v, 0);
+
+    // Normalize first vector
+    double const x_nrm = dnrm2(n, x);
+    vector_view_t q_0 = matrix_col(mat_Q, 0);
+    double* restrict q = view_ptr(q_0);
+    size_t const inc_q = vector_view_inc(q_0);
 #pragma omp simd
     for (size_t _ = 0; _ < n; ++_) {
-        Q[_][0] = x[_] / dnrm2(n, x);
+        q[_ * inc_q] = x[_] / x_nrm;
     }
 
     for (size_t k = 1; k < deg_m; ++k) {
-// Initialize Q[:,k-1] slice
-#pragma omp simd
-        for (size_t _ = 0; _ < mat_Q->rows; ++_) {
-            q_k[_] = Q[_][k - 1];
-        }
-        // v_k+1 = A * v_k, where v_k = q_k and v = v_k+1
-        dgemv(n, n, 1.0, A, q_k, 0.0, v);
+        // v_k+1 = A * v_k, where v_k = Q[:,k-1] and v = v_k+1
+        vector_view_t q_k = matrix_col(mat_Q, k - 1);
+        dgemv_strided(n, n, 1.0, A, n, 1, view_ptr(q_k), vector_view_inc(q_k), 0.0, view_ptr(v),
+                      1);
 
         for (size_t j = 0; j < k; ++j) {
-// Initialize Q[:,j] slice
-#pragma omp simd
-            for (size_t _ = 0; _ < mat_Q->rows; ++_) {
-                q_j_T[_] = Q[_][j];
-            }
-            // h_j_k-1 = v_k+1 * v_k
-            H[j][k - 1] = ddot(mat_Q->rows, q_j_T, v);
+            // h_j_k-1 = Q[:,j] * v_k+1
+            H[j][k - 1] = ddot_view(matrix_col(mat_Q, j), v);
         }
 
         for (size_t j = 0; j < k; ++j) {
-// Initialize Q[:,j] slice
-#pragma omp simd
-            for (size_t _ = 0; _ < mat_Q->rows; ++_) {
-                q_j_T[_] = Q[_][j];
-            }
-            // v_k+1 -= h_j_k-1 * v_k
-            daxpy(n, -H[j][k - 1], q_j_T, v);
+            // v_k+1 -= h_j_k-1 * Q[:,j]
+            daxpy_view(-H[j][k - 1], matrix_col(mat_Q, j), v);
         }
 
-        H[k][k - 1] = dnrm2(n, v);
+        H[k][k - 1] = dnrm2_view(v);
         if (H[k][k - 1] > epsilon) {
+            q = view_ptr(matrix_col(mat_Q, k));
 #pragma omp simd
             for (size_t _ = 0; _ < n; ++_) {
-                Q[_][k] = v[_] / H[k][k - 1];
+                q[_ * inc_q] = mat_v->data[_] / H[k][k - 1];
             }
         }
         else {
@@ -129,57 +115,53 @@ void classical_gram_schmidt(size_t n, double* restrict x, double* restrict A, si
     }
 
 cleanup:
-    free(q_k);
-    free(v);
-    free(q_j_T);
+    arena_reset(arena, mark);
+    arena_deinit(tmp_ws);
 }
 
 void modified_gram_schmidt(size_t n, double* restrict x, double* restrict A, size_t deg_m,
-                           matrix_t* mat_Q, matrix_t* mat_H)
+                           matrix_t* mat_Q, matrix_t* mat_H, arena_t* ws)
 {
     double epsilon = 1e-12;
     double(*restrict H)[deg_m] = (double(*)[mat_H->cols])mat_H->data;
-    double(*restrict Q)[deg_m] = (double(*)[mat_Q->cols])mat_Q->data;
-    double* q_k = aligned_alloc(64, mat_Q->rows * sizeof(double));
-    if (!q_k)
-        return;
-    double* v = aligned_alloc(64, n * sizeof(double));
-    if (!v)
-        return;
-    double* q_j_T = aligned_alloc(64, mat_Q->rows * sizeof(double));
-    if (!q_j_T)
+    arena_t* tmp_ws = ws ? NULL : arena_init(gram_schmidt_workspace(n));
+    arena_t* arena = ws ? ws : tmp_ws;
+    if (!arena)
         return;
-
+    size_t const mark = arena_mark(arena);
+    vector_t* mat_v = arena_matrix(arena, n, 1, ROW_MAJOR);
+    if (!mat_v)
+        goto cleanup;
+    vector_view_t v = matrix_col(mat_v, 0);
+
+    // Normalize first vector
+    double const x_nrm = dnrm2(n, x);
+    vector_view_t q_0 = matrix_col(mat_Q, 0);
+    double* restrict q = view_ptr(q_0);
+    size_t const inc_q = vector_view_inc(q_0);
 #pragma omp simd
     for (size_t _ = 0; _ < n; ++_) {
-        Q[_][0] = x[_] / dnrm2(n, x);
+        q[_ * inc_q] = x[_] / x_nrm;
     }
 
     for (size_t k = 1; k < deg_m; ++k) {
-// Initialize Q[:,k-1] slice
-#pragma omp simd
-        for (size_t _ = 0; _ < mat_Q->rows; ++_) {
-            q_k[_] = Q[_][k - 1];
-        }
-        // Candidate vector
-        dgemv(n, n, 1.0, A, q_k, 0.0, v);
+        // Candidate vector, read straight from the Q[:,k-1] slice
+        vector_view_t q_k = matrix_col(mat_Q, k - 1);
+        dgemv_strided(n, n, 1.0, A, n, 1, view_ptr(q_k), vector_view_inc(q_k), 0.0, view_ptr(v),
+                      1);
 
         for (size_t j = 0; j < k; ++j) {
-// Initialize Q[:,j] slice (transposed but it's a vector so who fucking cares)
-#pragma omp simd
-            for (size_t _ = 0; _ < mat_Q->rows; ++_) {
-                q_j_T[_] = Q[_][j];
-            }
-
-            H[j][k - 1] = ddot(mat_Q->rows, q_j_T, v);
-            daxpy(n, -H[j][k - 1], q_j_T, v);
+            vector_view_t q_j = matrix_col(mat_Q, j);
+            H[j][k - 1] = ddot_view(q_j, v);
+            daxpy_view(-H[j][k - 1], q_j, v);
         }
 
-        H[k][k - 1] = dnrm2(n, v);
+        H[k][k - 1] = dnrm2_view(v);
         if (H[k][k - 1] > epsilon) {
+            q = view_ptr(matrix_col(mat_Q, k));
 #pragma omp simd
             for (size_t _ = 0; _ < n; ++_) {
-                Q[_][k] = v[_] / H[k][k - 1];
+                q[_ * inc_q] = mat_v->data[_] / H[k][k - 1];
             }
         }
         else {
@@ -188,7 +170,6 @@ void modified_gram_schmidt(size_t n, double* restrict x, double* restrict A, siz
     }
 
 cleanup:
-    free(q_k);
-    free(v);
-    free(q_j_T);
+    arena_reset(arena, mark);
+    arena_deinit(tmp_ws);
 }
@@ -1,5 +1,6 @@
 #include "drivers.h"
 
+#include "arena.h"
 #include "blas.h"
 #include "utils.h"
 
@@ -14,15 +15,25 @@ stats_t* driver_cgs(size_t n, matrix_t* A, vector_t* x, size_t deg_m, size_t rep
     if (!stats)
         return NULL;
 
-    matrix_t* Q = matrix_zeroes(A->rows, deg_m + 1);
+    // Column-major so that each basis vector is contiguous
+    matrix_t* Q = matrix_zeroes_layout(A->rows, deg_m + 1, COL_MAJOR);
     matrix_t* H = matrix_zeroes(deg_m + 1, deg_m);
+    // Workspace shared by all the repetitions, so that none of them allocates
+    arena_t* ws = arena_init(gram_schmidt_workspace(n));
+    if (!Q || !H || !ws) {
+        matrix_deinit(Q);
+        matrix_deinit(H);
+        arena_deinit(ws);
+        stats_deinit(stats);
+        return NULL;
+    }
 
     double elapsed;
     for (size_t i = 0; i < MAX_SAMPLES; ++i) {
         do {
             instant_t start = instant_now();
             for (size_t _ = 0; _ < reps; ++_) {
-                classical_gram_schmidt(n, x->data, A->data, deg_m, Q, H);
+                classical_gram_schmidt(n, x->data, A->data, deg_m, Q, H, ws);
             }
             instant_t stop = instant_now();
             elapsed = compute_avg_latency(start, stop, reps);
@@ -34,6 +45,9 @@ stats_t* driver_cgs(size_t n, matrix_t* A, vector_t* x, size_t deg_m, size_t rep
         stats->samples[i] = elapsed;
     }
 
+    matrix_deinit(Q);
+    matrix_deinit(H);
+    arena_deinit(ws);
     stats_compute(stats);
     return stats;
 }
@@ -44,15 +58,25 @@ stats_t* driver_mgs(size_t n, matrix_t* A, vector_t* x, size_t deg_m, size_t rep
     if (!stats)
         return NULL;
 
-    matrix_t* Q = matrix_zeroes(A->rows, deg_m + 1);
+    // Column-major so that each basis vector is contiguous
+    matrix_t* Q = matrix_zeroes_layout(A->rows, deg_m + 1, COL_MAJOR);
     matrix_t* H = matrix_zeroes(deg_m + 1, deg_m);
+    // Workspace shared by all the repetitions, so that none of them allocates
+    arena_t* ws = arena_init(gram_schmidt_workspace(n));
+    if (!Q || !H || !ws) {
+        matrix_deinit(Q);
+        matrix_deinit(H);
+        arena_deinit(ws);
+        stats_deinit(stats);
+        return NULL;
+    }
 
     double elapsed;
     for (size_t i = 0; i < MAX_SAMPLES; ++i) {
         do {
             instant_t start = instant_now();
             for (size_t _ = 0; _ < reps; ++_) {
-                modified_gram_schmidt(n, x->data, A->data, deg_m, Q, H);
+                modified_gram_schmidt(n, x->data, A->data, deg_m, Q, H, ws);
             }
             instant_t stop = instant_now();
             elapsed = compute_avg_latency(start, stop, reps);
@@ -64,6 +88,9 @@ stats_t* driver_mgs(size_t n, matrix_t* A, vector_t* x, size_t deg_m, size_t rep
         stats->samples[i] = elapsed;
     }
 
+    matrix_deinit(Q);
+    matrix_deinit(H);
+    arena_deinit(ws);
     stats_compute(stats);
     return stats;
 }
@@ -3,12 +3,50 @@
 #include "utils.h"
 
 #include <assert.h>
+#include <fcntl.h>
 #include <math.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <time.h>
+#include <unistd.h>
+#if defined(__AVX__)
+    #include <immintrin.h>
+#endif
+
+// Edge of the square tiles processed by the blocked transposes
+#define TRANSPOSE_TILE 32
+
+/**
+ * Size of the matrix header, padded so that the elements stored right after
+ * it are aligned.
+ **/
+#define MATRIX_HEADER_SIZE ((sizeof(matrix_t) + ALIGNMENT - 1) & ~(size_t)(ALIGNMENT - 1))
+
+/**
+ * Allocates an uninitialized matrix, with its header and its elements in a
+ * single aligned block.
+ **/
+static matrix_t* matrix_alloc(size_t rows, size_t cols, layout_t layout)
+{
+    size_t const data_size =
+        (rows * cols * sizeof(double) + ALIGNMENT - 1) & ~(size_t)(ALIGNMENT - 1);
+    matrix_t* self = aligned_alloc(ALIGNMENT, MATRIX_HEADER_SIZE + data_size);
+    if (!self)
+        return NULL;
+
+    self->rows = rows;
+    self->cols = cols;
+    self->layout = layout;
+    self->data = (double*)((unsigned char*)self + MATRIX_HEADER_SIZE);
+    self->mapping = NULL;
+    self->mapping_len = 0;
+    return self;
+}
 
 matrix_t* matrix_read(char const* filename)
 {
@@ -27,6 +65,15 @@ matrix_t* matrix_read(char const* filename)
         exit(EXIT_FAILURE);
     }
 
+    // Binary matrix files are mapped rather than parsed
+    char magic[sizeof(MATRIX_FILE_MAGIC) - 1];
+    if (fread(magic, 1, sizeof(magic), fp) == sizeof(magic) &&
+        memcmp(magic, MATRIX_FILE_MAGIC, sizeof(magic)) == 0) {
+        fclose(fp);
+        return matrix_map(filename);
+    }
+    rewind(fp);
+
     // Read matrix dimensions from file
     fscanf(fp, "%zu %zu", &rows, &cols);
     if (!rows || !cols) {
@@ -35,8 +82,10 @@ matrix_t* matrix_read(char const* filename)
     }
 
     matrix_t* self = matrix_zeroes(rows, cols);
-    if (!self)
+    if (!self) {
+        fclose(fp);
         return NULL;
+    }
 
     for (size_t i = 0; i < self->rows * self->cols; ++i) {
         // Read values from file
@@ -47,6 +96,91 @@ matrix_t* matrix_read(char const* filename)
     return self;
 }
 
+int matrix_write(matrix_t const* self, char const* filename)
+{
+    long const page_size = sysconf(_SC_PAGESIZE);
+    matrix_file_header_t header = {
+        .dtype = DTYPE_F64,
+        .layout = self->layout,
+        .alignment = page_size > 0 ? (uint64_t)(page_size) : 4096,
+        .rows = self->rows,
+        .cols = self->cols,
+    };
+    memcpy(header.magic, MATRIX_FILE_MAGIC, sizeof(header.magic));
+    header.data_offset =
+        (sizeof(header) + header.alignment - 1) / header.alignment * header.alignment;
+
+    FILE* fp = fopen(filename, "wb");
+    if (!fp) {
+        fprintf(stderr, "error: failed to open file `%s`\n", filename);
+        return -1;
+    }
+
+    // Header, zero padding up to the elements, then the elements themselves
+    int ret = 0;
+    if (fwrite(&header, sizeof(header), 1, fp) != 1 ||
+        fseek(fp, (long)(header.data_offset), SEEK_SET) != 0 ||
+        fwrite(self->data, sizeof(double), matrix_nb_elems(self), fp) != matrix_nb_elems(self)) {
+        fprintf(stderr, "error: failed to write to file `%s`\n", filename);
+        ret = -1;
+    }
+
+    if (fclose(fp) != 0) {
+        ret = -1;
+    }
+    return ret;
+}
+
+matrix_t* matrix_map(char const* filename)
+{
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "error: failed to open file `%s`\n", filename);
+        return NULL;
+    }
+
+    struct stat st;
+    matrix_file_header_t header;
+    if (fstat(fd, &st) != 0 || pread(fd, &header, sizeof(header), 0) != sizeof(header) ||
+        memcmp(header.magic, MATRIX_FILE_MAGIC, sizeof(header.magic)) != 0) {
+        fprintf(stderr, "error: `%s` is not a binary matrix file\n", filename);
+        close(fd);
+        return NULL;
+    }
+
+    size_t const nb_bytes = header.rows * header.cols * sizeof(double);
+    if (header.dtype != DTYPE_F64 || header.layout > COL_MAJOR ||
+        header.data_offset % ALIGNMENT != 0 || header.data_offset + nb_bytes > (size_t)st.st_size) {
+        fprintf(stderr, "error: unsupported or truncated binary matrix file `%s`\n", filename);
+        close(fd);
+        return NULL;
+    }
+
+    // Private mapping: pages are shared with the page cache until written to
+    size_t const len = header.data_offset + nb_bytes;
+    void* mapping = mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    // The mapping outlives the file descriptor
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        fprintf(stderr, "error: failed to map file `%s`\n", filename);
+        return NULL;
+    }
+
+    matrix_t* self = malloc(sizeof(matrix_t));
+    if (!self) {
+        munmap(mapping, len);
+        return NULL;
+    }
+
+    self->data = (double*)((unsigned char*)mapping + header.data_offset);
+    self->rows = header.rows;
+    self->cols = header.cols;
+    self->layout = (layout_t)(header.layout);
+    self->mapping = mapping;
+    self->mapping_len = len;
+    return self;
+}
+
 vector_t* vector_zeroes(size_t len)
 {
     return matrix_zeroes(len, 1);
@@ -54,17 +188,14 @@ vector_t* vector_zeroes(size_t len)
 
 matrix_t* matrix_zeroes(size_t rows, size_t cols)
 {
-    matrix_t* self = malloc(sizeof(matrix_t));
-    if (!self)
-        return NULL;
+    return matrix_zeroes_layout(rows, cols, ROW_MAJOR);
+}
 
-    self->rows = rows;
-    self->cols = cols;
-    self->data = aligned_alloc(ALIGNMENT, rows * cols * sizeof(double));
-    if (!self->data) {
-        free(self);
+matrix_t* matrix_zeroes_layout(size_t rows, size_t cols, layout_t layout)
+{
+    matrix_t* self = matrix_alloc(rows, cols, layout);
+    if (!self)
         return NULL;
-    }
 
     memset(self->data, 0, rows * cols * sizeof(double));
     return self ? self : NULL;
@@ -77,18 +208,10 @@ vector_t* vector_ones(size_t len)
 
 matrix_t* matrix_ones(size_t rows, size_t cols)
 {
-    matrix_t* self = malloc(sizeof(matrix_t));
+    matrix_t* self = matrix_alloc(rows, cols, ROW_MAJOR);
     if (!self)
         return NULL;
 
-    self->rows = rows;
-    self->cols = cols;
-    self->data = aligned_alloc(ALIGNMENT, rows * cols * sizeof(double));
-    if (!self->data) {
-        free(self);
-        return NULL;
-    }
-
     for (size_t i = 0; i < rows * cols; ++i) {
         self->data[i] = 1.0;
     }
@@ -96,6 +219,16 @@ matrix_t* matrix_ones(size_t rows, size_t cols)
     return self;
 }
 
+// Seed of `matrix_rand_init` and number of matrices initialized since it was set
+static uint64_t rand_seed = 0;
+static uint64_t rand_stream = 0;
+
+void matrix_rand_seed(uint64_t seed)
+{
+    rand_seed = seed;
+    rand_stream = 0;
+}
+
 vector_t* vector_rand_init(size_t len)
 {
     vector_t* self = matrix_rand_init(len, 1);
@@ -104,20 +237,16 @@ vector_t* vector_rand_init(size_t len)
 
 matrix_t* matrix_rand_init(size_t rows, size_t cols)
 {
-    matrix_t* self = malloc(sizeof(matrix_t));
+    matrix_t* self = matrix_alloc(rows, cols, ROW_MAJOR);
     if (!self)
         return NULL;
 
-    self->rows = rows;
-    self->cols = cols;
-    self->data = aligned_alloc(ALIGNMENT, rows * cols * sizeof(double));
-    if (!self->data) {
-        free(self);
-        return NULL;
-    }
-
+    // Each matrix draws from its own stream, derived from the seed
+    uint64_t const key = splitmix64(rand_seed ^ splitmix64(rand_stream++));
+    double* restrict data = self->data;
+#pragma omp parallel for simd schedule(static)
     for (size_t i = 0; i < rows * cols; ++i) {
-        self->data[i] = rand_double_range(-1.0, 1.0);
+        data[i] = counter_double_range(key, i, -1.0, 1.0);
     }
 
     return self;
@@ -133,7 +262,12 @@ void vector_deinit(vector_t* self)
 void matrix_deinit(matrix_t* self)
 {
     if (self) {
-        if (self->data) {
+        if (self->mapping) {
+            munmap(self->mapping, self->mapping_len);
+        }
+        // Elements allocated along with the header are freed with it
+        else if (self->data &&
+                 self->data != (double*)((unsigned char*)self + MATRIX_HEADER_SIZE)) {
             free(self->data);
         }
         free(self);
@@ -150,19 +284,197 @@ void vector_transpose(vector_t* self)
     self->cols = tmp;
 }
 
+/**
+ * Transposes a 4x4 block of doubles in registers, reading rows of `src` and
+ * writing them as columns of `dst`.
+ **/
+static inline void transpose_4x4(double const* restrict src, size_t lds, double* restrict dst,
+                                 size_t ldd)
+{
+#if defined(__AVX__)
+    __m256d r0 = _mm256_loadu_pd(src + 0 * lds);
+    __m256d r1 = _mm256_loadu_pd(src + 1 * lds);
+    __m256d r2 = _mm256_loadu_pd(src + 2 * lds);
+    __m256d r3 = _mm256_loadu_pd(src + 3 * lds);
+
+    // Interleave pairs of rows, then exchange the 128-bit lanes
+    __m256d t0 = _mm256_unpacklo_pd(r0, r1);
+    __m256d t1 = _mm256_unpackhi_pd(r0, r1);
+    __m256d t2 = _mm256_unpacklo_pd(r2, r3);
+    __m256d t3 = _mm256_unpackhi_pd(r2, r3);
+
+    _mm256_storeu_pd(dst + 0 * ldd, _mm256_permute2f128_pd(t0, t2, 0x20));
+    _mm256_storeu_pd(dst + 1 * ldd, _mm256_permute2f128_pd(t1, t3, 0x20));
+    _mm256_storeu_pd(dst + 2 * ldd, _mm256_permute2f128_pd(t0, t2, 0x31));
+    _mm256_storeu_pd(dst + 3 * ldd, _mm256_permute2f128_pd(t1, t3, 0x31));
+#else
+    for (size_t i = 0; i < 4; ++i) {
+        for (size_t j = 0; j < 4; ++j) {
+            dst[j * ldd + i] = src[i * lds + j];
+        }
+    }
+#endif
+}
+
+/**
+ * Transposes two 4x4 blocks `a` and `b` of the same matrix into each other's
+ * place. Both blocks are loaded before anything is stored, so `a` and `b` may
+ * be the same diagonal block.
+ **/
+static inline void transpose_swap_4x4(double* a, double* b, size_t ld)
+{
+    double tmp_a[16];
+    double tmp_b[16];
+
+    transpose_4x4(a, ld, tmp_a, 4);
+    transpose_4x4(b, ld, tmp_b, 4);
+    for (size_t i = 0; i < 4; ++i) {
+        memcpy(b + i * ld, tmp_a + i * 4, 4 * sizeof(double));
+        memcpy(a + i * ld, tmp_b + i * 4, 4 * sizeof(double));
+    }
+}
+
+/**
+ * Out-of-place transpose of the row-major `rows * cols` array `src` into
+ * `dst`, by `TRANSPOSE_TILE`-wide tiles so that both the rows read and the
+ * columns written stay in cache. Tiles are distributed across threads.
+ **/
+static void transpose_blocked(size_t rows, size_t cols, double const* restrict src, size_t lds,
+                              double* restrict dst, size_t ldd)
+{
+#pragma omp parallel for collapse(2) schedule(static)
+    for (size_t ii = 0; ii < rows; ii += TRANSPOSE_TILE) {
+        for (size_t jj = 0; jj < cols; jj += TRANSPOSE_TILE) {
+            size_t const i_end = ii + TRANSPOSE_TILE < rows ? ii + TRANSPOSE_TILE : rows;
+            size_t const j_end = jj + TRANSPOSE_TILE < cols ? jj + TRANSPOSE_TILE : cols;
+
+            size_t i = ii;
+            for (; i + 4 <= i_end; i += 4) {
+                size_t j = jj;
+                for (; j + 4 <= j_end; j += 4) {
+                    transpose_4x4(src + i * lds + j, lds, dst + j * ldd + i, ldd);
+                }
+                // Remainder columns of the tile
+                for (; j < j_end; ++j) {
+                    for (size_t k = i; k < i + 4; ++k) {
+                        dst[j * ldd + k] = src[k * lds + j];
+                    }
+                }
+            }
+            // Remainder rows of the tile
+            for (; i < i_end; ++i) {
+                for (size_t j = jj; j < j_end; ++j) {
+                    dst[j * ldd + i] = src[i * lds + j];
+                }
+            }
+        }
+    }
+}
+
+/**
+ * In-place transpose of the square row-major `n * n` array `data`. Pairs of
+ * 4x4 blocks on either side of the diagonal are swapped, one tile row per
+ * iteration of the parallel loop.
+ **/
+static void transpose_square_inplace(size_t n, double* data)
+{
+    size_t const n4 = n - n % 4;
+
+#pragma omp parallel for schedule(dynamic)
+    for (size_t ii = 0; ii < n4; ii += TRANSPOSE_TILE) {
+        size_t const i_end = ii + TRANSPOSE_TILE < n4 ? ii + TRANSPOSE_TILE : n4;
+        for (size_t i = ii; i < i_end; i += 4) {
+            for (size_t j = i; j < n4; j += 4) {
+                transpose_swap_4x4(data + i * n + j, data + j * n + i, n);
+            }
+        }
+    }
+
+    // Remainder rows/columns that do not fit in 4x4 blocks
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = i >= n4 ? i + 1 : n4; j < n; ++j) {
+            double tmp = data[i * n + j];
+            data[i * n + j] = data[j * n + i];
+            data[j * n + i] = tmp;
+        }
+    }
+}
+
+/**
+ * In-place transpose of the rectangular row-major `rows * cols` array `data`
+ * by following the cycles of the permutation `p -> p * rows mod (N - 1)`,
+ * where `N = rows * cols`. Visited positions are tracked in a bitset (one
+ * bit per element). If it cannot be allocated, each cycle is only followed
+ * from its smallest position instead, which is slower but needs no memory.
+ **/
+static void transpose_cycles_inplace(size_t rows, size_t cols, double* data)
+{
+    size_t const last = rows * cols - 1;
+    uint64_t* visited = calloc(last / 64 + 1, sizeof(uint64_t));
+
+    for (size_t start = 1; start < last; ++start) {
+        if (visited) {
+            if (visited[start / 64] & (UINT64_C(1) << (start % 64)))
+                continue;
+        }
+        else {
+            // Only follow the cycle from its leader, i.e. its smallest position
+            size_t p = (start * rows) % last;
+            while (p > start) {
+                p = (p * rows) % last;
+            }
+            if (p < start)
+                continue;
+        }
+
+        // Element at position `p = i * cols + j` moves to `j * rows + i`
+        double moving = data[start];
+        size_t p = start;
+        do {
+            size_t const next = (p * rows) % last;
+            double const tmp = data[next];
+            data[next] = moving;
+            moving = tmp;
+            if (visited) {
+                visited[next / 64] |= UINT64_C(1) << (next % 64);
+            }
+            p = next;
+        } while (p != start);
+    }
+
+    free(visited);
+}
+
 void matrix_transpose(matrix_t const* self, matrix_t* transposed)
 {
     assert(self->rows == transposed->cols && self->cols == transposed->rows);
 
-    double(*const restrict self_data)[self->cols] = (double(*)[self->cols])self->data;
-    double(*restrict transposed_data)[transposed->cols] =
-        (double(*)[transposed->cols])transposed->data;
+    // A row-major matrix and its column-major transpose share the same storage
+    if (self->layout != transposed->layout) {
+        memcpy(transposed->data, self->data, matrix_nb_elems(self) * sizeof(double));
+        return;
+    }
 
-    for (size_t i = 0; i < self->rows; ++i) {
-        for (size_t j = 0; j < self->cols; ++j) {
-            transposed_data[j][i] = self_data[i][j];
-        }
+    // Dimensions of the storage seen as a row-major array
+    size_t const rows = self->layout == ROW_MAJOR ? self->rows : self->cols;
+    size_t const cols = self->layout == ROW_MAJOR ? self->cols : self->rows;
+    transpose_blocked(rows, cols, self->data, cols, transposed->data, rows);
+}
+
+void matrix_transpose_inplace(matrix_t* self)
+{
+    size_t const rows = self->layout == ROW_MAJOR ? self->rows : self->cols;
+    size_t const cols = self->layout == ROW_MAJOR ? self->cols : self->rows;
+    if (rows == cols) {
+        transpose_square_inplace(rows, self->data);
+    }
+    else if (rows > 1 && cols > 1) {
+        transpose_cycles_inplace(rows, cols, self->data);
     }
+
+    size_t tmp = self->rows;
+    self->rows = self->cols;
+    self->cols = tmp;
 }
 
 void print_vector(vector_t const* self, char const* name)
@@ -200,11 +512,11 @@ void print_matrix(matrix_t const* self, char const* name)
         }
 
         for (size_t j = 0; j < self->cols; ++j) {
-            if (self->data[i * self->cols + j] >= 0) {
-                printf("%2.3lf ", self->data[i * self->cols + j]);
+            if (self->data[matrix_index(self, i, j)] >= 0) {
+                printf("%2.3lf ", self->data[matrix_index(self, i, j)]);
             }
             else {
-                printf("%2.3lf ", self->data[i * self->cols + j]);
+                printf("%2.3lf ", self->data[matrix_index(self, i, j)]);
             }
 
             if (self->rows != 1) {
@@ -238,7 +550,7 @@ size_t vector_nb_elems(vector_t const* self)
 
 matrix_t* matrix_copy(matrix_t const* self)
 {
-    matrix_t* copy = matrix_zeroes(self->rows, self->cols);
+    matrix_t* copy = matrix_zeroes_layout(self->rows, self->cols, self->layout);
     if (!copy)
         return NULL;
 
@@ -248,3 +560,47 @@ matrix_t* matrix_copy(matrix_t const* self)
 
     return copy;
 }
+
+matrix_view_t matrix_view(matrix_t const* self)
+{
+    return matrix_submatrix(self, 0, 0, self->rows, self->cols);
+}
+
+matrix_view_t matrix_submatrix(matrix_t const* self, size_t row, size_t col, size_t rows,
+                               size_t cols)
+{
+    assert(row + rows <= self->rows && col + cols <= self->cols);
+
+    bool const is_row_major = self->layout == ROW_MAJOR;
+    return (matrix_view_t){
+        .data = self->data,
+        .offset = matrix_index(self, row, col),
+        .rows = rows,
+        .cols = cols,
+        .ld = is_row_major ? self->cols : 1,
+        .stride = is_row_major ? 1 : self->rows,
+    };
+}
+
+vector_view_t matrix_row(matrix_t const* self, size_t i)
+{
+    return matrix_submatrix(self, i, 0, 1, self->cols);
+}
+
+vector_view_t matrix_col(matrix_t const* self, size_t j)
+{
+    return matrix_submatrix(self, 0, j, self->rows, 1);
+}
+
+matrix_view_t matrix_view_transpose(matrix_view_t view)
+{
+    size_t tmp = view.rows;
+    view.rows = view.cols;
+    view.cols = tmp;
+
+    tmp = view.ld;
+    view.ld = view.stride;
+    view.stride = tmp;
+
+    return view;
+}
@@ -1,80 +1,451 @@
 #pragma once
 
+#include "arena.h"
 #include "matrix.h"
+#include "operator.h"
+#include "sparse.h"
 
+#include <complex.h>
 #include <stddef.h>
 
+// Single precision real kernels (`saxpy`, `sdot`, ...)
+#define BLAS_PREFIX s
+#define BLAS_T float
+#define BLAS_R float
+#include "blas_template.h"
+
+// Double precision real kernels (`daxpy`, `ddot`, ...)
+#define BLAS_PREFIX d
+#define BLAS_T double
+#define BLAS_R double
+#include "blas_template.h"
+
+// Single precision complex kernels (`caxpy`, `cdot`, ...)
+#define BLAS_PREFIX c
+#define BLAS_T float complex
+#define BLAS_R float
+#include "blas_template.h"
+
+// Double precision complex kernels (`zaxpy`, `zdot`, ...)
+#define BLAS_PREFIX z
+#define BLAS_T double complex
+#define BLAS_R double
+#include "blas_template.h"
+
 /**
- * Computes a double precision scalar-vector product and adds the result to a
- * vector.
- *
- * The `daxpy` routine performs a vector-vector operation defined as:
- *   y = a * x + y
- *
- * Where:
- * - `a` is a scalar.
- * - `x` and `y` are vectors.
- * - `len` is the number of elements in the vectors.
+ * Type-generic front-ends, dispatching to the `s`, `d`, `c` or `z` kernel
+ * based on the element type of the last vector/matrix argument.
+ **/
+#define BLAS_GENERIC(name, ptr)                                                                    \
+    _Generic(*(ptr),                                                                               \
+        float: s##name,                                                                            \
+        double: d##name,                                                                           \
+        float complex: c##name,                                                                    \
+        double complex: z##name)
+
+#define axpy(len, alpha, x, y) BLAS_GENERIC(axpy, y)(len, alpha, x, y)
+#define dot(len, x, y) BLAS_GENERIC(dot, y)(len, x, y)
+#define nrm2(len, x) BLAS_GENERIC(nrm2, x)(len, x)
+#define nrmf(rows, cols, A) BLAS_GENERIC(nrmf, A)(rows, cols, A)
+#define gemv(m, n, alpha, A, x, beta, y) BLAS_GENERIC(gemv, y)(m, n, alpha, A, x, beta, y)
+#define gemm(l, m, n, alpha, A, B, beta, C) BLAS_GENERIC(gemm, C)(l, m, n, alpha, A, B, beta, C)
+
+/**
+ * Double precision kernels operating directly on matrix/vector views, see
+ * `matrix_view_t`. They forward to the `d?_strided` kernels.
+ **/
+void daxpy_view(double alpha, vector_view_t x, vector_view_t y);
+double ddot_view(vector_view_t x, vector_view_t y);
+double dnrm2_view(vector_view_t x);
+double dnrmf_view(matrix_view_t A);
+void dgemv_view(double alpha, matrix_view_t A, vector_view_t x, double beta, vector_view_t y);
+
+/**
+ * Returns the size in bytes of the workspace needed by
+ * `classical_gram_schmidt` and `modified_gram_schmidt` for vectors of `n`
+ * elements.
+ **/
+size_t gram_schmidt_workspace(size_t n);
+
+/**
+ * Builds an orthonormal basis `Q` of the Krylov subspace of `A` spanned by
+ * `x` and the Hessenberg matrix `H`, with classical (resp. modified)
+ * Gram-Schmidt. Scratch memory is taken from `ws`, which must hold at least
+ * `gram_schmidt_workspace(n)` bytes and is left as it was given. If `ws` is
+ * NULL, a temporary workspace is allocated for the call.
  **/
-void daxpy(size_t len, double alpha, double const* x, double* y);
+void classical_gram_schmidt(size_t n, double* restrict x, matrix_t const* mat_A, size_t deg_m,
+                            matrix_t* mat_Q, matrix_t* mat_H, arena_t* ws);
+
+void modified_gram_schmidt(size_t n, double* restrict x, matrix_t const* mat_A, size_t deg_m,
+                           matrix_t* mat_Q, matrix_t* mat_H, arena_t* ws);
+
+/**
+ * Returns the size in bytes of the workspace needed by
+ * `classical_gram_schmidt2` for vectors of `n` elements and `deg_m` basis
+ * vectors.
+ **/
+size_t gram_schmidt2_workspace(size_t n, size_t deg_m);
+
+/**
+ * Same as `classical_gram_schmidt`, with every vector orthogonalized twice
+ * (CGS2). Each pass is a pair of dgemv, `h = Q^T v` then `v -= Q h`, so a
+ * step costs two reductions over the basis instead of one per basis vector,
+ * and the basis stays orthogonal to working precision as with
+ * `modified_gram_schmidt`.
+ **/
+void classical_gram_schmidt2(size_t n, double* restrict x, matrix_t const* mat_A, size_t deg_m,
+                             matrix_t* mat_Q, matrix_t* mat_H, arena_t* ws);
+
+/**
+ * Returns the size in bytes of the workspace needed by
+ * `parallel_classical_gram_schmidt2`.
+ **/
+size_t parallel_gram_schmidt2_workspace(size_t n, size_t deg_m);
+
+/**
+ * Same as `classical_gram_schmidt2`, threaded with OpenMP. The whole Arnoldi
+ * loop runs in a single parallel region: every thread owns the same blocks
+ * of rows in the matvec, the projections and the updates, the projections
+ * and the norm are orphaned reductions, and a step synchronizes only three
+ * times, once per reduction.
+ **/
+void parallel_classical_gram_schmidt2(size_t n, double* restrict x, matrix_t const* mat_A,
+                                      size_t deg_m, matrix_t* mat_Q, matrix_t* mat_H,
+                                      arena_t* ws);
+
+/**
+ * Same as `classical_gram_schmidt`, `modified_gram_schmidt` and
+ * `classical_gram_schmidt2`, with the products by `A` computed by
+ * `sparse_spmv`, so that a step costs O(nnz) instead of O(n^2).
+ **/
+void classical_gram_schmidt_sparse(size_t n, double* restrict x, sparse_t const* A, size_t deg_m,
+                                   matrix_t* mat_Q, matrix_t* mat_H, arena_t* ws);
+
+void modified_gram_schmidt_sparse(size_t n, double* restrict x, sparse_t const* A, size_t deg_m,
+                                  matrix_t* mat_Q, matrix_t* mat_H, arena_t* ws);
+
+void classical_gram_schmidt2_sparse(size_t n, double* restrict x, sparse_t const* A, size_t deg_m,
+                                    matrix_t* mat_Q, matrix_t* mat_H, arena_t* ws);
+
+/**
+ * Same as `classical_gram_schmidt`, `modified_gram_schmidt` and
+ * `classical_gram_schmidt2`, for a matrix-free operator of order `A->n`.
+ **/
+void classical_gram_schmidt_op(double* restrict x, operator_t const* A, size_t deg_m,
+                               matrix_t* mat_Q, matrix_t* mat_H, arena_t* ws);
+
+void modified_gram_schmidt_op(double* restrict x, operator_t const* A, size_t deg_m,
+                              matrix_t* mat_Q, matrix_t* mat_H, arena_t* ws);
+
+void classical_gram_schmidt2_op(double* restrict x, operator_t const* A, size_t deg_m,
+                                matrix_t* mat_Q, matrix_t* mat_H, arena_t* ws);
+
+/**
+ * Returns the size in bytes of the workspace needed by `householder_arnoldi`
+ * for vectors of `n` elements and `deg_m` basis vectors.
+ **/
+size_t householder_arnoldi_workspace(size_t n, size_t deg_m);
+
+/**
+ * Same as `modified_gram_schmidt`, with the basis generated by Householder
+ * reflectors instead of projections, so that `Q` stays orthogonal to working
+ * precision however ill-conditioned the Krylov basis. The reflectors are
+ * accumulated in compact WY form, `I - V T V^T`, and applied with dgemv and
+ * dtrmv: a step costs four dgemv over the reflectors, against two for CGS2.
+ **/
+void householder_arnoldi(size_t n, double* restrict x, matrix_t const* mat_A, size_t deg_m,
+                         matrix_t* mat_Q, matrix_t* mat_H, arena_t* ws);
+
+void householder_arnoldi_sparse(size_t n, double* restrict x, sparse_t const* A, size_t deg_m,
+                                matrix_t* mat_Q, matrix_t* mat_H, arena_t* ws);
+
+void householder_arnoldi_op(double* restrict x, operator_t const* A, size_t deg_m,
+                            matrix_t* mat_Q, matrix_t* mat_H, arena_t* ws);
+
+/**
+ * Returns `||I - Q^T Q||_F` for the first `k` columns of `Q`, or NaN if it
+ * could not be computed.
+ **/
+double orthogonality_loss(matrix_t const* mat_Q, size_t k);
+
+/**
+ * Polynomial basis of the Krylov vectors generated by the s-step Arnoldi.
+ **/
+typedef enum s_step_basis_e {
+    S_STEP_MONOMIAL,
+    S_STEP_NEWTON,
+} s_step_basis_t;
+
+char const* s_step_basis_to_str(s_step_basis_t basis);
+
+/**
+ * Returns the size in bytes of the workspace needed by `s_step_gram_schmidt`
+ * for vectors of `n` elements, `deg_m` basis vectors and blocks of `s`.
+ **/
+size_t s_step_workspace(size_t n, size_t deg_m, size_t s);
+
+/**
+ * Same as `modified_gram_schmidt`, with the communication-avoiding s-step
+ * Arnoldi: past a first block of `s` ordinary steps, the basis grows by
+ * blocks of `s` vectors, generated by `s` consecutive products by `A` in
+ * the Newton (Leja-ordered Ritz values of the first block as shifts) or
+ * monomial basis, then orthogonalized with two passes of block CGS and a
+ * TSQR. This takes three reductions per block instead of one or more per
+ * vector, and most of the work is done by dgemm. `Q` must be column-major.
+ **/
+void s_step_gram_schmidt(size_t n, double* restrict x, matrix_t const* mat_A, size_t deg_m,
+                         size_t s, s_step_basis_t basis, matrix_t* mat_Q, matrix_t* mat_H,
+                         arena_t* ws);
+
+void s_step_gram_schmidt_op(double* restrict x, operator_t const* A, size_t deg_m, size_t s,
+                            s_step_basis_t basis, matrix_t* mat_Q, matrix_t* mat_H, arena_t* ws);
 
 /**
- * Computes a double precision vector-vector dot product.
+ * Returns the size in bytes of the workspace needed by `block_arnoldi` for
+ * vectors of `n` elements, `deg_m` basis vectors and blocks of `b`.
+ **/
+size_t block_arnoldi_workspace(size_t n, size_t deg_m, size_t b);
+
+/**
+ * Builds an orthonormal basis `Q` of the block Krylov subspace of `A`
+ * spanned by the `b` columns of `X`, and the block Hessenberg matrix `H`
+ * such that `A Q[:,0..deg_m-b-1] = Q H`, `deg_m` being a multiple of `b`.
+ * `A` is applied to a whole block at once, with dgemm (dense) or SpMM
+ * (sparse), so that it is read once per step instead of once per vector.
+ * The blocks are orthogonalized with two passes of block CGS and a TSQR.
+ * `X` and `Q` must be column-major. Returns the number of basis vectors
+ * built, less than `deg_m` if a block became rank-deficient.
+ **/
+size_t block_arnoldi(size_t n, size_t b, matrix_t const* mat_X, matrix_t const* mat_A,
+                     size_t deg_m, matrix_t* mat_Q, matrix_t* mat_H, arena_t* ws);
+
+size_t block_arnoldi_sparse(size_t n, size_t b, matrix_t const* mat_X, sparse_t const* A,
+                            size_t deg_m, matrix_t* mat_Q, matrix_t* mat_H, arena_t* ws);
+
+/**
+ * Same as `block_arnoldi` for a matrix-free operator of order `A->n`, which
+ * can only be applied one column at a time.
+ **/
+size_t block_arnoldi_op(size_t b, matrix_t const* mat_X, operator_t const* A, size_t deg_m,
+                        matrix_t* mat_Q, matrix_t* mat_H, arena_t* ws);
+
+/**
+ * Statistics of a run of `eram` or `iram`. Times are in nanoseconds and
+ * summed over all the restarts.
+ **/
+typedef struct arnoldi_info_s {
+    size_t nb_restarts;
+    size_t nb_matvecs;
+    size_t nb_converged;
+    double max_residual;
+    double t_arnoldi;
+    double t_ritz;
+    double t_restart;
+} arnoldi_info_t;
+
+/**
+ * Returns the size in bytes of the workspace needed by `eram` for an
+ * operator of order `n`, `s` wanted eigenpairs and a subspace of size `m`.
+ **/
+size_t eram_workspace(size_t n, size_t s, size_t m);
+
+/**
+ * Computes the `s` eigenvalues of largest modulus of `A` with the explicitly
+ * restarted Arnoldi method. Each cycle builds an `m`-step Arnoldi basis from
+ * `x` with `modified_gram_schmidt` and extracts the Ritz pairs from `H`. The
+ * pairs whose relative residual `||A u - theta u|| / |theta|` falls below
+ * `tol`, `|theta|` being bounded below by `eps ||H||_F`, are locked by
+ * decreasing modulus: the real and imaginary parts of their Ritz vector join an
+ * orthonormal basis `V` and the next cycles work on `(I - V V^T) A`. The method
+ * stops once `s` pairs are locked. Otherwise `x` is replaced by a combination
+ * of the other wanted Ritz vectors and a few more, weighted by the inverse of
+ * their residuals, and the method restarts, up to `max_restarts` times.
+ * Requires `m > s`: restarting from all the Ritz vectors would only rebuild the
+ * same subspace.
  *
- * The `ddot` routine performs a vector-vector operation defined as:
- *   res = x * y
+ * The eigenvalues are those of `V^T A V`, written to `ritz_values` by
+ * decreasing modulus and, if `ritz_vectors` is not NULL, the matching unit
+ * eigenvectors `V y` to its `s` consecutive blocks of `n` elements. If fewer
+ * than `s` pairs converged, the locked ones come first, followed by the current
+ * Ritz pairs. `ws` follows the same rules as for the Gram-Schmidt routines and
+ * `info`, if not NULL, receives the statistics of the run.
  *
- * Where:
- * - `x` and `y` are vectors.
- * - `len` is the number of elements in the vectors.
+ * Returns 0 if the `s` pairs converged, 1 if they did not within
+ * `max_restarts` restarts and -1 on error.
+ **/
+int eram(size_t n, size_t s, size_t m, matrix_t const* mat_A, double* x, double tol,
+         size_t max_restarts, double complex* ritz_values, double complex* ritz_vectors,
+         arena_t* ws, arnoldi_info_t* info);
+
+/**
+ * Same as `eram`, for a matrix-free operator of order `A->n`.
  **/
-double ddot(size_t len, double const* x, double const* y);
+int eram_op(size_t s, size_t m, operator_t const* A, double* x, double tol, size_t max_restarts,
+            double complex* ritz_values, double complex* ritz_vectors, arena_t* ws,
+            arnoldi_info_t* info);
 
 /**
- * Computes the double precision Euclidean/L2 norm of a vector.
- * 
- * The `nrm2` routine performs a vector reduction operation defined as:
- *   res = ||x||
+ * Returns the size in bytes of the workspace needed by `iram`.
+ **/
+size_t iram_workspace(size_t n, size_t s, size_t m);
+
+/**
+ * Computes the `s` eigenvalues of largest modulus of `A` with the implicitly
+ * restarted Arnoldi method of Sorensen. The `m`-step factorization built
+ * from `x` by modified Gram-Schmidt is compressed at each restart to `k`
+ * steps, `s <= k < m - 1`, by `m - k` shifted QR steps on `H` using the
+ * unwanted Ritz values as shifts. `Q` is updated in place and only the
+ * last `m - k` basis vectors are recomputed, so each restart costs `m - k`
+ * matrix-vector products instead of `m`.
  *
- * Where:
- * - `x` is a vector.
- * - `len` is the number of elements in the vector.
+ * Requires `m >= s + 3`. The outputs and return values are those of `eram`;
+ * `x` is only read.
+ **/
+int iram(size_t n, size_t s, size_t m, matrix_t const* mat_A, double* x, double tol,
+         size_t max_restarts, double complex* ritz_values, double complex* ritz_vectors,
+         arena_t* ws, arnoldi_info_t* info);
+
+/**
+ * Same as `iram`, for a matrix-free operator of order `A->n`.
+ **/
+int iram_op(size_t s, size_t m, operator_t const* A, double* x, double tol, size_t max_restarts,
+            double complex* ritz_values, double complex* ritz_vectors, arena_t* ws,
+            arnoldi_info_t* info);
+
+/**
+ * Right preconditioner of `gmres`: computes `y = M^-1 x` for vectors of `n`
+ * elements, `ctx` being given back as is.
+ **/
+typedef void (*preconditioner_fn)(size_t n, void const* ctx, double const* x, double* y);
+
+/**
+ * Jacobi preconditioner, where `ctx` holds the `n` inverses of the diagonal
+ * of `A`.
+ **/
+void jacobi_preconditioner(size_t n, void const* ctx, double const* x, double* y);
+
+/**
+ * Statistics of a run of `gmres`. Times are in nanoseconds.
  **/
-double dnrm2(size_t len, double const* x);
+typedef struct gmres_info_s {
+    size_t nb_restarts;
+    size_t nb_iterations;
+    double residual;
+    double t_arnoldi;
+    double t_givens;
+    double t_update;
+    double t_total;
+} gmres_info_t;
 
 /**
- * Computes the double precision Frobenius norm of a matrix.
- * 
- * The `nrmf` routine performs a matrix operation defined as:
- *   res = ||A||
+ * Returns the size in bytes of the workspace needed by `gmres` for an
+ * operator of order `n` and restarts every `m` iterations.
+ **/
+size_t gmres_workspace(size_t n, size_t m);
+
+/**
+ * Solves `A x = b` with GMRES(m), starting from the initial guess in `x`.
+ * Each cycle runs up to `m` steps of `modified_gram_schmidt` on
+ * `A M^-1`, where `M^-1` is applied by `precond` if it is not NULL, and
+ * reduces `H` to triangular form with Givens rotations as it grows, which
+ * gives the residual norm at every step for free. The cycle stops early
+ * once `||b - A x|| / ||b||` drops below `tol`, and the method restarts
+ * from the updated `x` up to `max_restarts` times.
  *
- * Where:
- * - `A` is a matrix.
- * - `rows` is the number of elements in the matrix's rows.
- * - `cols` is the number of elements in the matrix's cols.
+ * `ws` follows the same rules as for the Gram-Schmidt routines and `info`,
+ * if not NULL, receives the statistics of the run. Returns 0 if the
+ * iteration converged, 1 if it did not and -1 on error.
+ **/
+int gmres(size_t n, matrix_t const* mat_A, double const* b, double* x, size_t m, double tol,
+          size_t max_restarts, preconditioner_fn precond, void const* ctx, arena_t* ws,
+          gmres_info_t* info);
+
+/**
+ * Same as `gmres`, with the products by `A` computed by `sparse_spmv`.
+ **/
+int gmres_sparse(size_t n, sparse_t const* A, double const* b, double* x, size_t m, double tol,
+                 size_t max_restarts, preconditioner_fn precond, void const* ctx, arena_t* ws,
+                 gmres_info_t* info);
+
+/**
+ * Same as `gmres`, for a matrix-free operator of order `A->n`.
+ **/
+int gmres_op(operator_t const* A, double const* b, double* x, size_t m, double tol,
+             size_t max_restarts, preconditioner_fn precond, void const* ctx, arena_t* ws,
+             gmres_info_t* info);
+
+/**
+ * Reorthogonalization strategy of the Lanczos iteration.
+ **/
+typedef enum lanczos_reorth_e {
+    LANCZOS_NO_REORTH,
+    LANCZOS_SELECTIVE,
+    LANCZOS_PARTIAL,
+    LANCZOS_FULL,
+} lanczos_reorth_t;
+
+char const* lanczos_reorth_to_str(lanczos_reorth_t reorth);
+
+/**
+ * Statistics of a run of `lanczos`. `nb_reorth` counts the vectors the new
+ * Lanczos vectors were orthogonalized against, on top of the three-term
+ * recurrence, and `t_reorth` the nanoseconds spent doing so, including the
+ * tridiagonal eigensolves of the selective variant.
+ **/
+typedef struct lanczos_info_s {
+    size_t nb_steps;
+    size_t nb_reorth;
+    double t_reorth;
+} lanczos_info_t;
+
+/**
+ * Returns the size in bytes of the workspace needed by `lanczos` for
+ * vectors of `n` elements and `deg_m` steps.
  **/
-double dnrmf(size_t rows, size_t cols, double const* A);
+size_t lanczos_workspace(size_t n, size_t deg_m);
 
 /**
- * Computes a double precision matrix-vector product and adds the result to the
- * `y` vector.
+ * Runs `deg_m` steps of the Lanczos iteration on the symmetric operator
+ * `A` from `x`, which computes `A Q = Q T + beta_m q_m e_m^T` with the
+ * three-term recurrence: each step costs one matrix-vector product and
+ * O(n) work, against O(n k) for the `k`-th Gram-Schmidt step. The
+ * tridiagonal `T` is returned in `alpha[0..deg_m - 1]` (diagonal) and
+ * `beta[0..deg_m - 2]` (off-diagonal), and `beta[deg_m - 1]` is the norm of
+ * the residual, so that `|beta[deg_m - 1] s_m|` bounds the residual of the
+ * Ritz pair `(theta, Q s)` given by `tridiagonal_eigen`.
  *
- * The `dgemv` routine performs a matrix-vector operation defined as:
- *   y = alpha * A * x + beta * y
+ * `reorth` restores the orthogonality lost in finite precision:
+ * - `LANCZOS_FULL` orthogonalizes each vector twice against all the others;
+ * - `LANCZOS_PARTIAL` (Simon) tracks the loss with the recurrence satisfied
+ *   by the inner products and only reorthogonalizes two consecutive vectors
+ *   once it exceeds `sqrt(eps)`;
+ * - `LANCZOS_SELECTIVE` (Parlett and Scott) orthogonalizes each vector
+ *   against the Ritz vectors that have converged, the only directions in
+ *   which orthogonality is lost.
  *
- * Where:
- * - `alpha` and `beta` are scalars.
- * - `x` and `y` are vectors.
- * - `A` is a matrix.
- * - `m` is the number of elements in the matrix rows.
- * - `n` is the number of elements in the matrix columns and in the vectors.
- **/
-void dgemv(size_t m, size_t n, double alpha,
-           double const* restrict A, double const* restrict x,
-           double beta, double* restrict y);
-
-void classical_gram_schmidt(size_t n, double* restrict x, double* restrict A,
-                            size_t deg_m, matrix_t* mat_Q, matrix_t* mat_H);
-
-void modified_gram_schmidt(size_t n, double* restrict x, double* restrict A,
-                           size_t deg_m, matrix_t* mat_Q, matrix_t* mat_H);
+ * `Q` must have at least `deg_m` columns, and receives `q_m` as well if it
+ * has one more. It may be NULL with `LANCZOS_NO_REORTH`, in which case only
+ * `T` is computed and the storage is O(n). `ws` follows the same rules as
+ * for the Gram-Schmidt routines. Returns the number of steps done, less
+ * than `deg_m` if an invariant subspace was found, and 0 on error.
+ **/
+size_t lanczos(size_t n, double const* x, matrix_t const* mat_A, size_t deg_m,
+               lanczos_reorth_t reorth, matrix_t* mat_Q, double* alpha, double* beta, arena_t* ws,
+               lanczos_info_t* info);
+
+/**
+ * Same as `lanczos`, with the products by `A` computed by `sparse_spmv`.
+ **/
+size_t lanczos_sparse(size_t n, double const* x, sparse_t const* A, size_t deg_m,
+                      lanczos_reorth_t reorth, matrix_t* mat_Q, double* alpha, double* beta,
+                      arena_t* ws, lanczos_info_t* info);
+
+/**
+ * Same as `lanczos`, for a matrix-free operator of order `A->n`. With
+ * `LANCZOS_NO_REORTH` and no `Q`, the memory used is a few vectors of
+ * `A->n` elements, whatever the size of the operator.
+ **/
+size_t lanczos_op(double const* x, operator_t const* A, size_t deg_m, lanczos_reorth_t reorth,
+                  matrix_t* mat_Q, double* alpha, double* beta, arena_t* ws,
+                  lanczos_info_t* info);
@@ -0,0 +1,123 @@
+/**
+ * Declaration template of the BLAS kernels, instantiated once per precision
+ * by `blas.h`.
+ *
+ * Before including this file, define:
+ * - `BLAS_PREFIX` to the precision prefix (`s`, `d`, `c` or `z`).
+ * - `BLAS_T` to the element type (e.g. `float complex` for `c`).
+ * - `BLAS_R` to the matching real type (e.g. `float` for `c`).
+ *
+ * These macros are undefined at the end of the file.
+ *
+ * No `#pragma once` on purpose.
+ **/
+
+#ifndef BLAS_CAT
+    #define BLAS_CAT_(a, b) a##b
+    #define BLAS_CAT(a, b) BLAS_CAT_(a, b)
+    #define BLAS_FN(name) BLAS_CAT(BLAS_PREFIX, name)
+#endif
+
+/**
+ * Computes a scalar-vector product and adds the result to a vector.
+ *
+ * The `?axpy` routine performs a vector-vector operation defined as:
+ *   y = a * x + y
+ *
+ * Where:
+ * - `a` is a scalar.
+ * - `x` and `y` are vectors.
+ * - `len` is the number of elements in the vectors.
+ **/
+void BLAS_FN(axpy)(size_t len, BLAS_T alpha, BLAS_T const* x, BLAS_T* y);
+
+/**
+ * Computes a vector-vector dot product.
+ *
+ * The `?dot` routine performs a vector-vector operation defined as:
+ *   res = xH * y
+ *
+ * Where:
+ * - `x` and `y` are vectors (`x` is conjugated for complex precisions, as in
+ *   the `?dotc` routines of the reference BLAS).
+ * - `len` is the number of elements in the vectors.
+ **/
+BLAS_T BLAS_FN(dot)(size_t len, BLAS_T const* x, BLAS_T const* y);
+
+/**
+ * Computes the Euclidean/L2 norm of a vector.
+ *
+ * The `?nrm2` routine performs a vector reduction operation defined as:
+ *   res = ||x||
+ *
+ * Where:
+ * - `x` is a vector.
+ * - `len` is the number of elements in the vector.
+ **/
+BLAS_R BLAS_FN(nrm2)(size_t len, BLAS_T const* x);
+
+/**
+ * Computes the Frobenius norm of a matrix.
+ *
+ * The `?nrmf` routine performs a matrix operation defined as:
+ *   res = ||A||
+ *
+ * Where:
+ * - `A` is a matrix.
+ * - `rows` is the number of elements in the matrix's rows.
+ * - `cols` is the number of elements in the matrix's cols.
+ **/
+BLAS_R BLAS_FN(nrmf)(size_t rows, size_t cols, BLAS_T const* A);
+
+/**
+ * Computes a matrix-vector product and adds the result to the `y` vector.
+ *
+ * The `?gemv` routine performs a matrix-vector operation defined as:
+ *   y = alpha * A * x + beta * y
+ *
+ * Where:
+ * - `alpha` and `beta` are scalars.
+ * - `x` and `y` are vectors.
+ * - `A` is a matrix.
+ * - `m` is the number of elements in the matrix rows.
+ * - `n` is the number of elements in the matrix columns and in the vectors.
+ **/
+void BLAS_FN(gemv)(size_t m, size_t n, BLAS_T alpha, BLAS_T const* restrict A,
+                   BLAS_T const* restrict x, BLAS_T beta, BLAS_T* restrict y);
+
+/**
+ * Strided variants of the kernels above, operating on vectors whose
+ * consecutive elements are `inc?` elements apart, e.g. a column of a
+ * row-major matrix. `?gemv_strided` reads `A(i, j)` at `A[i * rs_a + j * cs_a]`,
+ * so it handles both row-major and column-major storage. They fall back to the
+ * contiguous kernels when all the increments are unit.
+ **/
+void BLAS_FN(axpy_strided)(size_t len, BLAS_T alpha, BLAS_T const* x, size_t incx, BLAS_T* y,
+                           size_t incy);
+BLAS_T BLAS_FN(dot_strided)(size_t len, BLAS_T const* x, size_t incx, BLAS_T const* y,
+                            size_t incy);
+BLAS_R BLAS_FN(nrm2_strided)(size_t len, BLAS_T const* x, size_t incx);
+void BLAS_FN(gemv_strided)(size_t m, size_t n, BLAS_T alpha, BLAS_T const* restrict A,
+                           size_t rs_a, size_t cs_a, BLAS_T const* restrict x, size_t incx,
+                           BLAS_T beta, BLAS_T* restrict y, size_t incy);
+
+/**
+ * Computes a matrix-matrix product and adds the result to the `C` matrix.
+ *
+ * The `?gemm` routine performs a matrix-matrix operation defined as:
+ *   C = alpha * A * B + beta * C
+ *
+ * Where:
+ * - `alpha` and `beta` are scalars.
+ * - `A`, `B` and `C` are matrices.
+ * - `l` is the number of elements in the rows of the `A` and `C` matrices.
+ * - `m` is the number of elements in the columns of the `B` and `C` matrices.
+ * - `n` is the number of elements in the columns of the `A` matrix and in the
+ *   rows of the `B` matrix.
+ **/
+void BLAS_FN(gemm)(size_t l, size_t m, size_t n, BLAS_T alpha, BLAS_T const* restrict A,
+                   BLAS_T const* restrict B, BLAS_T beta, BLAS_T* restrict C);
+
+#undef BLAS_PREFIX
+#undef BLAS_T
+#undef BLAS_R
@@ -1,7 +1,101 @@
 #pragma once
 
+#include "blas.h"
 #include "matrix.h"
+#include "ooc.h"
+#include "operator.h"
+#include "sparse.h"
 #include "stats.h"
 
+#include <stdbool.h>
+
 stats_t* driver_cgs(size_t n, matrix_t* A, vector_t* x, size_t deg_m, size_t reps);
-stats_t* driver_mgs(size_t n, matrix_t* A, vector_t* x, size_t deg_m, size_t reps);
\ No newline at end of file
+stats_t* driver_mgs(size_t n, matrix_t* A, vector_t* x, size_t deg_m, size_t reps);
+stats_t* driver_cgs2(size_t n, matrix_t* A, vector_t* x, size_t deg_m, size_t reps);
+stats_t* driver_householder(size_t n, matrix_t* A, vector_t* x, size_t deg_m, size_t reps);
+stats_t* driver_cgs2_omp(size_t n, matrix_t* A, vector_t* x, size_t deg_m, size_t reps);
+stats_t* driver_s_step(size_t n, matrix_t* A, vector_t* x, size_t deg_m, size_t s,
+                       s_step_basis_t basis, size_t reps);
+stats_t* driver_cgs_sparse(sparse_t const* A, vector_t* x, size_t deg_m, size_t reps);
+stats_t* driver_mgs_sparse(sparse_t const* A, vector_t* x, size_t deg_m, size_t reps);
+stats_t* driver_cgs2_sparse(sparse_t const* A, vector_t* x, size_t deg_m, size_t reps);
+stats_t* driver_spmv(sparse_t const* A, size_t reps);
+stats_t* driver_ooc_dgemv(ooc_matrix_t const* A, size_t tile_bytes, size_t reps, ooc_stats_t* io);
+stats_t* driver_ooc_dgemm(ooc_matrix_t const* A, size_t p, size_t tile_bytes, size_t reps,
+                          ooc_stats_t* io);
+stats_t* driver_eram(size_t n, matrix_t* A, vector_t* x, size_t s, size_t m, double tol,
+                     size_t max_restarts, arnoldi_info_t* info);
+stats_t* driver_iram(size_t n, matrix_t* A, vector_t* x, size_t s, size_t m, double tol,
+                     size_t max_restarts, arnoldi_info_t* info);
+
+/**
+ * Appends the number of restarts, matrix-vector products, converged pairs,
+ * largest residual and the mean time per phase of an ERAM or IRAM run to
+ * `filename`, or prints them if it is NULL.
+ **/
+int arnoldi_info_dump(char const* title, size_t size, arnoldi_info_t const* info,
+                      char const* filename);
+
+/**
+ * Appends the loss of orthogonality `||I - Q^T Q||_F` of the bases built by
+ * CGS, MGS, CGS2, the monomial and Newton s-step Arnoldi with blocks of `s`
+ * and the Householder Arnoldi to `filename`, or prints them if it is NULL.
+ **/
+int driver_orthogonality(size_t n, matrix_t* A, vector_t* x, size_t deg_m, size_t s,
+                         char const* filename);
+
+/**
+ * Time-to-solution of GMRES(m) on `A x = b` for a fixed `b`, optionally
+ * Jacobi-preconditioned. `driver_gmres_sparse` only takes CSR matrices.
+ **/
+stats_t* driver_gmres(size_t n, matrix_t* A, size_t m, double tol, size_t max_restarts,
+                      bool jacobi, gmres_info_t* info);
+stats_t* driver_gmres_sparse(sparse_t const* A, size_t m, double tol, size_t max_restarts,
+                             bool jacobi, gmres_info_t* info);
+
+/**
+ * Appends the number of restarts and iterations, the final relative residual
+ * and the mean time per phase and to solution of a GMRES run to `filename`,
+ * or prints them if it is NULL.
+ **/
+int gmres_info_dump(char const* title, size_t size, gmres_info_t const* info,
+                    char const* filename);
+
+/**
+ * Runs `deg_m` Lanczos steps on the symmetric matrix `A` and extracts the
+ * Ritz values. `driver_lanczos_sparse` takes any sparse format.
+ **/
+stats_t* driver_lanczos(size_t n, matrix_t* A, vector_t* x, size_t deg_m, lanczos_reorth_t reorth,
+                        size_t reps, lanczos_info_t* info);
+stats_t* driver_lanczos_sparse(sparse_t const* A, vector_t* x, size_t deg_m,
+                               lanczos_reorth_t reorth, size_t reps, lanczos_info_t* info);
+
+/**
+ * Same as `driver_lanczos`, for a matrix-free operator called `name` in the
+ * title. The basis is only stored if `reorth` needs it.
+ **/
+stats_t* driver_lanczos_op(char const* name, operator_t const* A, vector_t* x, size_t deg_m,
+                           lanczos_reorth_t reorth, size_t reps, lanczos_info_t* info);
+
+/**
+ * Appends the number of steps and reorthogonalizations and the time spent
+ * in the latter of a Lanczos run to `filename`, or prints them if it is NULL.
+ **/
+int lanczos_info_dump(char const* title, size_t size, lanczos_info_t const* info,
+                      char const* filename);
+
+/**
+ * Times the matrix-free Laplacian on `grid`, applied to its smoothest
+ * eigenvector. `resQ` is the residual of that eigenpair relative to `||A||`.
+ **/
+stats_t* driver_laplacian(laplacian_t const* grid, size_t reps);
+
+/**
+ * Runs a block Arnoldi of `deg_m` vectors, a multiple of the number of
+ * columns of the column-major starting block `X`.
+ * `driver_block_arnoldi_sparse` takes any sparse format.
+ **/
+stats_t* driver_block_arnoldi(size_t n, matrix_t* A, matrix_t const* X, size_t deg_m,
+                              size_t reps);
+stats_t* driver_block_arnoldi_sparse(sparse_t const* A, matrix_t const* X, size_t deg_m,
+                                     size_t reps);
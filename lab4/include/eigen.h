@@ -0,0 +1,72 @@
+#pragma once
+
+#include <complex.h>
+#include <stddef.h>
+
+/**
+ * Dense eigensolvers for the small projected matrices built by the Krylov
+ * methods. Matrices are row-major, with rows starting `ld` elements apart.
+ **/
+
+/**
+ * Computes all the eigenvalues of the `n * n` upper Hessenberg matrix `H`
+ * with the Francis double-shift QR algorithm, in real arithmetic. `H` is
+ * left untouched and `work` must hold `n * n` doubles. Complex eigenvalues
+ * come in conjugate pairs, in consecutive entries of `w`. Returns 0 on
+ * success, -1 if the iteration did not converge.
+ **/
+int hessenberg_eigvals(size_t n, double const* H, size_t ld, double complex* w, double* work);
+
+/**
+ * Computes an eigenvector `y` of unit 2-norm of the `n * n` upper Hessenberg
+ * matrix `H`, associated with its eigenvalue `lambda`, by inverse iteration.
+ * `work` must hold `n * n` complex doubles.
+ **/
+void hessenberg_eigvec(size_t n, double const* H, size_t ld, double complex lambda,
+                       double complex* y, double complex* work);
+
+/**
+ * Sorts the `n` indices in `idx` by decreasing modulus of `w[idx[i]]`.
+ **/
+void eigvals_sort_by_modulus(size_t n, double complex const* w, size_t* idx);
+
+/**
+ * Applies one shifted QR step to the `n * n` upper Hessenberg matrix `H`:
+ * `H <- P^T H P`, where `P` is the orthogonal factor of the QR
+ * factorization of `H - shift * I`, or of `(H - shift * I)(H - conj(shift) * I)`
+ * if `shift` is complex, so that arithmetic stays real. `P` is accumulated
+ * into the `rows * n` row-major matrix `Z`: `Z <- Z P`. `work` must hold
+ * `n * (n + 1)` doubles.
+ **/
+void hessenberg_shifted_qr(size_t n, double* H, size_t ld, double complex shift, size_t rows,
+                           double* Z, size_t ldz, double* work);
+
+/**
+ * Writes the `n` eigenvalues `w` of a real matrix to `shifts` in modified
+ * Leja order: the largest in modulus first, then each one maximizing the
+ * product of its distances to those already taken. Complex conjugate pairs
+ * stay adjacent, the one with a positive imaginary part first, so that
+ * they can be applied as real double shifts.
+ **/
+void eigvals_leja_order(size_t n, double complex const* w, double complex* shifts);
+
+/**
+ * Computes all the eigenvalues of the `n * n` symmetric tridiagonal matrix
+ * with diagonal `d` and off-diagonal `e[0..n - 2]` by the implicit QL
+ * algorithm with Wilkinson shifts. `d` is overwritten by the eigenvalues in
+ * ascending order and `e`, which must hold `n` doubles, is destroyed. The
+ * eigenvectors are accumulated into the `rows * n` row-major matrix `Z`:
+ * `Z <- Z S`, with the columns of `S` in the order of `d`, so that `Z = I`
+ * gives all of them and `Z = e_n^T` only their last components. Returns 0
+ * on success, -1 if the iteration did not converge.
+ **/
+int tridiagonal_eigen(size_t n, double* d, double* e, size_t rows, double* Z, size_t ldz);
+
+/**
+ * Computes an eigenvector `y` of unit 2-norm of the symmetric tridiagonal
+ * matrix with diagonal `d` and off-diagonal `e[0..n - 2]`, associated with
+ * its eigenvalue `lambda`, by inverse iteration with a pivoted LU
+ * factorization of `T - lambda I`. `work` must hold `5 * n` doubles.
+ **/
+void tridiagonal_eigvec(size_t n, double const* d, double const* e, double lambda, double* y,
+                        double* work);
@@ -1,17 +1,36 @@
 #pragma once
 
+#include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 
 #define ALIGNMENT 64
+// Size of a cache line, in doubles
+#define CACHE_LINE_ELEMS 8
 
 /**
- * Represents a matrix storing double precision floating-point values stored
- * contiguously in memory, of dimensions `rows * cols`.
+ * Storage order of the elements of a matrix.
+ **/
+typedef enum layout_e {
+    ROW_MAJOR,
+    COL_MAJOR,
+} layout_t;
+
+/**
+ * Represents a matrix storing double precision floating-point values, of
+ * dimensions `rows * cols`, either row by row or column by column depending
+ * on its `layout`. Consecutive rows (resp. columns) start `ld` elements apart,
+ * which may leave padding after each of them (see `matrix_padded_ld`).
  **/
 typedef struct matrix_s {
     double* data;
     size_t rows;
     size_t cols;
+    layout_t layout;
+    size_t ld;
+    // File mapping backing `data`, if any (see `matrix_map`)
+    void* mapping;
+    size_t mapping_len;
 } matrix_t;
 
 /**
@@ -20,18 +39,129 @@ typedef struct matrix_s {
  **/
 typedef matrix_t vector_t;
 
+/**
+ * Represents a strided view over the elements of a matrix, without owning
+ * them. Element `(i, j)` of the view is stored at
+ * `data[offset + i * ld + j * stride]`, where:
+ * - `data` is the storage of the viewed matrix.
+ * - `offset` is the position of the view's first element in `data`.
+ * - `ld` (leading dimension) is the distance between two consecutive rows.
+ * - `stride` is the distance between two consecutive columns.
+ *
+ * Rows, columns and submatrices of a row-major matrix can all be described
+ * this way, and so can its transpose by swapping `ld` and `stride`.
+ **/
+typedef struct matrix_view_s {
+    double* data;
+    size_t offset;
+    size_t rows;
+    size_t cols;
+    size_t ld;
+    size_t stride;
+} matrix_view_t;
+
+/**
+ * Represents a strided view over a vector, i.e. a view with one of its
+ * dimensions set to 1.
+ **/
+typedef matrix_view_t vector_view_t;
+
+/**
+ * Magic bytes at the start of a binary matrix file.
+ **/
+#define MATRIX_FILE_MAGIC "MPNAMAT\x01"
+
+/**
+ * Type of the elements stored in a binary matrix file.
+ **/
+typedef enum matrix_dtype_e {
+    DTYPE_F64,
+} matrix_dtype_t;
+
+/**
+ * Header of a binary matrix file. It is followed by padding up to
+ * `data_offset`, then by the `rows * cols` raw elements, in the byte order of
+ * the machine that wrote them and in the given `layout`. `data_offset` is a
+ * multiple of `alignment`, itself a multiple of the page size, so that the
+ * elements can be mapped in place.
+ **/
+typedef struct matrix_file_header_s {
+    char magic[8];
+    uint32_t dtype;
+    uint32_t layout;
+    uint64_t alignment;
+    uint64_t rows;
+    uint64_t cols;
+    uint64_t data_offset;
+} matrix_file_header_t;
+
+/**
+ * Reads and validates the header of the binary matrix file open as `fd`.
+ * Returns 0 on success, -1 if the file is not a supported binary matrix file
+ * or is shorter than its header says.
+ **/
+int matrix_file_header_read(int fd, matrix_file_header_t* header);
+
+/**
+ * Reads a matrix from a file. Binary matrix files (see `matrix_write`) are
+ * mapped with `matrix_map` and Matrix Market files are read with
+ * `mtx_read_dense`. Other files are parsed as ASCII: the dimensions followed
+ * by the elements in row-major order.
+ **/
 matrix_t* matrix_read(const char* filename);
 
+/**
+ * Writes a matrix to a binary matrix file. Returns 0 on success, -1 on error.
+ **/
+int matrix_write(matrix_t const* self, char const* filename);
+
+/**
+ * Maps a binary matrix file in memory and returns a matrix whose elements
+ * point directly at the mapping, without copying them. The mapping is private:
+ * writes to the matrix are not carried over to the file. Returns NULL on error.
+ **/
+matrix_t* matrix_map(char const* filename);
+
+/**
+ * Returns the leading dimension to use for rows (resp. columns) of `len`
+ * elements. A stride that is an even number of cache lines maps the same
+ * element of consecutive rows to a handful of cache sets only, and walking
+ * down a column then causes conflict misses. Such strides, which include all
+ * power-of-two sizes from 16 up, are padded by one cache line.
+ **/
+size_t matrix_padded_ld(size_t len);
+
+/**
+ * Enables or disables the padding of the leading dimension of the matrices
+ * allocated afterwards. It is enabled by default. Vectors, mapped matrices and
+ * arena matrices are never padded.
+ **/
+void matrix_set_padding(bool enabled);
+
+bool matrix_get_padding();
+
+/**
+ * Returns whether a matrix has padding after its rows (resp. columns).
+ **/
+bool matrix_is_padded(matrix_t const* self);
+
 /**
  * Creates a new column vector of `len` elements, initialized with zeroes.
  **/
 vector_t* vector_zeroes(size_t len);
 
 /**
- * Creates a new matrix of `rows * cols` elements, initialized with zeroes.
+ * Creates a new row-major matrix of `rows * cols` elements, initialized with
+ * zeroes.
  **/
 matrix_t* matrix_zeroes(size_t rows, size_t cols);
 
+/**
+ * Creates a new matrix of `rows * cols` elements with the given storage
+ * layout, initialized with zeroes.
+ **/
+matrix_t* matrix_zeroes_layout(size_t rows, size_t cols, layout_t layout);
+
 /**
  * Creates a new column vector of `len` elements, initialized with ones.
  **/
@@ -52,9 +182,18 @@ vector_t* vector_rand_init(size_t len);
 /**
  * Creates a new matrix of `rows * cols` elements, initialized with random
  * values ranging in the interval of ]-1.0, 1.0[.
+ *
+ * Elements are drawn in parallel from a counter-based generator, so the
+ * result only depends on the seed and on the number of matrices initialized
+ * since it was set, not on the number of threads.
  **/
 matrix_t* matrix_rand_init(size_t rows, size_t cols);
 
+/**
+ * Sets the seed of `matrix_rand_init` and restarts its sequence of matrices.
+ **/
+void matrix_rand_seed(uint64_t seed);
+
 /**
  * Deallocates a vector.
  **/
@@ -71,10 +210,16 @@ void matrix_deinit(matrix_t* self);
 void vector_transpose(vector_t* self);
 
 /**
- * Transposes a matrix.
+ * Transposes a matrix. `self` and `transposed` may have different layouts.
  **/
 void matrix_transpose(matrix_t const* self, matrix_t* transposed);
 
+/**
+ * Transposes a matrix in place, without allocating a second matrix. A padded
+ * rectangular matrix loses its padding.
+ **/
+void matrix_transpose_inplace(matrix_t* self);
+
 /**
  * Prints a given vector.
  **/
@@ -90,3 +235,63 @@ size_t matrix_nb_elems(matrix_t const* self);
 size_t vector_nb_elems(vector_t const* self);
 
 matrix_t* matrix_copy(matrix_t const* self);
+
+/**
+ * Returns the position of element `(i, j)` in the storage of a matrix,
+ * according to its layout.
+ **/
+static inline size_t matrix_index(matrix_t const* self, size_t i, size_t j)
+{
+    return self->layout == ROW_MAJOR ? i * self->ld + j : j * self->ld + i;
+}
+
+/**
+ * Creates a view over the whole matrix.
+ **/
+matrix_view_t matrix_view(matrix_t const* self);
+
+/**
+ * Creates a view over the `rows * cols` submatrix of `self` whose top-left
+ * element is `(row, col)`.
+ **/
+matrix_view_t matrix_submatrix(matrix_t const* self, size_t row, size_t col, size_t rows,
+                               size_t cols);
+
+/**
+ * Creates a view over the `i`-th row of a matrix, as a row vector.
+ **/
+vector_view_t matrix_row(matrix_t const* self, size_t i);
+
+/**
+ * Creates a view over the `j`-th column of a matrix, as a column vector.
+ **/
+vector_view_t matrix_col(matrix_t const* self, size_t j);
+
+/**
+ * Returns a view over the transpose of `view`, without moving any element.
+ **/
+matrix_view_t matrix_view_transpose(matrix_view_t view);
+
+/**
+ * Returns a pointer to the first element of a view.
+ **/
+static inline double* view_ptr(matrix_view_t view)
+{
+    return view.data + view.offset;
+}
+
+/**
+ * Returns the number of elements of a vector view.
+ **/
+static inline size_t vector_view_len(vector_view_t view)
+{
+    return view.rows * view.cols;
+}
+
+/**
+ * Returns the distance between two consecutive elements of a vector view.
+ **/
+static inline size_t vector_view_inc(vector_view_t view)
+{
+    return view.cols == 1 ? view.ld : view.stride;
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "matrix.h"
+#include "sparse.h"
+
+/**
+ * First bytes of a Matrix Market file.
+ **/
+#define MTX_BANNER "%%MatrixMarket"
+
+/**
+ * Reads a Matrix Market (`.mtx`) file into a dense row-major matrix.
+ *
+ * Both the `coordinate` and `array` formats are supported, with `real`,
+ * `double`, `integer` or `pattern` fields and `general`, `symmetric` or
+ * `skew-symmetric` symmetries (the other triangle is filled in). Duplicate
+ * coordinate entries are summed. Returns NULL on error.
+ **/
+matrix_t* mtx_read_dense(char const* filename);
+
+/**
+ * Reads a Matrix Market (`.mtx`) file into a CSR matrix, with the same
+ * variants as `mtx_read_dense`. Symmetric matrices are stored in full.
+ * Returns NULL on error.
+ **/
+csr_t* mtx_read_csr(char const* filename);
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "matrix.h"
+
+#include <stddef.h>
+
+// Default size of the tiles streamed from disk, two of them are in memory
+#define OOC_TILE_BYTES (64UL << 20)
+
+/**
+ * Represents a matrix stored in a binary matrix file (see `matrix_write`)
+ * whose elements are not loaded in memory. The out-of-core kernels stream it
+ * from the file in tiles of whole rows (row-major files) or whole columns
+ * (column-major files), so that each tile is contiguous on disk.
+ **/
+typedef struct ooc_matrix_s {
+    int fd;
+    size_t rows;
+    size_t cols;
+    layout_t layout;
+    size_t data_offset;
+} ooc_matrix_t;
+
+/**
+ * Timings of an out-of-core kernel, in nanoseconds.
+ *
+ * `io` is the time the reader thread spent reading tiles and `compute` the
+ * time spent multiplying them. `wait` is the time the compute thread was
+ * blocked on the reader and `total` the wall time of the whole kernel.
+ **/
+typedef struct ooc_stats_s {
+    size_t bytes_read;
+    size_t nb_tiles;
+    double io;
+    double compute;
+    double wait;
+    double total;
+} ooc_stats_t;
+
+/**
+ * Opens a binary matrix file for out-of-core access. Returns NULL on error.
+ **/
+ooc_matrix_t* ooc_open(char const* filename);
+
+/**
+ * Closes an out-of-core matrix.
+ **/
+void ooc_close(ooc_matrix_t* self);
+
+/**
+ * Computes `y = alpha * A * x + beta * y`, reading `A` from disk in tiles of
+ * about `tile_bytes` bytes (at least one row or column). A dedicated thread
+ * reads the next tile while the current one is multiplied. If `stats` is not
+ * NULL, it is filled with the timings of the call. Returns 0 on success, -1
+ * on error, in which case `y` is left in an unspecified state.
+ **/
+int ooc_dgemv(double alpha, ooc_matrix_t const* A, double const* x, double beta, double* y,
+              size_t tile_bytes, ooc_stats_t* stats);
+
+/**
+ * Computes `C = alpha * A * B + beta * C`, where `B` and `C` are row-major
+ * matrices in memory, streaming `A` from disk as `ooc_dgemv` does.
+ **/
+int ooc_dgemm(double alpha, ooc_matrix_t const* A, matrix_t const* B, double beta, matrix_t* C,
+              size_t tile_bytes, ooc_stats_t* stats);
+
+/**
+ * Achieved read bandwidth in GiB/s, from the time spent reading only.
+ **/
+double ooc_io_bandwidth(ooc_stats_t const* stats);
+
+/**
+ * Overlap efficiency in [0, 1]: the share of the shorter of the I/O and the
+ * compute phases that was hidden behind the other one. 1 means that the wall
+ * time is the one of the longer phase alone, 0 that the phases were serial.
+ **/
+double ooc_overlap(ooc_stats_t const* stats);
+
+/**
+ * Appends the number of tiles, the I/O bandwidth and the overlap efficiency
+ * of an out-of-core kernel to `filename`, or prints them if it is NULL.
+ **/
+int ooc_stats_dump(char const* title, ooc_stats_t const* stats, char const* filename);
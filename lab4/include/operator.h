@@ -0,0 +1,75 @@
+#pragma once
+
+#include "matrix.h"
+#include "sparse.h"
+
+#include <stddef.h>
+
+/**
+ * Computes `y = A * x` for an operator `A` of order `n`, where `x` has a
+ * stride of `incx`. `ctx` is whatever the operator needs to apply itself,
+ * given back as is.
+ **/
+typedef void (*operator_fn)(size_t n, void const* ctx, double const* x, size_t incx, double* y);
+
+/**
+ * Matrix-free linear operator of order `n`, for the Krylov routines that
+ * only ever need the products `A * x`: `A` need not be stored at all.
+ **/
+typedef struct operator_s {
+    size_t n;
+    operator_fn apply;
+    void const* ctx;
+} operator_t;
+
+static inline void operator_apply(operator_t const* self, double const* x, size_t incx, double* y)
+{
+    self->apply(self->n, self->ctx, x, incx, y);
+}
+
+/**
+ * Wraps a stored matrix, applied with `cblas_dgemv` (dense) or `sparse_spmv`
+ * (sparse). The operator refers to `A` and must not outlive it.
+ **/
+operator_t operator_from_matrix(matrix_t const* A);
+operator_t operator_from_sparse(sparse_t const* A);
+
+/**
+ * Negative Laplacian `-Δ` in `dim` = 1, 2 or 3 dimensions, discretized with
+ * the second-order centered stencil (3, 5 or 7 points) on a regular grid of
+ * `nx * ny * nz` interior points, `ny` and `nz` being 1 when unused, with
+ * homogeneous Dirichlet boundary conditions and a unit grid spacing.
+ * Unknowns are numbered with `x` running fastest. The operator is symmetric
+ * positive definite, with eigenvalues
+ * `sum_d 2 - 2 cos(pi i_d / (n_d + 1))` for `1 <= i_d <= n_d`.
+ **/
+typedef struct laplacian_s {
+    size_t dim;
+    size_t nx;
+    size_t ny;
+    size_t nz;
+} laplacian_t;
+
+/**
+ * Returns a Laplacian on a cubic grid of `side` points per dimension.
+ **/
+laplacian_t laplacian_init(size_t dim, size_t side);
+
+/**
+ * Returns the number of unknowns of the Laplacian.
+ **/
+size_t laplacian_size(laplacian_t const* self);
+
+/**
+ * Returns the smallest (resp. largest) eigenvalue of the Laplacian.
+ **/
+double laplacian_min_eigval(laplacian_t const* self);
+double laplacian_max_eigval(laplacian_t const* self);
+
+/**
+ * Returns the Laplacian as an operator, which refers to `self` and must not
+ * outlive it. Rows of the grid are spread across OpenMP threads and each of
+ * them is computed with SIMD loops, as `2 dim x_i` minus one shifted row per
+ * neighbour, so that nothing but the two vectors is read from memory.
+ **/
+operator_t laplacian_operator(laplacian_t const* self);
@@ -0,0 +1,168 @@
+#pragma once
+
+#include "matrix.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Represents a sparse matrix of dimensions `rows * cols` in Compressed Sparse
+ * Row format. The column indices and values of the non-zeros of row `i` are
+ * stored in `col_idx` and `values`, from `row_ptr[i]` to `row_ptr[i + 1]`
+ * (excluded), sorted by column.
+ **/
+typedef struct csr_s {
+    size_t rows;
+    size_t cols;
+    size_t nnz;
+    size_t* row_ptr;
+    size_t* col_idx;
+    double* values;
+} csr_t;
+
+/**
+ * Creates a new CSR matrix able to hold `nnz` non-zeros, with `row_ptr`
+ * initialized with zeroes.
+ **/
+csr_t* csr_init(size_t rows, size_t cols, size_t nnz);
+
+/**
+ * Deallocates a CSR matrix.
+ **/
+void csr_deinit(csr_t* self);
+
+/**
+ * Sorts the non-zeros of each row of a CSR matrix by column.
+ **/
+void csr_sort_rows(csr_t* self);
+
+/**
+ * Represents a sparse matrix of dimensions `rows * cols` in SELL-C-σ format.
+ *
+ * Rows are sorted by decreasing length within windows of `sigma` rows, then
+ * grouped into chunks of `chunk_height` (C) consecutive rows. Each chunk is
+ * padded to the length of its longest row and stored column-major, so that
+ * the `k`-th non-zero of the `r`-th row of chunk `c` is at
+ * `chunk_ptr[c] + k * chunk_height + r` and a SIMD lane handles one row.
+ * Padding entries have a zero value and a valid column index.
+ *
+ * `perm[r]` is the row of the original matrix stored at position `r`.
+ **/
+typedef struct sell_s {
+    size_t rows;
+    size_t cols;
+    size_t nnz;
+    size_t chunk_height;
+    size_t sigma;
+    size_t nb_chunks;
+    size_t* chunk_ptr;
+    size_t* chunk_len;
+    size_t* perm;
+    uint32_t* col_idx;
+    double* values;
+} sell_t;
+
+// One AVX-512 register of doubles per chunk column
+#define SELL_CHUNK_HEIGHT 8
+#define SELL_MAX_CHUNK_HEIGHT 64
+#define SELL_SIGMA 256
+
+/**
+ * Converts a CSR matrix to SELL-C-σ, with chunks of `chunk_height` rows
+ * (at most `SELL_MAX_CHUNK_HEIGHT`) and a sorting scope of `sigma` rows.
+ * Returns NULL if the matrix has more than 2^32 columns.
+ **/
+sell_t* sell_from_csr(csr_t const* csr, size_t chunk_height, size_t sigma);
+
+/**
+ * Deallocates a SELL-C-σ matrix.
+ **/
+void sell_deinit(sell_t* self);
+
+/**
+ * Returns the number of stored entries of a SELL-C-σ matrix, padding
+ * included.
+ **/
+size_t sell_padded_nnz(sell_t const* self);
+
+/**
+ * Builds a CSR matrix from the non-zeros of a dense matrix.
+ **/
+csr_t* csr_from_dense(matrix_t const* mat);
+
+/**
+ * Creates a random `n * n` CSR matrix with a non-zero diagonal and up to
+ * `nnz_per_row - 1` other non-zeros per row, uniformly spread over the
+ * columns, with values in ]-1, 1[.
+ **/
+csr_t* csr_rand_init(size_t n, size_t nnz_per_row);
+
+/**
+ * Writes the diagonal of `A` to `d`, duplicate entries summed up.
+ **/
+void csr_diagonal(csr_t const* A, double* d);
+
+/**
+ * Returns whether `A` is square and equal to its transpose, entry by entry.
+ **/
+bool csr_is_symmetric(csr_t const* A);
+
+/**
+ * Computes `y = alpha * A * x + beta * y` in parallel, where `x` has a
+ * stride of `incx`. If `beta` is zero, `y` is not read.
+ **/
+void csr_spmv(double alpha, csr_t const* A, double const* x, size_t incx, double beta,
+              double* y);
+void sell_spmv(double alpha, sell_t const* A, double const* x, size_t incx, double beta,
+               double* y);
+
+/**
+ * Computes `Y = alpha * A * X + beta * Y` in parallel for the `b` columns of
+ * the column-major blocks `X` and `Y`, reading `A` once for all of them.
+ * If `beta` is zero, `Y` is not read.
+ **/
+void csr_spmm(double alpha, csr_t const* A, double const* X, size_t ldx, size_t b, double beta,
+              double* Y, size_t ldy);
+void sell_spmm(double alpha, sell_t const* A, double const* X, size_t ldx, size_t b, double beta,
+               double* Y, size_t ldy);
+
+typedef enum sparse_format_e {
+    SPARSE_CSR,
+    SPARSE_SELL,
+} sparse_format_t;
+
+/**
+ * Sparse matrix in any of the supported formats. It does not own the
+ * underlying storage.
+ **/
+typedef struct sparse_s {
+    sparse_format_t format;
+    union {
+        csr_t* csr;
+        sell_t* sell;
+    };
+} sparse_t;
+
+char const* sparse_format_to_str(sparse_format_t format);
+
+size_t sparse_rows(sparse_t const* A);
+
+/**
+ * Returns the number of bytes the SpMV kernel of `A` has to move at least:
+ * the matrix storage, one read of `x` and `y` and one write of `y`.
+ **/
+size_t sparse_spmv_bytes(sparse_t const* A);
+
+/**
+ * Computes `y = alpha * A * x + beta * y`, dispatching on the format of `A`.
+ **/
+void sparse_spmv(double alpha, sparse_t const* A, double const* x, size_t incx, double beta,
+                 double* y);
+
+/**
+ * Computes `Y = alpha * A * X + beta * Y` for a block of `b` columns,
+ * dispatching on the format of `A`.
+ **/
+void sparse_spmm(double alpha, sparse_t const* A, double const* X, size_t ldx, size_t b,
+                 double beta, double* Y, size_t ldy);
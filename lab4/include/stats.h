@@ -8,12 +8,16 @@
 typedef struct stats_s {
     char* title;
     size_t size;
+    size_t nb_bytes;
+    size_t nb_flops;
     double samples[MAX_SAMPLES];
     double min;
     double mean;
     double max;
     double median;
     double stddevp;
+    double mem_throughput;
+    double ops_throughput;
     double resQ;
     double resH;
 } stats_t;
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "arena.h"
+
+#include <stddef.h>
+
+// Rows of the blocks factored independently by `tsqr`
+#define TSQR_BLOCK_ROWS 1024
+
+/**
+ * Returns the size in bytes of the workspace needed by `tsqr` for a
+ * `rows * cols` matrix.
+ **/
+size_t tsqr_workspace(size_t rows, size_t cols);
+
+/**
+ * Computes the thin QR factorization `V = Q R` of the tall and skinny
+ * column-major `rows * cols` matrix `V` (`rows >= cols`), whose columns
+ * start `ldv` elements apart, with the one-level TSQR algorithm: blocks of
+ * about `TSQR_BLOCK_ROWS` rows are factored by Householder QR in parallel,
+ * then their stacked `R` factors are factored once more.
+ *
+ * `V` is overwritten by the explicit `Q` and `R` receives the upper
+ * triangular factor, row-major with rows starting `ldr` elements apart and
+ * a nonnegative diagonal. `ws` follows the same rules as for the
+ * Gram-Schmidt routines. Returns 0 on success, -1 on error.
+ **/
+int tsqr(size_t rows, size_t cols, double* V, size_t ldv, double* R, size_t ldr, arena_t* ws);
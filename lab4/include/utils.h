@@ -1,6 +1,7 @@
 #pragma once
 
 #include <stddef.h>
+#include <stdint.h>
 #include <time.h>
 
 #define ALIGNMENT 64
@@ -26,3 +27,30 @@ void sort_double(double *data, size_t len);
 double mean(double const* data, size_t len);
 double stddev(double const* data, size_t len);
 double compute_error(double lhs, double rhs);
+
+/**
+ * SplitMix64 finaliser: a bijective mix of the bits of `x`, such that
+ * consecutive inputs give statistically independent outputs.
+ **/
+static inline uint64_t splitmix64(uint64_t x)
+{
+    x += UINT64_C(0x9E3779B97F4A7C15);
+    x = (x ^ (x >> 30)) * UINT64_C(0xBF58476D1CE4E5B9);
+    x = (x ^ (x >> 27)) * UINT64_C(0x94D049BB133111EB);
+    return x ^ (x >> 31);
+}
+
+/**
+ * Counter-based random number generator: returns the `counter`-th double of
+ * the stream identified by `key`, in the interval ]min, max[.
+ *
+ * There is no state to share, so any thread can compute any element directly
+ * and the results do not depend on how the counters are distributed.
+ **/
+static inline double counter_double_range(uint64_t key, uint64_t counter, double min, double max)
+{
+    // Upper 53 bits as a double in ]0, 1[
+    uint64_t bits = splitmix64(key ^ splitmix64(counter)) >> 11;
+    double unit = ((double)(bits) + 0.5) * 0x1.0p-53;
+    return min + unit * (max - min);
+}
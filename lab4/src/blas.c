@@ -1,192 +1,2083 @@
 #include "blas.h"
+#include "arena.h"
+#include "eigen.h"
 #include "matrix.h"
+#include "tsqr.h"
+#include "utils.h"
 
 #include <assert.h>
 #include <cblas.h>
+#include <complex.h>
+#include <float.h>
 #include <math.h>
 #include <omp.h>
 #include <stdlib.h>
+#include <string.h>
 
-void daxpy(size_t len, double alpha, double const* x, double* y)
+// Norm under which a new Krylov vector is considered to be zero
+#define GRAM_SCHMIDT_EPSILON 1e-12
+// Doubles per cache line, the granularity of the threaded Gram-Schmidt blocks
+#define GS_LINE_ROWS 8
+// Rows of the basis compressed at once by the implicit restarts
+#define IRAM_BLOCK_ROWS 64
+// Ritz vectors beyond the wanted ones that the explicit restarts start from
+#define ERAM_NB_EXTRA 4
+
+#define BLAS_PREFIX s
+#define BLAS_T float
+#define BLAS_R float
+#include "blas_template.inc"
+
+#define BLAS_PREFIX d
+#define BLAS_T double
+#define BLAS_R double
+#include "blas_template.inc"
+
+#define BLAS_PREFIX c
+#define BLAS_T float complex
+#define BLAS_R float
+#include "blas_template.inc"
+
+#define BLAS_PREFIX z
+#define BLAS_T double complex
+#define BLAS_R double
+#include "blas_template.inc"
+
+void daxpy_view(double alpha, vector_view_t x, vector_view_t y)
 {
-    for (size_t i = 0; i < len; ++i) {
-        y[i] += alpha * x[i];
-    }
+    assert(vector_view_len(x) == vector_view_len(y));
+    daxpy_strided(vector_view_len(x), alpha, view_ptr(x), vector_view_inc(x), view_ptr(y),
+                  vector_view_inc(y));
+}
+
+double ddot_view(vector_view_t x, vector_view_t y)
+{
+    assert(vector_view_len(x) == vector_view_len(y));
+    return ddot_strided(vector_view_len(x), view_ptr(x), vector_view_inc(x), view_ptr(y),
+                        vector_view_inc(y));
 }
 
-double ddot(size_t len, double const* restrict x, double const* restrict y)
+double dnrm2_view(vector_view_t x)
 {
-    double res = 0.0;
+    return dnrm2_strided(vector_view_len(x), view_ptr(x), vector_view_inc(x));
+}
 
-    for (size_t i = 0; i < len; ++i) {
-        res += x[i] * y[i];
+double dnrmf_view(matrix_view_t A)
+{
+    double sum = 0.0;
+    for (size_t i = 0; i < A.rows; ++i) {
+        double const nrm = dnrm2_strided(A.cols, view_ptr(A) + i * A.ld, A.stride);
+        sum += nrm * nrm;
     }
+    return sqrt(sum);
+}
 
-    return res;
+void dgemv_view(double alpha, matrix_view_t A, vector_view_t x, double beta, vector_view_t y)
+{
+    assert(A.cols == vector_view_len(x) && A.rows == vector_view_len(y));
+    dgemv_strided(A.rows, A.cols, alpha, view_ptr(A), A.ld, A.stride, view_ptr(x),
+                  vector_view_inc(x), beta, view_ptr(y), vector_view_inc(y));
+}
+
+size_t gram_schmidt_workspace(size_t n)
+{
+    return arena_matrix_size(n, 1);
 }
 
-double dnrm2(size_t len, double const* restrict x)
+static void cgs(size_t n, double* restrict x, operator_fn matvec, void const* A, size_t deg_m,
+                matrix_t* mat_Q, matrix_t* mat_H, arena_t* ws)
 {
-    double res = 0.0;
+    double const epsilon = GRAM_SCHMIDT_EPSILON;
+    double(*restrict H)[mat_H->ld] = (double(*)[mat_H->ld])mat_H->data;
+    arena_t* tmp_ws = ws ? NULL : arena_init(gram_schmidt_workspace(n));
+    arena_t* arena = ws ? ws : tmp_ws;
+    if (!arena)
+        return;
+    size_t const mark = arena_mark(arena);
+    vector_t* mat_v = arena_matrix(arena, n, 1, ROW_MAJOR);
+    if (!mat_v)
+        goto cleanup;
+    vector_view_t v = matrix_col(mat_v, 0);
 
-    for (size_t i = 0; i < len; ++i) {
-        res += x[i] * x[i];
+    // Normalize first vector
+    double const x_nrm = dnrm2(n, x);
+    vector_view_t q_0 = matrix_col(mat_Q, 0);
+    double* restrict q = view_ptr(q_0);
+    size_t const inc_q = vector_view_inc(q_0);
+#pragma omp simd
+    for (size_t _ = 0; _ < n; ++_) {
+        q[_ * inc_q] = x[_] / x_nrm;
+    }
+
+    for (size_t k = 1; k < deg_m; ++k) {
+        // v_k+1 = A * v_k, where v_k = Q[:,k-1] and v = v_k+1
+        vector_view_t q_k = matrix_col(mat_Q, k - 1);
+        matvec(n, A, view_ptr(q_k), vector_view_inc(q_k), view_ptr(v));
+
+        for (size_t j = 0; j < k; ++j) {
+            // h_j_k-1 = Q[:,j] * v_k+1
+            H[j][k - 1] = ddot_view(matrix_col(mat_Q, j), v);
+        }
+
+        for (size_t j = 0; j < k; ++j) {
+            // v_k+1 -= h_j_k-1 * Q[:,j]
+            daxpy_view(-H[j][k - 1], matrix_col(mat_Q, j), v);
+        }
+
+        H[k][k - 1] = dnrm2_view(v);
+        if (H[k][k - 1] > epsilon) {
+            q = view_ptr(matrix_col(mat_Q, k));
+#pragma omp simd
+            for (size_t _ = 0; _ < n; ++_) {
+                q[_ * inc_q] = mat_v->data[_] / H[k][k - 1];
+            }
+        }
+        else {
+            goto cleanup;
+        }
     }
 
-    return sqrt(res);
+cleanup:
+    arena_reset(arena, mark);
+    arena_deinit(tmp_ws);
 }
 
-double dnrmf(size_t rows, size_t cols, double const* restrict A)
+/**
+ * Runs the modified Gram-Schmidt Arnoldi steps `k_first..deg_m - 1` on top
+ * of the orthonormal vectors `Q[:,0..k_first - 1]`, step `k` adding
+ * `Q[:,k]` and column `k - 1` of `H`. `v` is a scratch vector of `n`
+ * elements. Returns the number of basis vectors built, `deg_m` unless the
+ * iteration broke down.
+ **/
+static size_t mgs_extend(size_t n, operator_fn matvec, void const* A, size_t k_first, size_t deg_m,
+                         matrix_t* mat_Q, matrix_t* mat_H, double* v)
 {
-    double res = 0.0;
+    double const epsilon = GRAM_SCHMIDT_EPSILON;
+    double(*restrict H)[mat_H->ld] = (double(*)[mat_H->ld])mat_H->data;
+    size_t const inc_q = vector_view_inc(matrix_col(mat_Q, 0));
+
+    for (size_t k = k_first; k < deg_m; ++k) {
+        // Candidate vector, read straight from the Q[:,k-1] slice
+        vector_view_t q_k = matrix_col(mat_Q, k - 1);
+        matvec(n, A, view_ptr(q_k), vector_view_inc(q_k), v);
+
+        for (size_t j = 0; j < k; ++j) {
+            vector_view_t q_j = matrix_col(mat_Q, j);
+            H[j][k - 1] = cblas_ddot(n, view_ptr(q_j), vector_view_inc(q_j), v, 1);
+            cblas_daxpy(n, -H[j][k - 1], view_ptr(q_j), vector_view_inc(q_j), v, 1);
+        }
 
-    for (size_t i = 0; i < rows; ++i) {
-        for (size_t j = 0; j < cols; ++j) {
-            res += fabs(A[i * cols + j] * A[i * cols + j]);
+        H[k][k - 1] = cblas_dnrm2(n, v, 1);
+        if (H[k][k - 1] > epsilon) {
+            double* restrict q = view_ptr(matrix_col(mat_Q, k));
+#pragma omp simd
+            for (size_t _ = 0; _ < n; ++_) {
+                q[_ * inc_q] = v[_] / H[k][k - 1];
+            }
+        }
+        else {
+            return k;
         }
     }
 
-    return sqrt(res);
+    return deg_m;
 }
 
-void dgemv(size_t m, size_t n, double alpha,
-           double const* restrict A, double const* restrict x,
-           double beta, double* restrict y)
+static void mgs(size_t n, double* restrict x, operator_fn matvec, void const* A, size_t deg_m,
+                matrix_t* mat_Q, matrix_t* mat_H, arena_t* ws)
 {
-    if (!A || !x || !y) return;
-    assert((m != 0 && n != 0) && "`m` and `n` must be different than 0.");
+    arena_t* tmp_ws = ws ? NULL : arena_init(gram_schmidt_workspace(n));
+    arena_t* arena = ws ? ws : tmp_ws;
+    if (!arena)
+        return;
+    size_t const mark = arena_mark(arena);
+    double* v = arena_alloc(arena, n * sizeof(double));
+    if (!v)
+        goto cleanup;
 
-    for (size_t i = 0; i < m; ++i) {
-        double tmp = 0.0;
-        for (size_t j = 0; j < n; ++j) {
-            tmp += A[i * n + j] * x[j];
-        }
-        y[i] = alpha * tmp + beta * y[i];
+    // Normalize first vector
+    double const x_nrm = cblas_dnrm2(n, x, 1);
+    vector_view_t q_0 = matrix_col(mat_Q, 0);
+    double* restrict q = view_ptr(q_0);
+    size_t const inc_q = vector_view_inc(q_0);
+#pragma omp simd
+    for (size_t _ = 0; _ < n; ++_) {
+        q[_ * inc_q] = x[_] / x_nrm;
     }
+
+    mgs_extend(n, matvec, A, 1, deg_m, mat_Q, mat_H, v);
+
+cleanup:
+    arena_reset(arena, mark);
+    arena_deinit(tmp_ws);
 }
 
-void classical_gram_schmidt(size_t n, double* restrict x, double* restrict A,
-                            size_t deg_m, matrix_t* mat_Q, matrix_t* mat_H)
+size_t gram_schmidt2_workspace(size_t n, size_t deg_m)
 {
-    double epsilon = 1e-12;
-    double (* restrict H)[deg_m] = (double (*)[mat_H->cols])mat_H->data;
-    double (* restrict Q)[deg_m] = (double (*)[mat_Q->cols])mat_Q->data;
-    double* q_k = aligned_alloc(64, mat_Q->rows * sizeof(double));
-    if (!q_k) return;
-    double* v = aligned_alloc(64, n * sizeof(double));
-    if (!v) return;
-    double* q_j_T = aligned_alloc(64, mat_Q->rows * sizeof(double));
-    if (!q_j_T) return;
+    return arena_matrix_size(n, 1) + arena_matrix_size(deg_m, 1);
+}
+
+/**
+ * Classical Gram-Schmidt with one full reorthogonalization: each pass
+ * computes all the projections `h = Q^T v` with a single transposed dgemv and
+ * removes them with a single `v -= Q h`, so `v` is read twice per pass
+ * instead of twice per basis vector.
+ **/
+static void cgs2(size_t n, double* restrict x, operator_fn matvec, void const* A, size_t deg_m,
+                 matrix_t* mat_Q, matrix_t* mat_H, arena_t* ws)
+{
+    double const epsilon = GRAM_SCHMIDT_EPSILON;
+    double* restrict H = mat_H->data;
+    size_t const ldh = mat_H->ld;
+    arena_t* tmp_ws = ws ? NULL : arena_init(gram_schmidt2_workspace(n, deg_m));
+    arena_t* arena = ws ? ws : tmp_ws;
+    if (!arena)
+        return;
+    size_t const mark = arena_mark(arena);
+    double* v = arena_alloc(arena, n * sizeof(double));
+    double* h = arena_alloc(arena, deg_m * sizeof(double));
+    if (!v || !h)
+        goto cleanup;
 
     // Normalize first vector
-    #pragma omp simd
+    double const x_nrm = cblas_dnrm2(n, x, 1);
+    vector_view_t q_0 = matrix_col(mat_Q, 0);
+    double* restrict q = view_ptr(q_0);
+    size_t const inc_q = vector_view_inc(q_0);
+#pragma omp simd
     for (size_t _ = 0; _ < n; ++_) {
-        Q[_][0] = x[_] / dnrm2(n, x);
+        q[_ * inc_q] = x[_] / x_nrm;
     }
 
+    CBLAS_ORDER const order = mat_Q->layout == ROW_MAJOR ? CblasRowMajor : CblasColMajor;
     for (size_t k = 1; k < deg_m; ++k) {
-        // Initialize Q[:,k-1] slice
-        #pragma omp simd
-        for (size_t _ = 0; _ < mat_Q->rows; ++_) {
-            q_k[_] = Q[_][k - 1];
+        vector_view_t q_k = matrix_col(mat_Q, k - 1);
+        matvec(n, A, view_ptr(q_k), vector_view_inc(q_k), v);
+
+        // First pass, the projections go straight to H[0..k-1][k-1]
+        cblas_dgemv(order, CblasTrans, n, k, 1.0, mat_Q->data, mat_Q->ld, v, 1, 0.0,
+                    H + k - 1, ldh);
+        cblas_dgemv(order, CblasNoTrans, n, k, -1.0, mat_Q->data, mat_Q->ld, H + k - 1, ldh,
+                    1.0, v, 1);
+
+        // Second pass, removes what cancellation left of the first one
+        cblas_dgemv(order, CblasTrans, n, k, 1.0, mat_Q->data, mat_Q->ld, v, 1, 0.0, h, 1);
+        cblas_dgemv(order, CblasNoTrans, n, k, -1.0, mat_Q->data, mat_Q->ld, h, 1, 1.0, v, 1);
+        cblas_daxpy(k, 1.0, h, 1, H + k - 1, ldh);
+
+        H[k * ldh + k - 1] = cblas_dnrm2(n, v, 1);
+        if (H[k * ldh + k - 1] > epsilon) {
+            q = view_ptr(matrix_col(mat_Q, k));
+#pragma omp simd
+            for (size_t _ = 0; _ < n; ++_) {
+                q[_ * inc_q] = v[_] / H[k * ldh + k - 1];
+            }
         }
-        // v_k+1 = A * v_k, where v_k = q_k and v = v_k+1
-        dgemv(n, n, 1.0, A, q_k, 0.0, v);
+        else {
+            goto cleanup;
+        }
+    }
 
+cleanup:
+    arena_reset(arena, mark);
+    arena_deinit(tmp_ws);
+}
+
+void classical_gram_schmidt(size_t n, double* restrict x, matrix_t const* mat_A, size_t deg_m,
+                            matrix_t* mat_Q, matrix_t* mat_H, arena_t* ws)
+{
+    operator_t op = operator_from_matrix(mat_A);
+    op.n = n;
+    classical_gram_schmidt_op(x, &op, deg_m, mat_Q, mat_H, ws);
+}
+
+void modified_gram_schmidt(size_t n, double* restrict x, matrix_t const* mat_A, size_t deg_m,
+                           matrix_t* mat_Q, matrix_t* mat_H, arena_t* ws)
+{
+    operator_t op = operator_from_matrix(mat_A);
+    op.n = n;
+    modified_gram_schmidt_op(x, &op, deg_m, mat_Q, mat_H, ws);
+}
+
+void classical_gram_schmidt2(size_t n, double* restrict x, matrix_t const* mat_A, size_t deg_m,
+                             matrix_t* mat_Q, matrix_t* mat_H, arena_t* ws)
+{
+    operator_t op = operator_from_matrix(mat_A);
+    op.n = n;
+    classical_gram_schmidt2_op(x, &op, deg_m, mat_Q, mat_H, ws);
+}
+
+void classical_gram_schmidt_sparse(size_t n, double* restrict x, sparse_t const* A, size_t deg_m,
+                                   matrix_t* mat_Q, matrix_t* mat_H, arena_t* ws)
+{
+    operator_t op = operator_from_sparse(A);
+    op.n = n;
+    classical_gram_schmidt_op(x, &op, deg_m, mat_Q, mat_H, ws);
+}
+
+void modified_gram_schmidt_sparse(size_t n, double* restrict x, sparse_t const* A, size_t deg_m,
+                                  matrix_t* mat_Q, matrix_t* mat_H, arena_t* ws)
+{
+    operator_t op = operator_from_sparse(A);
+    op.n = n;
+    modified_gram_schmidt_op(x, &op, deg_m, mat_Q, mat_H, ws);
+}
+
+void classical_gram_schmidt2_sparse(size_t n, double* restrict x, sparse_t const* A, size_t deg_m,
+                                    matrix_t* mat_Q, matrix_t* mat_H, arena_t* ws)
+{
+    operator_t op = operator_from_sparse(A);
+    op.n = n;
+    classical_gram_schmidt2_op(x, &op, deg_m, mat_Q, mat_H, ws);
+}
+
+void classical_gram_schmidt_op(double* restrict x, operator_t const* A, size_t deg_m,
+                               matrix_t* mat_Q, matrix_t* mat_H, arena_t* ws)
+{
+    cgs(A->n, x, A->apply, A->ctx, deg_m, mat_Q, mat_H, ws);
+}
+
+void modified_gram_schmidt_op(double* restrict x, operator_t const* A, size_t deg_m,
+                              matrix_t* mat_Q, matrix_t* mat_H, arena_t* ws)
+{
+    mgs(A->n, x, A->apply, A->ctx, deg_m, mat_Q, mat_H, ws);
+}
+
+void classical_gram_schmidt2_op(double* restrict x, operator_t const* A, size_t deg_m,
+                                matrix_t* mat_Q, matrix_t* mat_H, arena_t* ws)
+{
+    cgs2(A->n, x, A->apply, A->ctx, deg_m, mat_Q, mat_H, ws);
+}
+
+size_t householder_arnoldi_workspace(size_t n, size_t deg_m)
+{
+    // Reflectors, triangular factor, candidate vector, projections and signs
+    return arena_matrix_size(n, deg_m) + arena_matrix_size(deg_m, deg_m) + n * sizeof(double) +
+           2 * deg_m * sizeof(double) + 3 * ALIGNMENT;
+}
+
+/**
+ * Computes the Householder reflector `I - tau v v^T`, with `v[0] = 1`, that
+ * maps the `m` elements of `z` to `beta e_0`, and returns `beta`. The sign
+ * of `beta` is the opposite of that of `z[0]`, to avoid cancellation.
+ **/
+static double householder_vector(size_t m, double const* z, double* v, double* tau)
+{
+    double const alpha = z[0];
+    double const xnrm = m > 1 ? cblas_dnrm2(m - 1, z + 1, 1) : 0.0;
+    v[0] = 1.0;
+    if (xnrm == 0.0) {
+        memset(v + 1, 0, (m > 1 ? m - 1 : 0) * sizeof(double));
+        *tau = 0.0;
+        return alpha;
+    }
+
+    double const beta = -copysign(hypot(alpha, xnrm), alpha);
+    double const scale = 1.0 / (alpha - beta);
+    for (size_t i = 1; i < m; ++i) {
+        v[i] = z[i] * scale;
+    }
+    *tau = (beta - alpha) / beta;
+    return beta;
+}
+
+/**
+ * Householder Arnoldi of Walker: the new vector `A q_k-1` is reduced by the
+ * `k` reflectors built so far, then a new reflector zeroes its entries below
+ * row `k`, so that `H` is exact up to rounding and `Q` orthogonal to working
+ * precision whatever the conditioning of the Krylov basis. The reflectors
+ * `P_0 ... P_k = I - V T V^T` are kept in compact WY form, with `V` unit
+ * lower trapezoidal and `T` upper triangular, so that applying them all is
+ * two dgemv and a dtrmv instead of `k` rank-1 updates. `q_k` is `P_0 ... P_k
+ * e_k`, up to a sign chosen so that `H[k][k-1] > 0` as with Gram-Schmidt.
+ **/
+static void householder(size_t n, double* restrict x, operator_fn matvec, void const* A,
+                        size_t deg_m, matrix_t* mat_Q, matrix_t* mat_H, arena_t* ws)
+{
+    double const epsilon = GRAM_SCHMIDT_EPSILON;
+    double* restrict H = mat_H->data;
+    size_t const ldh = mat_H->ld;
+    arena_t* tmp_ws = ws ? NULL : arena_init(householder_arnoldi_workspace(n, deg_m));
+    arena_t* arena = ws ? ws : tmp_ws;
+    if (!arena)
+        return;
+    size_t const mark = arena_mark(arena);
+    matrix_t* mat_V = arena_matrix(arena, n, deg_m, COL_MAJOR);
+    matrix_t* mat_T = arena_matrix(arena, deg_m, deg_m, COL_MAJOR);
+    double* z = arena_alloc(arena, n * sizeof(double));
+    double* y = arena_alloc(arena, deg_m * sizeof(double));
+    double* sigma = arena_alloc(arena, deg_m * sizeof(double));
+    if (!mat_V || !mat_T || !z || !y || !sigma)
+        goto cleanup;
+
+    double* restrict V = mat_V->data;
+    double* restrict T = mat_T->data;
+    size_t const ldv = mat_V->ld;
+    size_t const ldt = mat_T->ld;
+    size_t const inc_q = vector_view_inc(matrix_col(mat_Q, 0));
+    memcpy(z, x, n * sizeof(double));
+
+    for (size_t k = 0; k < deg_m && k < n; ++k) {
+        if (k > 0) {
+            // z = P_k-1 ... P_0 A q_k-1 = (I - V T^T V^T) A q_k-1
+            vector_view_t q_k = matrix_col(mat_Q, k - 1);
+            matvec(n, A, view_ptr(q_k), vector_view_inc(q_k), z);
+            cblas_dgemv(CblasColMajor, CblasTrans, n, k, 1.0, V, ldv, z, 1, 0.0, y, 1);
+            cblas_dtrmv(CblasColMajor, CblasUpper, CblasTrans, CblasNonUnit, k, T, ldt, y, 1);
+            cblas_dgemv(CblasColMajor, CblasNoTrans, n, k, -1.0, V, ldv, y, 1, 1.0, z, 1);
+            for (size_t j = 0; j < k; ++j) {
+                H[j * ldh + k - 1] = sigma[j] * z[j];
+            }
+        }
+
+        // New reflector, zeroing z below row `k`
+        double tau;
+        double const beta = householder_vector(n - k, z + k, V + k * ldv + k, &tau);
+        sigma[k] = beta < 0.0 ? -1.0 : 1.0;
+        if (k > 0) {
+            H[k * ldh + k - 1] = fabs(beta);
+            if (fabs(beta) <= epsilon)
+                goto cleanup;
+        }
+
+        // T = [T, -tau T V^T v_k; 0, tau], V^T v_k only involving rows k..n-1
+        cblas_dgemv(CblasColMajor, CblasTrans, n - k, k, 1.0, V + k, ldv, V + k * ldv + k, 1, 0.0,
+                    y, 1);
+        cblas_dtrmv(CblasColMajor, CblasUpper, CblasNoTrans, CblasNonUnit, k, T, ldt, y, 1);
         for (size_t j = 0; j < k; ++j) {
-            // Initialize Q[:,j] slice
-            #pragma omp simd
-            for (size_t _ = 0; _ < mat_Q->rows; ++_) {
-                q_j_T[_] = Q[_][j];
+            T[k * ldt + j] = -tau * y[j];
+        }
+        T[k * ldt + k] = tau;
+
+        // q_k = sigma_k (e_k - V T V^T e_k), where V^T e_k is row k of V
+        for (size_t j = 0; j <= k; ++j) {
+            y[j] = V[j * ldv + k];
+        }
+        cblas_dtrmv(CblasColMajor, CblasUpper, CblasNoTrans, CblasNonUnit, k + 1, T, ldt, y, 1);
+        double* restrict q = view_ptr(matrix_col(mat_Q, k));
+        cblas_dgemv(CblasColMajor, CblasNoTrans, n, k + 1, -sigma[k], V, ldv, y, 1, 0.0, q,
+                    inc_q);
+        q[k * inc_q] += sigma[k];
+    }
+
+cleanup:
+    arena_reset(arena, mark);
+    arena_deinit(tmp_ws);
+}
+
+void householder_arnoldi(size_t n, double* restrict x, matrix_t const* mat_A, size_t deg_m,
+                         matrix_t* mat_Q, matrix_t* mat_H, arena_t* ws)
+{
+    operator_t op = operator_from_matrix(mat_A);
+    op.n = n;
+    householder_arnoldi_op(x, &op, deg_m, mat_Q, mat_H, ws);
+}
+
+void householder_arnoldi_sparse(size_t n, double* restrict x, sparse_t const* A, size_t deg_m,
+                                matrix_t* mat_Q, matrix_t* mat_H, arena_t* ws)
+{
+    operator_t op = operator_from_sparse(A);
+    op.n = n;
+    householder_arnoldi_op(x, &op, deg_m, mat_Q, mat_H, ws);
+}
+
+void householder_arnoldi_op(double* restrict x, operator_t const* A, size_t deg_m,
+                            matrix_t* mat_Q, matrix_t* mat_H, arena_t* ws)
+{
+    householder(A->n, x, A->apply, A->ctx, deg_m, mat_Q, mat_H, ws);
+}
+
+size_t parallel_gram_schmidt2_workspace(size_t n, size_t deg_m)
+{
+    return 2 * arena_matrix_size(n, 1) + arena_matrix_size(4 * deg_m + 2, 1);
+}
+
+/**
+ * Orphaned worksharing phases of `parallel_classical_gram_schmidt2`, called
+ * by every thread of its parallel region. They all split the rows in the
+ * same `gs_block_rows` blocks with a static schedule, so a thread always
+ * owns the same rows of every vector.
+ **/
+
+// One block of rows per thread, rounded up to whole cache lines so that no
+// two threads write to the same line of a vector
+static size_t gs_block_rows(size_t n)
+{
+    size_t const nb_threads = (size_t)(omp_get_num_threads());
+    size_t const rows = (n + nb_threads - 1) / nb_threads;
+    return (rows + GS_LINE_ROWS - 1) / GS_LINE_ROWS * GS_LINE_ROWS;
+}
+
+// w = A v / beta and Q[:,k] = v / beta, for the rows of the thread. The next
+// phase only reads the rows of the thread, no barrier needed
+static void omp_matvec_normalize(size_t n, matrix_t const* mat_A, double const* v, double beta,
+                                 double* w, double* q, size_t inc_q)
+{
+    size_t const block_rows = gs_block_rows(n);
+    size_t const nb_blocks = (n + block_rows - 1) / block_rows;
+    double const* A = mat_A->data;
+    size_t const lda = mat_A->ld;
+
+#pragma omp for schedule(static) nowait
+    for (size_t b = 0; b < nb_blocks; ++b) {
+        size_t const first = b * block_rows;
+        size_t const last = first + block_rows < n ? first + block_rows : n;
+        if (mat_A->layout == ROW_MAJOR) {
+            for (size_t i = first; i < last; ++i) {
+                double acc = 0.0;
+                for (size_t j = 0; j < n; ++j) {
+                    acc += A[i * lda + j] * v[j];
+                }
+                w[i] = acc / beta;
             }
-            // h_j_k-1 = v_k+1 * v_k
-            H[j][k - 1] = ddot(mat_Q->rows, q_j_T, v);
         }
+        else {
+            for (size_t i = first; i < last; ++i) {
+                w[i] = 0.0;
+            }
+            for (size_t j = 0; j < n; ++j) {
+                double const v_j = v[j] / beta;
+#pragma omp simd
+                for (size_t i = first; i < last; ++i) {
+                    w[i] += A[j * lda + i] * v_j;
+                }
+            }
+        }
+        for (size_t i = first; i < last; ++i) {
+            q[i * inc_q] = v[i] / beta;
+        }
+    }
+}
+
+// h += Q[:,0..k-1]^T w, `h` being shared and zeroed beforehand
+static void omp_project(size_t n, size_t k, matrix_t const* mat_Q, double const* w, double* h)
+{
+    size_t const block_rows = gs_block_rows(n);
+    size_t const nb_blocks = (n + block_rows - 1) / block_rows;
+    vector_view_t const q_0 = matrix_col(mat_Q, 0);
+    size_t const inc_q = vector_view_inc(q_0);
 
+#pragma omp for schedule(static) reduction(+ : h[:k])
+    for (size_t b = 0; b < nb_blocks; ++b) {
+        size_t const first = b * block_rows;
+        size_t const last = first + block_rows < n ? first + block_rows : n;
         for (size_t j = 0; j < k; ++j) {
-            // Initialize Q[:,j] slice
-            #pragma omp simd
-            for (size_t _ = 0; _ < mat_Q->rows; ++_) {
-                q_j_T[_] = Q[_][j];
+            double const* q_j = view_ptr(matrix_col(mat_Q, j));
+            double acc = 0.0;
+            for (size_t i = first; i < last; ++i) {
+                acc += q_j[i * inc_q] * w[i];
             }
-            // v_k+1 -= h_j_k-1 * v_k
-            daxpy(n, -H[j][k - 1], q_j_T, v);
+            h[j] += acc;
         }
+    }
+}
 
-        H[k][k - 1] = dnrm2(n, v);
-        if (H[k][k - 1] > epsilon) {
-            #pragma omp simd
-            for (size_t _ = 0; _ < n; ++_) {
-                Q[_][k] = v[_] / H[k][k - 1];
+// w -= Q[:,0..k-1] h, also accumulating ||w||^2 into `nrm2` if it is not NULL
+static void omp_update(size_t n, size_t k, matrix_t const* mat_Q, double const* h, double* w,
+                       double* nrm2)
+{
+    size_t const block_rows = gs_block_rows(n);
+    size_t const nb_blocks = (n + block_rows - 1) / block_rows;
+    vector_view_t const q_0 = matrix_col(mat_Q, 0);
+    size_t const inc_q = vector_view_inc(q_0);
+
+    if (nrm2) {
+#pragma omp for schedule(static) reduction(+ : nrm2[:1])
+        for (size_t b = 0; b < nb_blocks; ++b) {
+            size_t const first = b * block_rows;
+            size_t const last = first + block_rows < n ? first + block_rows : n;
+            for (size_t j = 0; j < k; ++j) {
+                double const* q_j = view_ptr(matrix_col(mat_Q, j));
+                for (size_t i = first; i < last; ++i) {
+                    w[i] -= h[j] * q_j[i * inc_q];
+                }
+            }
+            for (size_t i = first; i < last; ++i) {
+                nrm2[0] += w[i] * w[i];
+            }
+        }
+    }
+    else {
+        // The next phase only reads the rows of the thread, no barrier needed
+#pragma omp for schedule(static) nowait
+        for (size_t b = 0; b < nb_blocks; ++b) {
+            size_t const first = b * block_rows;
+            size_t const last = first + block_rows < n ? first + block_rows : n;
+            for (size_t j = 0; j < k; ++j) {
+                double const* q_j = view_ptr(matrix_col(mat_Q, j));
+                for (size_t i = first; i < last; ++i) {
+                    w[i] -= h[j] * q_j[i * inc_q];
+                }
+            }
+        }
+    }
+}
+
+void parallel_classical_gram_schmidt2(size_t n, double* restrict x, matrix_t const* mat_A,
+                                      size_t deg_m, matrix_t* mat_Q, matrix_t* mat_H, arena_t* ws)
+{
+    double const epsilon = GRAM_SCHMIDT_EPSILON;
+    double* restrict H = mat_H->data;
+    size_t const ldh = mat_H->ld;
+    arena_t* tmp_ws = ws ? NULL : arena_init(parallel_gram_schmidt2_workspace(n, deg_m));
+    arena_t* arena = ws ? ws : tmp_ws;
+    if (!arena)
+        return;
+    size_t const mark = arena_mark(arena);
+    double* buf[2] = { arena_alloc(arena, n * sizeof(double)),
+                       arena_alloc(arena, n * sizeof(double)) };
+    // Projections of both passes and squared norm, one set per parity of `k`
+    double* acc = arena_alloc(arena, (4 * deg_m + 2) * sizeof(double));
+    if (!buf[0] || !buf[1] || !acc)
+        goto cleanup;
+    memset(acc, 0, (4 * deg_m + 2) * sizeof(double));
+
+    double* h1[2] = { acc, acc + deg_m };
+    double* h2[2] = { acc + 2 * deg_m, acc + 3 * deg_m };
+    double* nrm2[2] = { acc + 4 * deg_m, acc + 4 * deg_m + 1 };
+    size_t const inc_q = vector_view_inc(matrix_col(mat_Q, 0));
+
+    double* x_nrm2 = nrm2[0];
+
+    // Each step costs three barriers, after each projection and after the
+    // norm. Normalizing `q_k` is folded into the next matvec.
+#pragma omp parallel
+    {
+#pragma omp for schedule(static) reduction(+ : x_nrm2[:1])
+        for (size_t i = 0; i < n; ++i) {
+            x_nrm2[0] += x[i] * x[i];
+        }
+        double beta = sqrt(x_nrm2[0]);
+        double const* v = x;
+
+        size_t k = 1;
+        for (; k < deg_m; ++k) {
+            size_t const p = k % 2;
+            double* w = buf[p];
+            omp_matvec_normalize(n, mat_A, v, beta, w, view_ptr(matrix_col(mat_Q, k - 1)), inc_q);
+            omp_project(n, k, mat_Q, w, h1[p]);
+
+            // Past this barrier, nobody reads the buffers of the previous step
+#pragma omp single nowait
+            {
+                memset(h1[1 - p], 0, deg_m * sizeof(double));
+                memset(h2[1 - p], 0, deg_m * sizeof(double));
+                nrm2[1 - p][0] = 0.0;
+            }
+
+            omp_update(n, k, mat_Q, h1[p], w, NULL);
+            omp_project(n, k, mat_Q, w, h2[p]);
+            omp_update(n, k, mat_Q, h2[p], w, nrm2[p]);
+
+            beta = sqrt(nrm2[p][0]);
+#pragma omp single nowait
+            {
+                for (size_t j = 0; j < k; ++j) {
+                    H[j * ldh + k - 1] = h1[p][j] + h2[p][j];
+                }
+                H[k * ldh + k - 1] = beta;
+            }
+            if (beta <= epsilon)
+                break;
+            v = w;
+        }
+
+        if (k == deg_m) {
+            double* q = view_ptr(matrix_col(mat_Q, k - 1));
+#pragma omp for schedule(static)
+            for (size_t i = 0; i < n; ++i) {
+                q[i * inc_q] = v[i] / beta;
+            }
+        }
+    }
+
+cleanup:
+    arena_reset(arena, mark);
+    arena_deinit(tmp_ws);
+}
+
+double orthogonality_loss(matrix_t const* mat_Q, size_t k)
+{
+    double* G = malloc(k * k * sizeof(double));
+    if (!G)
+        return NAN;
+    CBLAS_ORDER const order = mat_Q->layout == ROW_MAJOR ? CblasRowMajor : CblasColMajor;
+    cblas_dgemm(order, CblasTrans, CblasNoTrans, k, k, mat_Q->rows, 1.0, mat_Q->data, mat_Q->ld,
+                mat_Q->data, mat_Q->ld, 0.0, G, k);
+
+    double sum = 0.0;
+    for (size_t i = 0; i < k; ++i) {
+        G[i * k + i] -= 1.0;
+        for (size_t j = 0; j < k; ++j) {
+            sum += G[i * k + j] * G[i * k + j];
+        }
+    }
+    free(G);
+    return sqrt(sum);
+}
+
+char const* s_step_basis_to_str(s_step_basis_t basis)
+{
+    switch (basis) {
+        case S_STEP_MONOMIAL:
+            return "monomial";
+        case S_STEP_NEWTON:
+            return "newton";
+        default:
+            return "unknown";
+    }
+}
+
+size_t s_step_workspace(size_t n, size_t deg_m, size_t s)
+{
+    return arena_matrix_size(n, 1) + s * (s + 1) * sizeof(double) +
+           2 * s * sizeof(double complex) + 2 * deg_m * s * sizeof(double) +
+           s * s * sizeof(double) + deg_m * (s + 1) * sizeof(double) +
+           (s + 1) * s * sizeof(double) + deg_m * s * sizeof(double) + 10 * ALIGNMENT +
+           tsqr_workspace(n, s);
+}
+
+/**
+ * Shifts and scaling of the s-step Krylov basis, from the Ritz values `w`
+ * of the first block. The Newton basis uses them in Leja order and the
+ * geometric mean of their distances as scaling, the monomial basis no
+ * shift and their largest modulus.
+ **/
+static double s_step_shifts(size_t s, s_step_basis_t basis, double complex const* w,
+                            double complex* shifts)
+{
+    double sigma = 0.0;
+    if (basis == S_STEP_NEWTON) {
+        eigvals_leja_order(s, w, shifts);
+        double log_sum = 0.0;
+        size_t count = 0;
+        for (size_t i = 0; i < s; ++i) {
+            for (size_t j = 0; j < i; ++j) {
+                double const d = cabs(shifts[i] - shifts[j]);
+                if (d > 0.0) {
+                    log_sum += log(d);
+                    count += 1;
+                }
             }
-        } else {
+        }
+        sigma = count > 0 ? exp(log_sum / (double)(count)) : 0.0;
+    }
+    else {
+        for (size_t i = 0; i < s; ++i) {
+            shifts[i] = 0.0;
+            sigma = cabs(w[i]) > sigma ? cabs(w[i]) : sigma;
+        }
+    }
+    return sigma > 0.0 ? sigma : 1.0;
+}
+
+/**
+ * s-step Arnoldi. The first `s` steps are the ones of `modified_gram_schmidt`
+ * and their Ritz values give the shifts and scaling of the basis. Each next
+ * block then costs `s` matvecs without any reduction, generating
+ * `A V_s = V_s+1 B`, two block CGS passes against the basis (dgemm) and one
+ * TSQR of the block. The new columns of `H` follow from the change of basis
+ * `H = (R B - H_old R_top) R_bot^-1`.
+ **/
+static void s_step(size_t n, double* restrict x, operator_fn matvec, void const* A, size_t deg_m,
+                   size_t s, s_step_basis_t basis, matrix_t* mat_Q, matrix_t* mat_H, arena_t* ws)
+{
+    assert(mat_Q->layout == COL_MAJOR && s > 0);
+    double const epsilon = GRAM_SCHMIDT_EPSILON;
+    double* restrict H = mat_H->data;
+    size_t const ldh = mat_H->ld;
+    double* restrict Q = mat_Q->data;
+    size_t const ldq = mat_Q->ld;
+    arena_t* tmp_ws = ws ? NULL : arena_init(s_step_workspace(n, deg_m, s));
+    arena_t* arena = ws ? ws : tmp_ws;
+    if (!arena)
+        return;
+    size_t const mark = arena_mark(arena);
+    double* v = arena_alloc(arena, n * sizeof(double));
+    double* hqr_work = arena_alloc(arena, s * (s + 1) * sizeof(double));
+    double complex* w = arena_alloc(arena, s * sizeof(double complex));
+    double complex* shifts = arena_alloc(arena, s * sizeof(double complex));
+    // Projections on the basis, column-major `deg_m * s`
+    double* C = arena_alloc(arena, deg_m * s * sizeof(double));
+    double* C2 = arena_alloc(arena, deg_m * s * sizeof(double));
+    // Row-major `R_22` (`s * s`), `R` (`deg_m * (s + 1)`), `B` and `R B`
+    double* R22 = arena_alloc(arena, s * s * sizeof(double));
+    double* R = arena_alloc(arena, deg_m * (s + 1) * sizeof(double));
+    double* B = arena_alloc(arena, (s + 1) * s * sizeof(double));
+    double* M = arena_alloc(arena, deg_m * s * sizeof(double));
+    if (!v || !hqr_work || !w || !shifts || !C || !C2 || !R22 || !R || !B || !M)
+        goto cleanup;
+
+    double const x_nrm = cblas_dnrm2(n, x, 1);
+    for (size_t i = 0; i < n; ++i) {
+        Q[i] = x[i] / x_nrm;
+    }
+
+    // First block, with one reduction per vector
+    size_t const s_first = s < deg_m - 1 ? s : deg_m - 1;
+    if (mgs_extend(n, matvec, A, 1, s_first + 1, mat_Q, mat_H, v) < s_first + 1)
+        goto cleanup;
+    size_t k = s_first;
+    if (k + 1 >= deg_m)
+        goto cleanup;
+
+    double sigma = 1.0;
+    if (hessenberg_eigvals(s, H, ldh, w, hqr_work) == 0) {
+        sigma = s_step_shifts(s, basis, w, shifts);
+    }
+    else {
+        memset(shifts, 0, s * sizeof(double complex));
+    }
+
+    while (k + 1 < deg_m) {
+        size_t const sb = s < deg_m - 1 - k ? s : deg_m - 1 - k;
+        double* V = Q + (k + 1) * ldq;
+
+        // Matrix powers: v_j+1 = ((A - a_j) v_j + gamma_j v_j-1) / sigma
+        memset(B, 0, (s + 1) * s * sizeof(double));
+        for (size_t j = 0; j < sb; ++j) {
+            double const* v_j = Q + (k + j) * ldq;
+            double* v_next = Q + (k + j + 1) * ldq;
+            matvec(n, A, v_j, 1, v_next);
+            double const a = creal(shifts[j]);
+            cblas_daxpy(n, -a, v_j, 1, v_next, 1);
+            B[j * s + j] = a;
+            // Second shift of a conjugate pair, applied as a real double shift
+            if (j > 0 && cimag(shifts[j]) < 0.0 && cimag(shifts[j - 1]) > 0.0) {
+                double const gamma = cimag(shifts[j]) * cimag(shifts[j]) / sigma;
+                cblas_daxpy(n, gamma, Q + (k + j - 1) * ldq, 1, v_next, 1);
+                B[(j - 1) * s + j] = -gamma;
+            }
+            cblas_dscal(n, 1.0 / sigma, v_next, 1);
+            B[(j + 1) * s + j] = sigma;
+        }
+
+        // Block CGS2 against Q[:,0..k], then TSQR of the block
+        size_t const kk = k + 1;
+        cblas_dgemm(CblasColMajor, CblasTrans, CblasNoTrans, kk, sb, n, 1.0, Q, ldq, V, ldq, 0.0,
+                    C, deg_m);
+        cblas_dgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, n, sb, kk, -1.0, Q, ldq, C, deg_m,
+                    1.0, V, ldq);
+        cblas_dgemm(CblasColMajor, CblasTrans, CblasNoTrans, kk, sb, n, 1.0, Q, ldq, V, ldq, 0.0,
+                    C2, deg_m);
+        cblas_dgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, n, sb, kk, -1.0, Q, ldq, C2, deg_m,
+                    1.0, V, ldq);
+        for (size_t j = 0; j < sb; ++j) {
+            cblas_daxpy(kk, 1.0, C2 + j * deg_m, 1, C + j * deg_m, 1);
+        }
+        if (tsqr(n, sb, V, ldq, R22, s, arena) != 0)
             goto cleanup;
+        for (size_t j = 0; j < sb; ++j) {
+            if (R22[j * s + j] <= epsilon)
+                goto cleanup;
         }
+
+        // V_sb+1 = Q[:,0..k+sb] R, with v_0 = q_k
+        memset(R, 0, (k + sb + 1) * (s + 1) * sizeof(double));
+        R[k * (s + 1)] = 1.0;
+        for (size_t j = 1; j <= sb; ++j) {
+            for (size_t i = 0; i <= k; ++i) {
+                R[i * (s + 1) + j] = C[(j - 1) * deg_m + i];
+            }
+            for (size_t i = 0; i < sb; ++i) {
+                R[(k + 1 + i) * (s + 1) + j] = R22[i * s + (j - 1)];
+            }
+        }
+
+        // A Q[:,k..k+sb-1] R_bot = Q[:,0..k+sb] (R B) - Q[:,0..k] H_old R_top
+        size_t const rows = k + sb + 1;
+        cblas_dgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, rows, sb, sb + 1, 1.0, R, s + 1, B,
+                    s, 0.0, M, s);
+        cblas_dgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, k + 1, sb, k, -1.0, H, ldh, R,
+                    s + 1, 1.0, M, s);
+        cblas_dtrsm(CblasRowMajor, CblasRight, CblasUpper, CblasNoTrans, CblasNonUnit, rows, sb,
+                    1.0, R + k * (s + 1), s + 1, M, s);
+        for (size_t i = 0; i < rows; ++i) {
+            for (size_t j = 0; j < sb; ++j) {
+                H[i * ldh + k + j] = i <= k + j + 1 ? M[i * s + j] : 0.0;
+            }
+        }
+        k += sb;
     }
 
 cleanup:
-    free(q_k);
-    free(v);
-    free(q_j_T);
+    arena_reset(arena, mark);
+    arena_deinit(tmp_ws);
 }
 
-void modified_gram_schmidt(size_t n, double* restrict x, double* restrict A,
-                           size_t deg_m, matrix_t* mat_Q, matrix_t* mat_H)
+void s_step_gram_schmidt(size_t n, double* restrict x, matrix_t const* mat_A, size_t deg_m,
+                         size_t s, s_step_basis_t basis, matrix_t* mat_Q, matrix_t* mat_H,
+                         arena_t* ws)
 {
-    double epsilon = 1e-12;
-    double (* restrict H)[deg_m] = (double (*)[mat_H->cols])mat_H->data;
-    double (* restrict Q)[deg_m] = (double (*)[mat_Q->cols])mat_Q->data;
-    double* q_k = aligned_alloc(64, mat_Q->rows * sizeof(double));
-    if (!q_k) return;
-    double* v = aligned_alloc(64, n * sizeof(double));
-    if (!v) return;
-    double* q_j_T = aligned_alloc(64, mat_Q->rows * sizeof(double));
-    if (!q_j_T) return;
+    operator_t op = operator_from_matrix(mat_A);
+    op.n = n;
+    s_step_gram_schmidt_op(x, &op, deg_m, s, basis, mat_Q, mat_H, ws);
+}
 
-    #pragma omp simd
-    for (size_t _ = 0; _ < n; ++_) {
-        Q[_][0] = x[_] / cblas_dnrm2(n, x, 1);
+void s_step_gram_schmidt_op(double* restrict x, operator_t const* A, size_t deg_m, size_t s,
+                            s_step_basis_t basis, matrix_t* mat_Q, matrix_t* mat_H, arena_t* ws)
+{
+    s_step(A->n, x, A->apply, A->ctx, deg_m, s, basis, mat_Q, mat_H, ws);
+}
+
+size_t block_arnoldi_workspace(size_t n, size_t deg_m, size_t b)
+{
+    return 2 * deg_m * b * sizeof(double) + b * b * sizeof(double) + 3 * ALIGNMENT +
+           tsqr_workspace(n, b);
+}
+
+/**
+ * Computes `Y = A * X` for the column-major `n * b` blocks `X` and `Y`.
+ **/
+typedef void (*block_operator_fn)(size_t n, void const* A, size_t b, double const* X, size_t ldx,
+                                  double* Y, size_t ldy);
+
+static void dense_block_apply(size_t n, void const* A, size_t b, double const* X, size_t ldx,
+                              double* Y, size_t ldy)
+{
+    matrix_t const* mat_A = A;
+    CBLAS_TRANSPOSE const trans = mat_A->layout == ROW_MAJOR ? CblasTrans : CblasNoTrans;
+    cblas_dgemm(CblasColMajor, trans, CblasNoTrans, n, b, n, 1.0, mat_A->data, mat_A->ld, X, ldx,
+                0.0, Y, ldy);
+}
+
+static void sparse_block_apply(size_t n, void const* A, size_t b, double const* X, size_t ldx,
+                               double* Y, size_t ldy)
+{
+    (void)n;
+    sparse_spmm(1.0, A, X, ldx, b, 0.0, Y, ldy);
+}
+
+// Matrix-free operators only know `A * x`, so `A` is applied once per column
+static void op_block_apply(size_t n, void const* A, size_t b, double const* X, size_t ldx,
+                           double* Y, size_t ldy)
+{
+    operator_t const* op = A;
+    for (size_t j = 0; j < b; ++j) {
+        op->apply(n, op->ctx, X + j * ldx, 1, Y + j * ldy);
     }
+}
 
-    for (size_t k = 1; k < deg_m; ++k) {
-        // Initialize Q[:,k-1] slice
-        #pragma omp simd
-        for (size_t _ = 0; _ < mat_Q->rows; ++_) {
-            q_k[_] = Q[_][k - 1];
+/**
+ * Block Arnoldi. The first block is the TSQR of `X`, then each step applies
+ * `A` to the last block at once (dgemm or SpMM), orthogonalizes the result
+ * with two passes of block CGS against the whole basis (dgemm) and factors
+ * it with a TSQR, whose `R` is the subdiagonal block of `H`.
+ **/
+static size_t block_arnoldi_run(size_t n, size_t b, matrix_t const* mat_X, block_operator_fn apply,
+                                void const* A, size_t deg_m, matrix_t* mat_Q, matrix_t* mat_H,
+                                arena_t* ws)
+{
+    assert(mat_Q->layout == COL_MAJOR && mat_X->layout == COL_MAJOR);
+    assert(b > 0 && deg_m % b == 0);
+    double const epsilon = GRAM_SCHMIDT_EPSILON;
+    double* restrict H = mat_H->data;
+    size_t const ldh = mat_H->ld;
+    double* restrict Q = mat_Q->data;
+    size_t const ldq = mat_Q->ld;
+    arena_t* tmp_ws = ws ? NULL : arena_init(block_arnoldi_workspace(n, deg_m, b));
+    arena_t* arena = ws ? ws : tmp_ws;
+    if (!arena)
+        return 0;
+    size_t const mark = arena_mark(arena);
+    size_t k = 0;
+    // Projections on the basis, column-major `deg_m * b`
+    double* C = arena_alloc(arena, deg_m * b * sizeof(double));
+    double* C2 = arena_alloc(arena, deg_m * b * sizeof(double));
+    double* R0 = arena_alloc(arena, b * b * sizeof(double));
+    if (!C || !C2 || !R0)
+        goto cleanup;
+
+    for (size_t j = 0; j < b; ++j) {
+        memcpy(Q + j * ldq, mat_X->data + j * mat_X->ld, n * sizeof(double));
+    }
+    if (tsqr(n, b, Q, ldq, R0, b, arena) != 0)
+        goto cleanup;
+    for (size_t j = 0; j < b; ++j) {
+        if (R0[j * b + j] <= epsilon)
+            goto cleanup;
+    }
+    k = b;
+
+    while (k < deg_m) {
+        double* V = Q + k * ldq;
+        apply(n, A, b, Q + (k - b) * ldq, ldq, V, ldq);
+
+        // Block CGS2 against Q[:,0..k-1], then TSQR of the block
+        cblas_dgemm(CblasColMajor, CblasTrans, CblasNoTrans, k, b, n, 1.0, Q, ldq, V, ldq, 0.0, C,
+                    deg_m);
+        cblas_dgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, n, b, k, -1.0, Q, ldq, C, deg_m,
+                    1.0, V, ldq);
+        cblas_dgemm(CblasColMajor, CblasTrans, CblasNoTrans, k, b, n, 1.0, Q, ldq, V, ldq, 0.0, C2,
+                    deg_m);
+        cblas_dgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, n, b, k, -1.0, Q, ldq, C2, deg_m,
+                    1.0, V, ldq);
+        for (size_t i = 0; i < k; ++i) {
+            for (size_t j = 0; j < b; ++j) {
+                H[i * ldh + k - b + j] = C[j * deg_m + i] + C2[j * deg_m + i];
+            }
         }
-        // Candidate vector
-        cblas_dgemv(CblasRowMajor, CblasNoTrans, n, n, 1.0, A, n, q_k, 1, 0.0, v, 1);
+        if (tsqr(n, b, V, ldq, H + k * ldh + k - b, ldh, arena) != 0)
+            goto cleanup;
+        for (size_t j = 0; j < b; ++j) {
+            if (H[(k + j) * ldh + k - b + j] <= epsilon)
+                goto cleanup;
+        }
+        k += b;
+    }
 
-        for (size_t j = 0; j < k; ++j) {
-            // Initialize Q[:,j] slice (transposed but it's a vector so who fucking cares)
-            #pragma omp simd
-            for (size_t _ = 0; _ < mat_Q->rows; ++_) {
-                q_j_T[_] = Q[_][j];
+cleanup:
+    arena_reset(arena, mark);
+    arena_deinit(tmp_ws);
+    return k;
+}
+
+size_t block_arnoldi(size_t n, size_t b, matrix_t const* mat_X, matrix_t const* mat_A,
+                     size_t deg_m, matrix_t* mat_Q, matrix_t* mat_H, arena_t* ws)
+{
+    return block_arnoldi_run(n, b, mat_X, dense_block_apply, mat_A, deg_m, mat_Q, mat_H, ws);
+}
+
+size_t block_arnoldi_sparse(size_t n, size_t b, matrix_t const* mat_X, sparse_t const* A,
+                            size_t deg_m, matrix_t* mat_Q, matrix_t* mat_H, arena_t* ws)
+{
+    return block_arnoldi_run(n, b, mat_X, sparse_block_apply, A, deg_m, mat_Q, mat_H, ws);
+}
+
+size_t block_arnoldi_op(size_t b, matrix_t const* mat_X, operator_t const* A, size_t deg_m,
+                        matrix_t* mat_Q, matrix_t* mat_H, arena_t* ws)
+{
+    return block_arnoldi_run(A->n, b, mat_X, op_block_apply, A, deg_m, mat_Q, mat_H, ws);
+}
+
+/**
+ * Scratch memory shared by `eram` and `iram`.
+ **/
+typedef struct ritz_ws_s {
+    matrix_t* mat_Q;
+    matrix_t* mat_H;
+    double* hqr_work;
+    double complex* vec_work;
+    double complex* Y;
+    double complex* w;
+    size_t* idx;
+    double* residuals;
+} ritz_ws_t;
+
+/**
+ * Size in bytes of a `ritz_ws_t` for an operator of order `n`, `s` wanted
+ * pairs and a subspace of size `m`, allocations rounded up included.
+ **/
+static size_t ritz_ws_size(size_t n, size_t s, size_t m)
+{
+    return arena_matrix_size(n, m + 1) + arena_matrix_size(m + 1, m) +
+           m * (m + 1) * sizeof(double) + m * m * sizeof(double complex) +
+           s * m * sizeof(double complex) + m * (sizeof(double complex) + sizeof(size_t)) +
+           s * sizeof(double) + 8 * ALIGNMENT;
+}
+
+static bool ritz_ws_init(ritz_ws_t* self, arena_t* arena, size_t n, size_t s, size_t m)
+{
+    // Column-major so that each basis vector is contiguous
+    self->mat_Q = arena_matrix(arena, n, m + 1, COL_MAJOR);
+    self->mat_H = arena_matrix(arena, m + 1, m, ROW_MAJOR);
+    self->hqr_work = arena_alloc(arena, m * (m + 1) * sizeof(double));
+    self->vec_work = arena_alloc(arena, m * m * sizeof(double complex));
+    // Eigenvectors of `H` for the wanted Ritz values, one per row
+    self->Y = arena_alloc(arena, s * m * sizeof(double complex));
+    self->w = arena_alloc(arena, m * sizeof(double complex));
+    self->idx = arena_alloc(arena, m * sizeof(size_t));
+    self->residuals = arena_alloc(arena, s * sizeof(double));
+    return self->mat_Q && self->mat_H && self->hqr_work && self->vec_work && self->Y && self->w &&
+           self->idx && self->residuals;
+}
+
+/**
+ * Returns the number of basis vectors left by an Arnoldi factorization of
+ * size `m` in `H`: `m` unless it broke down, in which case they span an
+ * invariant subspace.
+ **/
+static size_t arnoldi_size(matrix_t const* mat_H, size_t m)
+{
+    for (size_t k = 1; k <= m; ++k) {
+        if (mat_H->data[matrix_index(mat_H, k, k - 1)] <= GRAM_SCHMIDT_EPSILON)
+            return k;
+    }
+    return m;
+}
+
+/**
+ * Extracts the Ritz pairs of the leading `m * m` block of `H`, with
+ * `beta = h_m+1,m`. All the Ritz values are left in `w`, sorted by
+ * decreasing modulus through `idx`, and the `s` wanted ones are copied to
+ * `ritz_values`, along with their eigenvectors in `Y` and their relative
+ * residuals. Returns -1 if the eigenvalues could not be computed.
+ **/
+static int ritz_pairs(ritz_ws_t* ws, size_t m, size_t s, double beta, double tol,
+                      double complex* ritz_values, arnoldi_info_t* stats)
+{
+    matrix_t const* mat_H = ws->mat_H;
+    if (hessenberg_eigvals(m, mat_H->data, mat_H->ld, ws->w, ws->hqr_work) != 0)
+        return -1;
+    eigvals_sort_by_modulus(m, ws->w, ws->idx);
+
+    // Floor of `|theta|` in the relative residuals, for a singular `H`
+    double h_nrm = 0.0;
+    for (size_t i = 0; i < m; ++i) {
+        for (size_t j = 0; j < m; ++j) {
+            double const h = mat_H->data[i * mat_H->ld + j];
+            h_nrm += h * h;
+        }
+    }
+    double const theta_min = DBL_EPSILON * sqrt(h_nrm);
+
+    stats->nb_converged = 0;
+    stats->max_residual = 0.0;
+    for (size_t i = 0; i < s; ++i) {
+        double complex* y = ws->Y + i * mat_H->cols;
+        double complex const theta = ws->w[ws->idx[i]];
+        hessenberg_eigvec(m, mat_H->data, mat_H->ld, theta, y, ws->vec_work);
+
+        // Rotate `y` so that its largest component is real, which keeps the
+        // real part of the Ritz vector away from zero
+        size_t jmax = 0;
+        for (size_t j = 1; j < m; ++j) {
+            jmax = cabs(y[j]) > cabs(y[jmax]) ? j : jmax;
+        }
+        double complex const phase = conj(y[jmax]) / cabs(y[jmax]);
+        for (size_t j = 0; j < m; ++j) {
+            y[j] *= phase;
+        }
+
+        // ||A u - theta u|| = |h_m+1,m| |e_m^T y| for a unit `y`
+        double const scale = fmax(cabs(theta), theta_min);
+        double const res = fabs(beta) * cabs(y[m - 1]) / (scale > 0.0 ? scale : 1.0);
+        ws->residuals[i] = res;
+        ritz_values[i] = theta;
+        stats->max_residual = res > stats->max_residual ? res : stats->max_residual;
+        stats->nb_converged += res <= tol;
+    }
+    return 0;
+}
+
+/**
+ * Writes the `s_eff` Ritz vectors `u_i = Q_m y_i` to `ritz_vectors` and
+ * zeroes the remaining ones, up to `s`.
+ **/
+static void ritz_vectors_from_basis(ritz_ws_t const* ws, size_t n, size_t m, size_t s_eff,
+                                    size_t s, double complex* ritz_vectors)
+{
+    matrix_t const* mat_Q = ws->mat_Q;
+    memset(ritz_vectors, 0, n * s * sizeof(double complex));
+    for (size_t i = 0; i < s_eff; ++i) {
+        double complex* restrict u = ritz_vectors + i * n;
+        for (size_t j = 0; j < m; ++j) {
+            double const* restrict q = mat_Q->data + j * mat_Q->ld;
+            double complex const y_j = ws->Y[i * ws->mat_H->cols + j];
+            for (size_t k = 0; k < n; ++k) {
+                u[k] += y_j * q[k];
             }
+        }
+    }
+}
+
+/**
+ * Operator `(I - V V^T) A` of ERAM once the `k` orthonormal columns of `V`,
+ * which span the converged invariant subspace, are locked. A basis orthogonal
+ * to `V` then only sees the eigenvalues of `A` that are not locked yet.
+ **/
+typedef struct eram_deflated_s {
+    operator_fn matvec;
+    void const* A;
+    matrix_t const* mat_V;
+    size_t k;
+    double* h;
+} eram_deflated_t;
+
+/**
+ * Removes from `y` its components along the `k` first columns of `V`, with a
+ * second pass to make up for the cancellation of the first.
+ **/
+static void eram_deflate(size_t n, matrix_t const* mat_V, size_t k, double* h, double* y)
+{
+    for (size_t pass = 0; k > 0 && pass < 2; ++pass) {
+        dgemv_strided(k, n, 1.0, mat_V->data, mat_V->ld, 1, y, 1, 0.0, h, 1);
+        dgemv_strided(n, k, -1.0, mat_V->data, 1, mat_V->ld, h, 1, 1.0, y, 1);
+    }
+}
+
+static void eram_deflated_matvec(size_t n, void const* ctx, double const* x, size_t incx,
+                                 double* y)
+{
+    eram_deflated_t const* op = ctx;
+    op->matvec(n, op->A, x, incx, y);
+    eram_deflate(n, op->mat_V, op->k, op->h, y);
+}
+
+/**
+ * Appends to the locked basis the real part of the Ritz vector `Q_m y`, or its
+ * imaginary part if `imag` is set, orthonormalized against the `k` locked
+ * columns of `V`. Returns the new number of locked columns.
+ **/
+static size_t eram_lock(size_t n, size_t m, matrix_t const* mat_Q, double complex const* y,
+                        bool imag, matrix_t* mat_V, size_t k, double* h)
+{
+    double* restrict v = mat_V->data + k * mat_V->ld;
+    memset(v, 0, n * sizeof(double));
+    for (size_t j = 0; j < m; ++j) {
+        double const c = imag ? cimag(y[j]) : creal(y[j]);
+        cblas_daxpy(n, c, mat_Q->data + j * mat_Q->ld, 1, v, 1);
+    }
+    eram_deflate(n, mat_V, k, h, v);
+    double const v_nrm = cblas_dnrm2(n, v, 1);
+    if (v_nrm <= GRAM_SCHMIDT_EPSILON)
+        return k;
+    cblas_dscal(n, 1.0 / v_nrm, v, 1);
+    return k + 1;
+}
+
+size_t eram_workspace(size_t n, size_t s, size_t m)
+{
+    return ritz_ws_size(n, s + ERAM_NB_EXTRA, m) + arena_matrix_size(m, 1) +
+           gram_schmidt_workspace(n) + arena_matrix_size(n, s + 1) +
+           arena_matrix_size(s + 1, s + 1) + arena_matrix_size(s + 1, 1) + arena_matrix_size(n, 1) +
+           (2 * s + 1 + ERAM_NB_EXTRA) * sizeof(double complex) + 2 * ALIGNMENT;
+}
+
+static int eram_run(size_t n, size_t s, size_t m, operator_fn matvec, void const* A, double* x,
+                    double tol, size_t max_restarts, double complex* ritz_values,
+                    double complex* ritz_vectors, arena_t* ws, arnoldi_info_t* info)
+{
+    if (s == 0 || m <= s || m > n)
+        return -1;
+
+    arena_t* tmp_ws = ws ? NULL : arena_init(eram_workspace(n, s, m));
+    arena_t* arena = ws ? ws : tmp_ws;
+    if (!arena)
+        return -1;
+    size_t const mark = arena_mark(arena);
 
-            H[j][k - 1] = cblas_ddot(mat_Q->rows, q_j_T, 1, v, 1);
-            cblas_daxpy(n, -H[j][k - 1], q_j_T, 1, v, 1);
+    int ret = -1;
+    arnoldi_info_t stats = { 0 };
+    ritz_ws_t rws;
+    bool const ok = ritz_ws_init(&rws, arena, n, s + ERAM_NB_EXTRA, m);
+    double* comb = arena_alloc(arena, m * sizeof(double));
+    // Locked basis, one more column than wanted pairs in case the last one
+    // locked is complex, and the projection of `A` on it
+    matrix_t* mat_V = arena_matrix(arena, n, s + 1, COL_MAJOR);
+    matrix_t* mat_T = arena_matrix(arena, s + 1, s + 1, ROW_MAJOR);
+    double* h = arena_alloc(arena, (s + 1) * sizeof(double));
+    double* v = arena_alloc(arena, n * sizeof(double));
+    // Ritz values of the deflated operator and eigenvectors of `T`
+    double complex* theta = arena_alloc(arena, (s + ERAM_NB_EXTRA) * sizeof(double complex));
+    double complex* y_T = arena_alloc(arena, (s + 1) * sizeof(double complex));
+    if (!ok || !comb || !mat_V || !mat_T || !h || !v || !theta || !y_T)
+        goto cleanup;
+
+    eram_deflated_t op = { .matvec = matvec, .A = A, .mat_V = mat_V, .k = 0, .h = h };
+    size_t s_want = s;
+    size_t m_eff = m;
+    for (size_t restart = 0;; ++restart) {
+        // Arnoldi: `m` steps from `x`, giving `A Q_m = Q_m H_m + h_m+1,m q_m+1 e_m^T`,
+        // `A` being deflated from the locked pairs
+        instant_t start = instant_now();
+        memset(rws.mat_H->data, 0, rws.mat_H->rows * rws.mat_H->ld * sizeof(double));
+        mgs(n, x, eram_deflated_matvec, &op, m + 1, rws.mat_Q, rws.mat_H, arena);
+        instant_t stop = instant_now();
+        stats.t_arnoldi += compute_avg_latency(start, stop, 1);
+
+        m_eff = arnoldi_size(rws.mat_H, m);
+        stats.nb_matvecs += m_eff;
+        double const beta = m_eff == m ? rws.mat_H->data[matrix_index(rws.mat_H, m, m - 1)] : 0.0;
+        // Restarting from all the Ritz vectors would rebuild the same basis
+        s_want = s - op.k < m_eff ? s - op.k : m_eff;
+        size_t const s_max = m_eff < m ? m_eff : m - 1;
+        size_t const s_act = s_want + ERAM_NB_EXTRA < s_max ? s_want + ERAM_NB_EXTRA : s_max;
+
+        // Ritz pairs: eigenpairs of `H_m`, with the wanted values first
+        start = instant_now();
+        if (ritz_pairs(&rws, m_eff, s_act, beta, tol, theta, &stats) != 0)
+            goto cleanup;
+        stop = instant_now();
+        stats.t_ritz += compute_avg_latency(start, stop, 1);
+        stats.max_residual = 0.0;
+        for (size_t i = 0; i < s_want; ++i) {
+            stats.max_residual = fmax(stats.max_residual, rws.residuals[i]);
         }
 
-        H[k][k - 1] = cblas_dnrm2(n, v, 1);
-        if (H[k][k - 1] > epsilon) {
-            #pragma omp simd
-            for (size_t _ = 0; _ < n; ++_) {
-                Q[_][k] = v[_] / H[k][k - 1];
+        // Lock the converged pairs by decreasing modulus, both halves of a
+        // complex one at once. Stopping at the first one that has not converged
+        // keeps a pair of smaller modulus from taking the place of a wanted one.
+        for (size_t i = 0; i < s_want && op.k < s; ++i) {
+            if (rws.residuals[i] > tol)
+                break;
+            if (cimag(theta[i]) != 0.0 && i > 0 && theta[i - 1] == conj(theta[i]))
+                continue;
+            double complex const* y = rws.Y + i * m;
+            op.k = eram_lock(n, m_eff, rws.mat_Q, y, false, mat_V, op.k, h);
+            if (cimag(theta[i]) != 0.0) {
+                op.k = eram_lock(n, m_eff, rws.mat_Q, y, true, mat_V, op.k, h);
+            }
+        }
+        if (op.k >= s || restart == max_restarts) {
+            ret = op.k >= s ? 0 : 1;
+            break;
+        }
+
+        // Restart from the Ritz vectors that are not locked, both the real and
+        // imaginary parts of a complex one contributing. Weighing them by the
+        // inverse of their residual keeps the spurious Ritz values, which
+        // come and go between restarts, from crowding out the converging ones.
+        start = instant_now();
+        memset(comb, 0, m_eff * sizeof(double));
+        for (size_t i = 0; i < s_act; ++i) {
+            if (rws.residuals[i] <= tol && i < s_want)
+                continue;
+            double const sgn = cimag(theta[i]) < 0.0 ? -1.0 : 1.0;
+            double const weight = 1.0 / fmax(fmax(rws.residuals[i], tol), DBL_MIN);
+            for (size_t j = 0; j < m_eff; ++j) {
+                comb[j] += weight * (creal(rws.Y[i * m + j]) + sgn * cimag(rws.Y[i * m + j]));
             }
-        } else {
+        }
+        dgemv_strided(n, m_eff, 1.0, rws.mat_Q->data, 1, rws.mat_Q->ld, comb, 1, 0.0, x, 1);
+        eram_deflate(n, mat_V, op.k, h, x);
+        stop = instant_now();
+        stats.t_restart += compute_avg_latency(start, stop, 1);
+        stats.nb_restarts += 1;
+
+        // Only locked directions were left in an invariant subspace
+        if (cblas_dnrm2(n, x, 1) <= GRAM_SCHMIDT_EPSILON) {
+            ret = 1;
+            break;
+        }
+    }
+
+    // Eigenpairs of the projection `T = V^T A V`, quasi-triangular since each
+    // column of `V` was locked after the previous ones
+    size_t const k = op.k;
+    for (size_t j = 0; j < k; ++j) {
+        matvec(n, A, mat_V->data + j * mat_V->ld, 1, v);
+        dgemv_strided(k, n, 1.0, mat_V->data, mat_V->ld, 1, v, 1, 0.0, h, 1);
+        for (size_t i = 0; i < k; ++i) {
+            mat_T->data[i * mat_T->ld + j] = h[i];
+        }
+    }
+    stats.nb_matvecs += k;
+    if (k > 0 && hessenberg_eigvals(k, mat_T->data, mat_T->ld, rws.w, rws.hqr_work) != 0) {
+        ret = -1;
+        goto cleanup;
+    }
+    eigvals_sort_by_modulus(k, rws.w, rws.idx);
+    size_t const s_lock = k < s ? k : s;
+    for (size_t i = 0; i < s_lock; ++i) {
+        ritz_values[i] = rws.w[rws.idx[i]];
+        if (!ritz_vectors)
+            continue;
+        hessenberg_eigvec(k, mat_T->data, mat_T->ld, ritz_values[i], y_T, rws.vec_work);
+        double complex* restrict u = ritz_vectors + i * n;
+        memset(u, 0, n * sizeof(double complex));
+        for (size_t j = 0; j < k; ++j) {
+            double const* restrict v_j = mat_V->data + j * mat_V->ld;
+            for (size_t r = 0; r < n; ++r) {
+                u[r] += y_T[j] * v_j[r];
+            }
+        }
+    }
+
+    // The pairs that did not converge keep their current Ritz value and vector
+    size_t next = s_lock;
+    for (size_t i = 0; i < s_want && next < s; ++i) {
+        if (rws.residuals[i] <= tol)
+            continue;
+        ritz_values[next] = theta[i];
+        if (ritz_vectors) {
+            double complex* restrict u = ritz_vectors + next * n;
+            memset(u, 0, n * sizeof(double complex));
+            for (size_t j = 0; j < m_eff; ++j) {
+                double const* restrict q_j = rws.mat_Q->data + j * rws.mat_Q->ld;
+                for (size_t r = 0; r < n; ++r) {
+                    u[r] += rws.Y[i * m + j] * q_j[r];
+                }
+            }
+        }
+        next += 1;
+    }
+    for (size_t i = next; i < s; ++i) {
+        ritz_values[i] = 0.0;
+        if (ritz_vectors) {
+            memset(ritz_vectors + i * n, 0, n * sizeof(double complex));
+        }
+    }
+    stats.nb_converged = s_lock;
+
+cleanup:
+    if (info) {
+        *info = stats;
+    }
+    arena_reset(arena, mark);
+    arena_deinit(tmp_ws);
+    return ret;
+}
+
+int eram(size_t n, size_t s, size_t m, matrix_t const* mat_A, double* x, double tol,
+         size_t max_restarts, double complex* ritz_values, double complex* ritz_vectors,
+         arena_t* ws, arnoldi_info_t* info)
+{
+    operator_t op = operator_from_matrix(mat_A);
+    op.n = n;
+    return eram_op(s, m, &op, x, tol, max_restarts, ritz_values, ritz_vectors, ws, info);
+}
+
+int eram_op(size_t s, size_t m, operator_t const* A, double* x, double tol, size_t max_restarts,
+            double complex* ritz_values, double complex* ritz_vectors, arena_t* ws,
+            arnoldi_info_t* info)
+{
+    return eram_run(A->n, s, m, A->apply, A->ctx, x, tol, max_restarts, ritz_values,
+                    ritz_vectors, ws, info);
+}
+
+size_t iram_workspace(size_t n, size_t s, size_t m)
+{
+    return ritz_ws_size(n, s, m) + arena_matrix_size(m, m) + arena_matrix_size(n, 1) +
+           IRAM_BLOCK_ROWS * m * sizeof(double) + 3 * ALIGNMENT;
+}
+
+/**
+ * Replaces the first `k + 1` columns of the `n * (m + 1)` basis `Q` by
+ * `Q[:,0..m - 1] Z[:,0..k]` in place, one block of `IRAM_BLOCK_ROWS` rows at
+ * a time through the `IRAM_BLOCK_ROWS * m` buffer `buf`, then folds the
+ * residual of the factorization into column `k`:
+ * `Q[:,k] <- beta_k Q[:,k] + sigma Q[:,m]`.
+ **/
+static void iram_compress(size_t n, size_t m, size_t k, matrix_t* mat_Q, matrix_t const* mat_Z,
+                          double beta_k, double sigma, double* buf)
+{
+    double* Q = mat_Q->data;
+    size_t const ldq = mat_Q->ld;
+
+    for (size_t r = 0; r < n; r += IRAM_BLOCK_ROWS) {
+        size_t const rows = n - r < IRAM_BLOCK_ROWS ? n - r : IRAM_BLOCK_ROWS;
+        for (size_t l = 0; l < m; ++l) {
+            memcpy(buf + l * rows, Q + l * ldq + r, rows * sizeof(double));
+        }
+        // `Z` is row-major, hence transposed for a column-major product
+        cblas_dgemm(CblasColMajor, CblasNoTrans, CblasTrans, rows, k + 1, m, 1.0, buf, rows,
+                    mat_Z->data, mat_Z->ld, 0.0, Q + r, ldq);
+    }
+    cblas_dscal(n, beta_k, Q + k * ldq, 1);
+    cblas_daxpy(n, sigma, Q + m * ldq, 1, Q + k * ldq, 1);
+}
+
+static int iram_run(size_t n, size_t s, size_t m, operator_fn matvec, void const* A, double* x,
+                    double tol, size_t max_restarts, double complex* ritz_values,
+                    double complex* ritz_vectors, arena_t* ws, arnoldi_info_t* info)
+{
+    if (s == 0 || m < s + 3 || m > n)
+        return -1;
+
+    arena_t* tmp_ws = ws ? NULL : arena_init(iram_workspace(n, s, m));
+    arena_t* arena = ws ? ws : tmp_ws;
+    if (!arena)
+        return -1;
+    size_t const mark = arena_mark(arena);
+
+    int ret = -1;
+    arnoldi_info_t stats = { 0 };
+    ritz_ws_t rws;
+    bool const ok = ritz_ws_init(&rws, arena, n, s, m);
+    // Accumulated orthogonal factor of the shifted QR steps
+    matrix_t* mat_Z = arena_matrix(arena, m, m, ROW_MAJOR);
+    double* v = arena_alloc(arena, n * sizeof(double));
+    double* buf = arena_alloc(arena, IRAM_BLOCK_ROWS * m * sizeof(double));
+    if (!ok || !mat_Z || !v || !buf)
+        goto cleanup;
+
+    matrix_t* mat_Q = rws.mat_Q;
+    matrix_t* mat_H = rws.mat_H;
+    // Plain indexing, a variably modified `H` cannot be in scope of the gotos
+    double* restrict H = mat_H->data;
+    size_t const ldh = mat_H->ld;
+
+    // Initial `m`-step factorization, as in `modified_gram_schmidt`
+    instant_t start = instant_now();
+    double const x_nrm = cblas_dnrm2(n, x, 1);
+    for (size_t i = 0; i < n; ++i) {
+        mat_Q->data[i] = x[i] / x_nrm;
+    }
+    memset(mat_H->data, 0, mat_H->rows * mat_H->ld * sizeof(double));
+    size_t built = mgs_extend(n, matvec, A, 1, m + 1, mat_Q, mat_H, v);
+    stats.nb_matvecs += built > m ? m : built;
+    instant_t stop = instant_now();
+    stats.t_arnoldi += compute_avg_latency(start, stop, 1);
+
+    size_t s_eff = s;
+    size_t m_eff = m;
+    for (size_t restart = 0;; ++restart) {
+        // Broken down factorizations span an invariant subspace
+        m_eff = built > m ? m : built;
+        double const beta = built > m ? H[m * ldh + m - 1] : 0.0;
+        s_eff = s < m_eff ? s : m_eff;
+
+        start = instant_now();
+        if (ritz_pairs(&rws, m_eff, s_eff, beta, tol, ritz_values, &stats) != 0)
             goto cleanup;
+        stop = instant_now();
+        stats.t_ritz += compute_avg_latency(start, stop, 1);
+
+        if (stats.nb_converged == s_eff || restart == max_restarts) {
+            ret = stats.nb_converged == s ? 0 : 1;
+            break;
         }
+
+        // Keep `k` vectors: the wanted ones, plus some of the unwanted ones
+        // as pairs converge (as ARPACK does), without splitting a conjugate pair
+        start = instant_now();
+        size_t k = s + (stats.nb_converged < (m - s) / 2 ? stats.nb_converged : (m - s) / 2);
+        k = k < m - 2 ? k : m - 2;
+        double complex const last = rws.w[rws.idx[k - 1]];
+        if (cimag(last) != 0.0 && rws.w[rws.idx[k]] == conj(last)) {
+            k += 1;
+        }
+
+        // Shifted QR steps with the `m - k` unwanted Ritz values as shifts,
+        // complex conjugate pairs being applied together
+        memset(mat_Z->data, 0, mat_Z->rows * mat_Z->ld * sizeof(double));
+        for (size_t i = 0; i < m; ++i) {
+            mat_Z->data[matrix_index(mat_Z, i, i)] = 1.0;
+        }
+        for (size_t i = k; i < m; ++i) {
+            double complex const mu = rws.w[rws.idx[i]];
+            hessenberg_shifted_qr(m, mat_H->data, mat_H->ld, mu, m, mat_Z->data, mat_Z->ld,
+                                  rws.hqr_work);
+            if (cimag(mu) != 0.0 && i + 1 < m && rws.w[rws.idx[i + 1]] == conj(mu)) {
+                i += 1;
+            }
+        }
+
+        // A Q_m Z = Q_m Z (Z^T H Z) + f e_m^T Z: truncating to `k` columns
+        // leaves a `k`-step factorization with residual `beta_k q_k + sigma f`
+        double const beta_k = H[k * ldh + k - 1];
+        double const sigma = H[m * ldh + m - 1] * mat_Z->data[matrix_index(mat_Z, m - 1, k - 1)];
+        iram_compress(n, m, k, mat_Q, mat_Z, beta_k, sigma, buf);
+        for (size_t i = 0; i <= m; ++i) {
+            memset(H + i * ldh + k, 0, (m - k) * sizeof(double));
+        }
+
+        // Reorthogonalize the residual against the kept basis, folding the
+        // corrections into H, then normalize it into `q_k`
+        vector_view_t f = matrix_col(mat_Q, k);
+        for (size_t j = 0; j < k; ++j) {
+            vector_view_t q_j = matrix_col(mat_Q, j);
+            double const c = ddot_view(q_j, f);
+            H[j * ldh + k - 1] += c;
+            daxpy_view(-c, q_j, f);
+        }
+        double const f_nrm = dnrm2_view(f);
+        H[k * ldh + k - 1] = f_nrm;
+        stop = instant_now();
+        stats.t_restart += compute_avg_latency(start, stop, 1);
+        stats.nb_restarts += 1;
+
+        // Extend back to `m` steps, only the discarded vectors are recomputed
+        start = instant_now();
+        if (f_nrm > GRAM_SCHMIDT_EPSILON) {
+            double* restrict q_k = view_ptr(f);
+            for (size_t i = 0; i < n; ++i) {
+                q_k[i] /= f_nrm;
+            }
+            built = mgs_extend(n, matvec, A, k + 1, m + 1, mat_Q, mat_H, v);
+            stats.nb_matvecs += (built > m ? m : built) - k;
+        }
+        else {
+            built = k;
+        }
+        stop = instant_now();
+        stats.t_arnoldi += compute_avg_latency(start, stop, 1);
+    }
+
+    for (size_t i = s_eff; i < s; ++i) {
+        ritz_values[i] = 0.0;
+    }
+    if (ritz_vectors) {
+        ritz_vectors_from_basis(&rws, n, m_eff, s_eff, s, ritz_vectors);
+    }
+
+cleanup:
+    if (info) {
+        *info = stats;
+    }
+    arena_reset(arena, mark);
+    arena_deinit(tmp_ws);
+    return ret;
+}
+
+int iram(size_t n, size_t s, size_t m, matrix_t const* mat_A, double* x, double tol,
+         size_t max_restarts, double complex* ritz_values, double complex* ritz_vectors,
+         arena_t* ws, arnoldi_info_t* info)
+{
+    operator_t op = operator_from_matrix(mat_A);
+    op.n = n;
+    return iram_op(s, m, &op, x, tol, max_restarts, ritz_values, ritz_vectors, ws, info);
+}
+
+int iram_op(size_t s, size_t m, operator_t const* A, double* x, double tol, size_t max_restarts,
+            double complex* ritz_values, double complex* ritz_vectors, arena_t* ws,
+            arnoldi_info_t* info)
+{
+    return iram_run(A->n, s, m, A->apply, A->ctx, x, tol, max_restarts, ritz_values,
+                    ritz_vectors, ws, info);
+}
+
+void jacobi_preconditioner(size_t n, void const* ctx, double const* x, double* y)
+{
+    double const* restrict inv_diag = ctx;
+#pragma omp simd
+    for (size_t i = 0; i < n; ++i) {
+        y[i] = inv_diag[i] * x[i];
+    }
+}
+
+/**
+ * Right-preconditioned operator `A M^-1` seen by the Arnoldi process of
+ * `gmres`, `z` being scratch memory for `M^-1 x`.
+ **/
+typedef struct gmres_operator_s {
+    operator_fn matvec;
+    void const* A;
+    preconditioner_fn precond;
+    void const* ctx;
+    double* z;
+} gmres_operator_t;
+
+static void gmres_matvec(size_t n, void const* op, double const* x, size_t incx, double* y)
+{
+    gmres_operator_t const* self = op;
+    if (!self->precond) {
+        self->matvec(n, self->A, x, incx, y);
+        return;
+    }
+    // The basis is column-major, so `x` is contiguous
+    assert(incx == 1);
+    self->precond(n, self->ctx, x, self->z);
+    self->matvec(n, self->A, self->z, 1, y);
+}
+
+size_t gmres_workspace(size_t n, size_t m)
+{
+    return arena_matrix_size(n, m + 1) + arena_matrix_size(m + 1, m) +
+           3 * n * sizeof(double) + (4 * m + 1) * sizeof(double) + 8 * ALIGNMENT;
+}
+
+static int gmres_solve(size_t n, operator_fn matvec, void const* A, double const* b, double* x,
+                       size_t m, double tol, size_t max_restarts, preconditioner_fn precond,
+                       void const* ctx, arena_t* ws, gmres_info_t* info)
+{
+    if (m == 0)
+        return -1;
+
+    arena_t* tmp_ws = ws ? NULL : arena_init(gmres_workspace(n, m));
+    arena_t* arena = ws ? ws : tmp_ws;
+    if (!arena)
+        return -1;
+    size_t const mark = arena_mark(arena);
+
+    int ret = -1;
+    gmres_info_t stats = { 0 };
+    instant_t const t_start = instant_now();
+    matrix_t* mat_Q = arena_matrix(arena, n, m + 1, COL_MAJOR);
+    matrix_t* mat_H = arena_matrix(arena, m + 1, m, ROW_MAJOR);
+    double* v = arena_alloc(arena, n * sizeof(double));
+    double* r = arena_alloc(arena, n * sizeof(double));
+    double* z = arena_alloc(arena, n * sizeof(double));
+    // Right-hand side of the least-squares problem, rotations and solution
+    double* g = arena_alloc(arena, (m + 1) * sizeof(double));
+    double* cs = arena_alloc(arena, m * sizeof(double));
+    double* sn = arena_alloc(arena, m * sizeof(double));
+    double* y = arena_alloc(arena, m * sizeof(double));
+    if (!mat_Q || !mat_H || !v || !r || !z || !g || !cs || !sn || !y)
+        goto cleanup;
+
+    double* restrict H = mat_H->data;
+    size_t const ldh = mat_H->ld;
+    double* restrict Q = mat_Q->data;
+    gmres_operator_t const op = {
+        .matvec = matvec, .A = A, .precond = precond, .ctx = ctx, .z = z
+    };
+    double b_nrm = cblas_dnrm2(n, b, 1);
+    b_nrm = b_nrm > 0.0 ? b_nrm : 1.0;
+
+    for (size_t cycle = 0;; ++cycle) {
+        // r = b - A x
+        instant_t start = instant_now();
+        matvec(n, A, x, 1, r);
+        for (size_t i = 0; i < n; ++i) {
+            r[i] = b[i] - r[i];
+        }
+        double const beta = cblas_dnrm2(n, r, 1);
+        instant_t stop = instant_now();
+        stats.t_update += compute_avg_latency(start, stop, 1);
+        // Cycles are counted once their result is known, from the true residual
+        stats.nb_restarts = cycle > 0 ? cycle - 1 : 0;
+        stats.residual = beta / b_nrm;
+        if (stats.residual <= tol || cycle > max_restarts) {
+            ret = stats.residual <= tol ? 0 : 1;
+            break;
+        }
+
+        for (size_t i = 0; i < n; ++i) {
+            Q[i] = r[i] / beta;
+        }
+        memset(g, 0, (m + 1) * sizeof(double));
+        g[0] = beta;
+
+        size_t k = 0;
+        while (k < m) {
+            // One Arnoldi step, filling column `k` of H
+            start = instant_now();
+            size_t const built = mgs_extend(n, gmres_matvec, &op, k + 1, k + 2, mat_Q, mat_H, v);
+            stop = instant_now();
+            stats.t_arnoldi += compute_avg_latency(start, stop, 1);
+
+            // Previous rotations, then a new one zeroing h_k+1,k
+            start = instant_now();
+            for (size_t i = 0; i < k; ++i) {
+                double const h_i = H[i * ldh + k];
+                double const h_j = H[(i + 1) * ldh + k];
+                H[i * ldh + k] = cs[i] * h_i + sn[i] * h_j;
+                H[(i + 1) * ldh + k] = -sn[i] * h_i + cs[i] * h_j;
+            }
+            double const h_kk = H[k * ldh + k];
+            double const h_sub = H[(k + 1) * ldh + k];
+            double const rho = hypot(h_kk, h_sub);
+            cs[k] = rho > 0.0 ? h_kk / rho : 1.0;
+            sn[k] = rho > 0.0 ? h_sub / rho : 0.0;
+            H[k * ldh + k] = rho;
+            H[(k + 1) * ldh + k] = 0.0;
+            g[k + 1] = -sn[k] * g[k];
+            g[k] = cs[k] * g[k];
+            stop = instant_now();
+            stats.t_givens += compute_avg_latency(start, stop, 1);
+
+            k += 1;
+            stats.nb_iterations += 1;
+            // |g_k| is the residual norm of the current iterate
+            if (fabs(g[k]) / b_nrm <= tol || built < k + 1)
+                break;
+        }
+
+        // x += M^-1 Q_k y, where H_k y = g_k
+        start = instant_now();
+        memcpy(y, g, k * sizeof(double));
+        cblas_dtrsv(CblasRowMajor, CblasUpper, CblasNoTrans, CblasNonUnit, k, H, ldh, y, 1);
+        cblas_dgemv(CblasColMajor, CblasNoTrans, n, k, 1.0, Q, mat_Q->ld, y, 1, 0.0, v, 1);
+        if (precond) {
+            precond(n, ctx, v, z);
+            cblas_daxpy(n, 1.0, z, 1, x, 1);
+        }
+        else {
+            cblas_daxpy(n, 1.0, v, 1, x, 1);
+        }
+        stop = instant_now();
+        stats.t_update += compute_avg_latency(start, stop, 1);
+    }
+
+cleanup:
+    if (info) {
+        stats.t_total = compute_avg_latency(t_start, instant_now(), 1);
+        *info = stats;
+    }
+    arena_reset(arena, mark);
+    arena_deinit(tmp_ws);
+    return ret;
+}
+
+int gmres(size_t n, matrix_t const* mat_A, double const* b, double* x, size_t m, double tol,
+          size_t max_restarts, preconditioner_fn precond, void const* ctx, arena_t* ws,
+          gmres_info_t* info)
+{
+    operator_t op = operator_from_matrix(mat_A);
+    op.n = n;
+    return gmres_op(&op, b, x, m, tol, max_restarts, precond, ctx, ws, info);
+}
+
+int gmres_sparse(size_t n, sparse_t const* A, double const* b, double* x, size_t m, double tol,
+                 size_t max_restarts, preconditioner_fn precond, void const* ctx, arena_t* ws,
+                 gmres_info_t* info)
+{
+    operator_t op = operator_from_sparse(A);
+    op.n = n;
+    return gmres_op(&op, b, x, m, tol, max_restarts, precond, ctx, ws, info);
+}
+
+int gmres_op(operator_t const* A, double const* b, double* x, size_t m, double tol,
+             size_t max_restarts, preconditioner_fn precond, void const* ctx, arena_t* ws,
+             gmres_info_t* info)
+{
+    return gmres_solve(A->n, A->apply, A->ctx, b, x, m, tol, max_restarts, precond, ctx, ws,
+                       info);
+}
+
+char const* lanczos_reorth_to_str(lanczos_reorth_t reorth)
+{
+    switch (reorth) {
+        case LANCZOS_NO_REORTH:
+            return "none";
+        case LANCZOS_SELECTIVE:
+            return "selective";
+        case LANCZOS_PARTIAL:
+            return "partial";
+        case LANCZOS_FULL:
+            return "full";
+        default:
+            return "unknown";
     }
+}
+
+size_t lanczos_workspace(size_t n, size_t deg_m)
+{
+    // Three vectors of `n`, the projections, three rows of inner product
+    // estimates, then a copy of `T`, its eigenvectors and their scratch space
+    return 3 * n * sizeof(double) + deg_m * sizeof(double) + 3 * (deg_m + 1) * sizeof(double) +
+           9 * deg_m * sizeof(double) + 11 * ALIGNMENT;
+}
+
+/**
+ * Updates the estimates `omega_next[j]` of `q_k+1^T q_j` from those of the
+ * two previous vectors with the recurrence of Simon, `beta_k` being the norm
+ * of the new vector before normalization, and returns their largest modulus.
+ **/
+static double lanczos_omega(size_t k, double const* alpha, double const* beta, double beta_k,
+                            double const* omega_prev, double const* omega, double* omega_next)
+{
+    double const eps = DBL_EPSILON;
+    double max = 0.0;
+    for (size_t j = 0; j < k; ++j) {
+        double t = beta[j] * omega[j + 1] + (alpha[j] - alpha[k]) * omega[j] -
+                   beta[k - 1] * omega_prev[j];
+        if (j > 0) {
+            t += beta[j - 1] * omega[j - 1];
+        }
+        // Rounding errors of the step, with the sign that makes things worse
+        t += copysign(eps * (beta[j] + beta_k), t);
+        omega_next[j] = t / beta_k;
+        max = fmax(max, fabs(omega_next[j]));
+    }
+    omega_next[k] = eps;
+    omega_next[k + 1] = 1.0;
+    return max;
+}
+
+/**
+ * Orthogonalizes `v` against the Ritz vectors of `T_k+1` that have converged,
+ * whose residual `|beta_k s_k|` is below `sqrt(eps) ||T||`. The Ritz values
+ * and the last components of the eigenvectors `s` of `T_k+1` come from a QL
+ * iteration, then only the converged `s` are computed, by inverse iteration.
+ * As `y_i = Q s_i`, all the projections are removed with two dgemv over `Q`:
+ * `v -= Q (sum_i s_i s_i^T) Q^T v`. `d`, `e`, `z`, `s` and `h` hold `k + 1`
+ * doubles and `work` five times as many. Returns the number of Ritz vectors
+ * `v` was orthogonalized against.
+ **/
+static size_t lanczos_selective(size_t n, size_t k, double const* alpha, double const* beta,
+                                double t_nrm, matrix_t const* mat_Q, double* v, double* d,
+                                double* e, double* z, double* s, double* h, double* work)
+{
+    size_t const m = k + 1;
+    double const tol = sqrt(DBL_EPSILON) * t_nrm;
+
+    memcpy(d, alpha, m * sizeof(double));
+    memcpy(e, beta, k * sizeof(double));
+    memset(z, 0, m * sizeof(double));
+    z[k] = 1.0;
+    if (tridiagonal_eigen(m, d, e, 1, z, m) != 0)
+        return 0;
+
+    size_t nb_converged = 0;
+    for (size_t i = 0; i < m; ++i) {
+        nb_converged += fabs(beta[k] * z[i]) <= tol;
+    }
+    if (nb_converged == 0)
+        return 0;
+
+    // h = Q^T v, then z = sum_i (s_i^T h) s_i over the converged pairs
+    CBLAS_ORDER const order = mat_Q->layout == ROW_MAJOR ? CblasRowMajor : CblasColMajor;
+    cblas_dgemv(order, CblasTrans, n, m, 1.0, mat_Q->data, mat_Q->ld, v, 1, 0.0, h, 1);
+    double const* s_k = z;
+    double* w = e;
+    memset(w, 0, m * sizeof(double));
+    for (size_t i = 0; i < m; ++i) {
+        if (fabs(beta[k] * s_k[i]) > tol)
+            continue;
+        tridiagonal_eigvec(m, alpha, beta, d[i], s, work);
+        cblas_daxpy(m, cblas_ddot(m, s, 1, h, 1), s, 1, w, 1);
+    }
+    cblas_dgemv(order, CblasNoTrans, n, m, -1.0, mat_Q->data, mat_Q->ld, w, 1, 1.0, v, 1);
+    return nb_converged;
+}
+
+static size_t lanczos_run(size_t n, double const* x, operator_fn matvec, void const* A,
+                          size_t deg_m, lanczos_reorth_t reorth, matrix_t* mat_Q, double* alpha,
+                          double* beta, arena_t* ws, lanczos_info_t* info)
+{
+    double const epsilon = GRAM_SCHMIDT_EPSILON;
+    if (deg_m == 0 || (!mat_Q && reorth != LANCZOS_NO_REORTH) ||
+        (mat_Q && mat_Q->cols < deg_m))
+        return 0;
+
+    arena_t* tmp_ws = ws ? NULL : arena_init(lanczos_workspace(n, deg_m));
+    arena_t* arena = ws ? ws : tmp_ws;
+    if (!arena)
+        return 0;
+    size_t const mark = arena_mark(arena);
+
+    size_t steps = 0;
+    lanczos_info_t stats = { 0 };
+    double* v = arena_alloc(arena, n * sizeof(double));
+    double* q_prev = arena_alloc(arena, n * sizeof(double));
+    double* q_curr = arena_alloc(arena, n * sizeof(double));
+    double* h = arena_alloc(arena, deg_m * sizeof(double));
+    double* omega_prev = arena_alloc(arena, (deg_m + 1) * sizeof(double));
+    double* omega = arena_alloc(arena, (deg_m + 1) * sizeof(double));
+    double* omega_next = arena_alloc(arena, (deg_m + 1) * sizeof(double));
+    double* d = arena_alloc(arena, deg_m * sizeof(double));
+    double* e = arena_alloc(arena, deg_m * sizeof(double));
+    double* z = arena_alloc(arena, deg_m * sizeof(double));
+    double* work = arena_alloc(arena, 6 * deg_m * sizeof(double));
+    if (!v || !q_prev || !q_curr || !h || !omega_prev || !omega || !omega_next || !d || !e || !z ||
+        !work)
+        goto cleanup;
+
+    // Without a basis, the last two vectors are kept in `q_prev` and `q_curr`
+    size_t inc_q = 1;
+    double* q = q_curr;
+    if (mat_Q) {
+        vector_view_t const q_0 = matrix_col(mat_Q, 0);
+        q = view_ptr(q_0);
+        inc_q = vector_view_inc(q_0);
+    }
+    double const x_nrm = cblas_dnrm2(n, x, 1);
+#pragma omp simd
+    for (size_t _ = 0; _ < n; ++_) {
+        q[_ * inc_q] = x[_] / x_nrm;
+    }
+    double const* q_km1 = NULL;
+    omega[0] = 1.0;
+
+    CBLAS_ORDER const order =
+        mat_Q && mat_Q->layout == ROW_MAJOR ? CblasRowMajor : CblasColMajor;
+    double t_nrm = 0.0;
+    bool reorth_next = false;
+    for (size_t k = 0; k < deg_m; ++k) {
+        // beta_k q_k+1 = A q_k - alpha_k q_k - beta_k-1 q_k-1
+        matvec(n, A, q, inc_q, v);
+        if (k > 0) {
+            cblas_daxpy(n, -beta[k - 1], q_km1, inc_q, v, 1);
+        }
+        alpha[k] = cblas_ddot(n, q, inc_q, v, 1);
+        cblas_daxpy(n, -alpha[k], q, inc_q, v, 1);
+        beta[k] = cblas_dnrm2(n, v, 1);
+        t_nrm = fmax(t_nrm, fabs(alpha[k]) + beta[k] + (k > 0 ? beta[k - 1] : 0.0));
+        steps = k + 1;
+
+        instant_t const start = instant_now();
+        bool full = reorth == LANCZOS_FULL;
+        if (reorth == LANCZOS_PARTIAL && k > 0) {
+            // Simon: once the estimated loss exceeds sqrt(eps), the next two
+            // vectors are reorthogonalized, since `q_k` has lost it as well
+            bool const lost = lanczos_omega(k, alpha, beta, beta[k], omega_prev, omega,
+                                            omega_next) > sqrt(DBL_EPSILON);
+            full = lost || reorth_next;
+            reorth_next = lost;
+            double* tmp = omega_prev;
+            omega_prev = omega;
+            omega = omega_next;
+            omega_next = tmp;
+        }
+        else if (reorth == LANCZOS_PARTIAL) {
+            omega_prev[0] = 1.0;
+            omega[0] = DBL_EPSILON;
+            omega[1] = 1.0;
+        }
+        else if (reorth == LANCZOS_SELECTIVE) {
+            stats.nb_reorth += lanczos_selective(n, k, alpha, beta, t_nrm, mat_Q, v, d, e, z,
+                                                 work + 5 * deg_m, h, work);
+        }
+        if (full) {
+            // Two passes of classical Gram-Schmidt against q_0..q_k
+            for (size_t pass = 0; pass < 2; ++pass) {
+                cblas_dgemv(order, CblasTrans, n, k + 1, 1.0, mat_Q->data, mat_Q->ld, v, 1, 0.0,
+                            h, 1);
+                cblas_dgemv(order, CblasNoTrans, n, k + 1, -1.0, mat_Q->data, mat_Q->ld, h, 1,
+                            1.0, v, 1);
+            }
+            stats.nb_reorth += k + 1;
+            if (reorth == LANCZOS_PARTIAL) {
+                for (size_t j = 0; j <= k; ++j) {
+                    omega[j] = DBL_EPSILON;
+                }
+            }
+        }
+        if (reorth != LANCZOS_NO_REORTH) {
+            beta[k] = cblas_dnrm2(n, v, 1);
+        }
+        stats.t_reorth += compute_avg_latency(start, instant_now(), 1);
+
+        if (beta[k] <= epsilon)
+            break;
+
+        // Next vector, stored in `Q` if there is room for it
+        double* q_next = NULL;
+        if (!mat_Q) {
+            double* tmp = q_prev;
+            q_prev = q_curr;
+            q_curr = tmp;
+            q_next = q_curr;
+        }
+        else if (k + 1 < mat_Q->cols) {
+            q_next = view_ptr(matrix_col(mat_Q, k + 1));
+        }
+        else {
+            break;
+        }
+        double const beta_k = beta[k];
+#pragma omp simd
+        for (size_t _ = 0; _ < n; ++_) {
+            q_next[_ * inc_q] = v[_] / beta_k;
+        }
+        q_km1 = q;
+        q = q_next;
+    }
+    stats.nb_steps = steps;
 
 cleanup:
-    free(q_k);
-    free(v);
-    free(q_j_T);
+    if (info) {
+        *info = stats;
+    }
+    arena_reset(arena, mark);
+    arena_deinit(tmp_ws);
+    return steps;
 }
 
-void eram(size_t n, size_t s, size_t m,
-          double* A, double* x)
+size_t lanczos(size_t n, double const* x, matrix_t const* mat_A, size_t deg_m,
+               lanczos_reorth_t reorth, matrix_t* mat_Q, double* alpha, double* beta, arena_t* ws,
+               lanczos_info_t* info)
 {
+    operator_t op = operator_from_matrix(mat_A);
+    op.n = n;
+    return lanczos_op(x, &op, deg_m, reorth, mat_Q, alpha, beta, ws, info);
+}
 
+size_t lanczos_sparse(size_t n, double const* x, sparse_t const* A, size_t deg_m,
+                      lanczos_reorth_t reorth, matrix_t* mat_Q, double* alpha, double* beta,
+                      arena_t* ws, lanczos_info_t* info)
+{
+    operator_t op = operator_from_sparse(A);
+    op.n = n;
+    return lanczos_op(x, &op, deg_m, reorth, mat_Q, alpha, beta, ws, info);
+}
+
+size_t lanczos_op(double const* x, operator_t const* A, size_t deg_m, lanczos_reorth_t reorth,
+                  matrix_t* mat_Q, double* alpha, double* beta, arena_t* ws,
+                  lanczos_info_t* info)
+{
+    return lanczos_run(A->n, x, A->apply, A->ctx, deg_m, reorth, mat_Q, alpha, beta, ws, info);
 }
@@ -1,66 +1,905 @@
 #include "drivers.h"
+#include "arena.h"
 #include "blas.h"
+#include "eigen.h"
 #include "utils.h"
 
+#include <assert.h>
+#include <complex.h>
+#include <math.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 #define REPS 1000
 
-stats_t* driver_cgs(size_t n, matrix_t* A, vector_t* x, size_t deg_m, size_t reps)
+typedef void (*gram_schmidt_fn)(size_t n, double* restrict x, void const* A, size_t deg_m,
+                                matrix_t* mat_Q, matrix_t* mat_H, arena_t* ws);
+
+// Adapts a Gram-Schmidt routine taking an `A` of type `type` to `gram_schmidt_fn`
+#define GRAM_SCHMIDT_ADAPTER(name, fn, type)                                                       \
+    static void name(size_t n, double* restrict x, void const* A, size_t deg_m, matrix_t* mat_Q, \
+                     matrix_t* mat_H, arena_t* ws)                                                 \
+    {                                                                                              \
+        fn(n, x, (type)A, deg_m, mat_Q, mat_H, ws);                                                \
+    }
+
+GRAM_SCHMIDT_ADAPTER(cgs_dense, classical_gram_schmidt, matrix_t const*)
+GRAM_SCHMIDT_ADAPTER(mgs_dense, modified_gram_schmidt, matrix_t const*)
+GRAM_SCHMIDT_ADAPTER(cgs2_dense, classical_gram_schmidt2, matrix_t const*)
+GRAM_SCHMIDT_ADAPTER(cgs2_omp_dense, parallel_classical_gram_schmidt2, matrix_t const*)
+GRAM_SCHMIDT_ADAPTER(householder_dense, householder_arnoldi, matrix_t const*)
+GRAM_SCHMIDT_ADAPTER(cgs_spmv, classical_gram_schmidt_sparse, sparse_t const*)
+GRAM_SCHMIDT_ADAPTER(mgs_spmv, modified_gram_schmidt_sparse, sparse_t const*)
+GRAM_SCHMIDT_ADAPTER(cgs2_spmv, classical_gram_schmidt2_sparse, sparse_t const*)
+
+/**
+ * Matrix, block size and basis of an s-step run, passed as its `A`.
+ **/
+typedef struct s_step_ctx_s {
+    matrix_t const* A;
+    size_t s;
+    s_step_basis_t basis;
+} s_step_ctx_t;
+
+static void s_step_dense(size_t n, double* restrict x, void const* A, size_t deg_m,
+                         matrix_t* mat_Q, matrix_t* mat_H, arena_t* ws)
+{
+    s_step_ctx_t const* ctx = A;
+    s_step_gram_schmidt(n, x, ctx->A, deg_m, ctx->s, ctx->basis, mat_Q, mat_H, ws);
+}
+
+/**
+ * Times `deg_m` steps of the Gram-Schmidt routine `gs` on `A`, with a
+ * workspace of `ws_size` bytes. `resQ` and `resH` are the norms of `Q` and
+ * `H`, used to cross-check the routines.
+ **/
+static stats_t* driver_gram_schmidt_run(char const* title, gram_schmidt_fn gs, size_t ws_size,
+                                        size_t n, void const* A, vector_t* x, size_t deg_m,
+                                        size_t reps)
 {
-    stats_t* stats = stats_init("cgs", n);
+    stats_t* stats = stats_init(title, n);
     if (!stats) return NULL;
 
-    matrix_t* Q = matrix_zeroes(A->rows, deg_m + 1);
+    // Column-major so that each basis vector is contiguous
+    matrix_t* Q = matrix_zeroes_layout(n, deg_m + 1, COL_MAJOR);
     matrix_t* H = matrix_zeroes(deg_m + 1, deg_m);
+    // Workspace shared by all the repetitions, so that none of them allocates
+    arena_t* ws = arena_init(ws_size);
+    if (!Q || !H || !ws) {
+        matrix_deinit(Q);
+        matrix_deinit(H);
+        arena_deinit(ws);
+        stats_deinit(stats);
+        return NULL;
+    }
 
     double elapsed;
     for (size_t i = 0; i < MAX_SAMPLES; ++i) {
         do {
             instant_t start = instant_now();
             for (size_t _ = 0; _ < reps; ++_) {
-                classical_gram_schmidt(n, x->data, A->data, deg_m, Q, H);
+                gs(n, x->data, A, deg_m, Q, H, ws);
             }
             instant_t stop = instant_now();
             elapsed = compute_avg_latency(start, stop, reps);
             if (i == 0) {
-                stats->resQ = dnrmf(Q->rows, Q->cols, Q->data);
-                stats->resH = dnrmf(H->rows, H->cols, H->data);
+                stats->resQ = dnrmf_view(matrix_view(Q));
+                stats->resH = dnrmf_view(matrix_view(H));
             }
         } while (elapsed <= 0.0);
         stats->samples[i] = elapsed;
     }
 
+    matrix_deinit(Q);
+    matrix_deinit(H);
+    arena_deinit(ws);
     stats_compute(stats);
     return stats;
 }
 
+/**
+ * Times a dense Gram-Schmidt routine, named `name` with a suffix if `A` is
+ * padded.
+ **/
+static stats_t* driver_gram_schmidt_dense(char const* name, gram_schmidt_fn gs, size_t ws_size,
+                                          size_t n, matrix_t const* A, vector_t* x, size_t deg_m,
+                                          size_t reps)
+{
+    char title[BUF_LEN];
+    snprintf(title, BUF_LEN, "%s%s", name, matrix_is_padded(A) ? "_padded" : "");
+    return driver_gram_schmidt_run(title, gs, ws_size, n, A, x, deg_m, reps);
+}
+
+stats_t* driver_cgs(size_t n, matrix_t* A, vector_t* x, size_t deg_m, size_t reps)
+{
+    size_t const ws_size = gram_schmidt_workspace(n);
+    return driver_gram_schmidt_dense("cgs", cgs_dense, ws_size, n, A, x, deg_m, reps);
+}
+
 stats_t* driver_mgs(size_t n, matrix_t* A, vector_t* x, size_t deg_m, size_t reps)
 {
-    stats_t* stats = stats_init("mgs", n);
+    size_t const ws_size = gram_schmidt_workspace(n);
+    return driver_gram_schmidt_dense("mgs", mgs_dense, ws_size, n, A, x, deg_m, reps);
+}
+
+stats_t* driver_cgs2(size_t n, matrix_t* A, vector_t* x, size_t deg_m, size_t reps)
+{
+    size_t const ws_size = gram_schmidt2_workspace(n, deg_m);
+    return driver_gram_schmidt_dense("cgs2", cgs2_dense, ws_size, n, A, x, deg_m, reps);
+}
+
+stats_t* driver_cgs2_omp(size_t n, matrix_t* A, vector_t* x, size_t deg_m, size_t reps)
+{
+    size_t const ws_size = parallel_gram_schmidt2_workspace(n, deg_m);
+    return driver_gram_schmidt_dense("cgs2_omp", cgs2_omp_dense, ws_size, n, A, x, deg_m, reps);
+}
+
+stats_t* driver_householder(size_t n, matrix_t* A, vector_t* x, size_t deg_m, size_t reps)
+{
+    size_t const ws_size = householder_arnoldi_workspace(n, deg_m);
+    return driver_gram_schmidt_dense("householder", householder_dense, ws_size, n, A, x, deg_m,
+                                     reps);
+}
+
+stats_t* driver_s_step(size_t n, matrix_t* A, vector_t* x, size_t deg_m, size_t s,
+                       s_step_basis_t basis, size_t reps)
+{
+    char title[BUF_LEN];
+    snprintf(title, BUF_LEN, "sstep_%s%s", s_step_basis_to_str(basis),
+             matrix_is_padded(A) ? "_padded" : "");
+    s_step_ctx_t const ctx = { .A = A, .s = s, .basis = basis };
+    return driver_gram_schmidt_run(title, s_step_dense, s_step_workspace(n, deg_m, s), n, &ctx, x,
+                                   deg_m, reps);
+}
+
+int driver_orthogonality(size_t n, matrix_t* A, vector_t* x, size_t deg_m, size_t s,
+                         char const* filename)
+{
+    matrix_t* Q = matrix_zeroes_layout(A->rows, deg_m + 1, COL_MAJOR);
+    matrix_t* H = matrix_zeroes(deg_m + 1, deg_m);
+    if (!Q || !H) {
+        matrix_deinit(Q);
+        matrix_deinit(H);
+        return -1;
+    }
+
+    double loss[6];
+    classical_gram_schmidt(n, x->data, A, deg_m, Q, H, NULL);
+    loss[0] = orthogonality_loss(Q, deg_m);
+    modified_gram_schmidt(n, x->data, A, deg_m, Q, H, NULL);
+    loss[1] = orthogonality_loss(Q, deg_m);
+    classical_gram_schmidt2(n, x->data, A, deg_m, Q, H, NULL);
+    loss[2] = orthogonality_loss(Q, deg_m);
+    s_step_gram_schmidt(n, x->data, A, deg_m, s, S_STEP_MONOMIAL, Q, H, NULL);
+    loss[3] = orthogonality_loss(Q, deg_m);
+    s_step_gram_schmidt(n, x->data, A, deg_m, s, S_STEP_NEWTON, Q, H, NULL);
+    loss[4] = orthogonality_loss(Q, deg_m);
+    householder_arnoldi(n, x->data, A, deg_m, Q, H, NULL);
+    loss[5] = orthogonality_loss(Q, deg_m);
+    matrix_deinit(Q);
+    matrix_deinit(H);
+
+    FILE* ofp = (filename == NULL) ? stdout : fopen(filename, "ab");
+    if (!ofp) return -1;
+
+    fprintf(ofp, "orth_loss; %zu; %.3e; %.3e; %.3e; %.3e; %.3e; %.3e\n", n, loss[0], loss[1],
+            loss[2], loss[3], loss[4], loss[5]);
+
+    if (filename) {
+        fclose(ofp);
+    }
+    return 0;
+}
+
+/**
+ * Times a sparse Gram-Schmidt routine, named `name` with the format of `A`.
+ **/
+static stats_t* driver_gram_schmidt_sparse(char const* name, gram_schmidt_fn gs, size_t ws_size,
+                                           sparse_t const* A, vector_t* x, size_t deg_m,
+                                           size_t reps)
+{
+    char title[BUF_LEN];
+    snprintf(title, BUF_LEN, "%s_%s", name, sparse_format_to_str(A->format));
+    return driver_gram_schmidt_run(title, gs, ws_size, sparse_rows(A), A, x, deg_m, reps);
+}
+
+stats_t* driver_cgs_sparse(sparse_t const* A, vector_t* x, size_t deg_m, size_t reps)
+{
+    size_t const ws_size = gram_schmidt_workspace(sparse_rows(A));
+    return driver_gram_schmidt_sparse("cgs", cgs_spmv, ws_size, A, x, deg_m, reps);
+}
+
+stats_t* driver_mgs_sparse(sparse_t const* A, vector_t* x, size_t deg_m, size_t reps)
+{
+    size_t const ws_size = gram_schmidt_workspace(sparse_rows(A));
+    return driver_gram_schmidt_sparse("mgs", mgs_spmv, ws_size, A, x, deg_m, reps);
+}
+
+stats_t* driver_cgs2_sparse(sparse_t const* A, vector_t* x, size_t deg_m, size_t reps)
+{
+    size_t const ws_size = gram_schmidt2_workspace(sparse_rows(A), deg_m);
+    return driver_gram_schmidt_sparse("cgs2", cgs2_spmv, ws_size, A, x, deg_m, reps);
+}
+
+stats_t* driver_spmv(sparse_t const* A, size_t reps)
+{
+    char title[BUF_LEN];
+    snprintf(title, BUF_LEN, "spmv_%s", sparse_format_to_str(A->format));
+    size_t const n = sparse_rows(A);
+    stats_t* stats = stats_init(title, n);
+    if (!stats) return NULL;
+
+    // Padding entries of SELL-C-σ are not counted as useful work
+    size_t const nnz = A->format == SPARSE_CSR ? A->csr->nnz : A->sell->nnz;
+    size_t const cols = A->format == SPARSE_CSR ? A->csr->cols : A->sell->cols;
+    stats->nb_flops = 2 * nnz;
+    stats->nb_bytes = sparse_spmv_bytes(A);
+
+    vector_t* x = vector_zeroes(cols);
+    vector_t* y = vector_zeroes(n);
+    if (!x || !y) {
+        vector_deinit(x);
+        vector_deinit(y);
+        stats_deinit(stats);
+        return NULL;
+    }
+    // Same `x` for every format, independently of the state of `matrix_rand_init`
+    for (size_t i = 0; i < cols; ++i) {
+        x->data[i] = counter_double_range(cols, i, -1.0, 1.0);
+    }
+
+    double elapsed;
+    for (size_t i = 0; i < MAX_SAMPLES; ++i) {
+        do {
+            instant_t start = instant_now();
+            for (size_t _ = 0; _ < reps; ++_) {
+                sparse_spmv(1.0, A, x->data, 1, 0.0, y->data);
+            }
+            instant_t stop = instant_now();
+            elapsed = compute_avg_latency(start, stop, reps);
+            if (i == 0) {
+                // Same product for every format, used to cross-check them
+                stats->resQ = dnrm2(n, y->data);
+                stats->resH = 0.0;
+            }
+        } while (elapsed <= 0.0);
+        stats->samples[i] = elapsed;
+    }
+
+    vector_deinit(x);
+    vector_deinit(y);
+    stats_compute(stats);
+    return stats;
+}
+
+/**
+ * Adds the timings of an out-of-core run to `acc`.
+ **/
+static void ooc_stats_add(ooc_stats_t* acc, ooc_stats_t const* run)
+{
+    acc->bytes_read += run->bytes_read;
+    acc->nb_tiles = run->nb_tiles;
+    acc->io += run->io;
+    acc->compute += run->compute;
+    acc->wait += run->wait;
+    acc->total += run->total;
+}
+
+stats_t* driver_ooc_dgemv(ooc_matrix_t const* A, size_t tile_bytes, size_t reps, ooc_stats_t* io)
+{
+    stats_t* stats = stats_init("ooc_dgemv", A->rows);
+    if (!stats) return NULL;
+
+    stats->nb_flops = 2 * A->rows * A->cols;
+    stats->nb_bytes = (A->rows * A->cols + A->cols + A->rows) * sizeof(double);
+
+    vector_t* x = vector_zeroes(A->cols);
+    vector_t* y = vector_zeroes(A->rows);
+    if (!x || !y) {
+        vector_deinit(x);
+        vector_deinit(y);
+        stats_deinit(stats);
+        return NULL;
+    }
+    for (size_t i = 0; i < A->cols; ++i) {
+        x->data[i] = counter_double_range(A->cols, i, -1.0, 1.0);
+    }
+
+    ooc_stats_t total = { 0 };
+    ooc_stats_t run;
+    double elapsed;
+    for (size_t i = 0; i < MAX_SAMPLES; ++i) {
+        do {
+            instant_t start = instant_now();
+            for (size_t _ = 0; _ < reps; ++_) {
+                if (ooc_dgemv(1.0, A, x->data, 0.0, y->data, tile_bytes, &run) != 0) {
+                    vector_deinit(x);
+                    vector_deinit(y);
+                    stats_deinit(stats);
+                    return NULL;
+                }
+                ooc_stats_add(&total, &run);
+            }
+            instant_t stop = instant_now();
+            elapsed = compute_avg_latency(start, stop, reps);
+            if (i == 0) {
+                stats->resQ = dnrm2(A->rows, y->data);
+                stats->resH = 0.0;
+            }
+        } while (elapsed <= 0.0);
+        stats->samples[i] = elapsed;
+    }
+
+    if (io) {
+        *io = total;
+    }
+    vector_deinit(x);
+    vector_deinit(y);
+    stats_compute(stats);
+    return stats;
+}
+
+stats_t* driver_ooc_dgemm(ooc_matrix_t const* A, size_t p, size_t tile_bytes, size_t reps,
+                          ooc_stats_t* io)
+{
+    stats_t* stats = stats_init("ooc_dgemm", A->rows);
     if (!stats) return NULL;
 
-    matrix_t* Q = matrix_zeroes(A->rows, deg_m + 1);
+    stats->nb_flops = 2 * A->rows * A->cols * p;
+    stats->nb_bytes = (A->rows * A->cols + A->cols * p + A->rows * p) * sizeof(double);
+
+    matrix_t* B = matrix_zeroes(A->cols, p);
+    matrix_t* C = matrix_zeroes(A->rows, p);
+    if (!B || !C) {
+        matrix_deinit(B);
+        matrix_deinit(C);
+        stats_deinit(stats);
+        return NULL;
+    }
+    for (size_t i = 0; i < A->cols; ++i) {
+        for (size_t j = 0; j < p; ++j) {
+            B->data[matrix_index(B, i, j)] = counter_double_range(A->cols, i * p + j, -1.0, 1.0);
+        }
+    }
+
+    ooc_stats_t total = { 0 };
+    ooc_stats_t run;
+    double elapsed;
+    for (size_t i = 0; i < MAX_SAMPLES; ++i) {
+        do {
+            instant_t start = instant_now();
+            for (size_t _ = 0; _ < reps; ++_) {
+                if (ooc_dgemm(1.0, A, B, 0.0, C, tile_bytes, &run) != 0) {
+                    matrix_deinit(B);
+                    matrix_deinit(C);
+                    stats_deinit(stats);
+                    return NULL;
+                }
+                ooc_stats_add(&total, &run);
+            }
+            instant_t stop = instant_now();
+            elapsed = compute_avg_latency(start, stop, reps);
+            if (i == 0) {
+                stats->resQ = dnrmf_view(matrix_view(C));
+                stats->resH = 0.0;
+            }
+        } while (elapsed <= 0.0);
+        stats->samples[i] = elapsed;
+    }
+
+    if (io) {
+        *io = total;
+    }
+    matrix_deinit(B);
+    matrix_deinit(C);
+    stats_compute(stats);
+    return stats;
+}
+
+typedef int (*arnoldi_fn)(size_t n, size_t s, size_t m, matrix_t const* mat_A, double* x,
+                          double tol, size_t max_restarts, double complex* ritz_values,
+                          double complex* ritz_vectors, arena_t* ws, arnoldi_info_t* info);
+
+static stats_t* driver_arnoldi(char const* title, arnoldi_fn solver, size_t ws_size, size_t n,
+                               matrix_t* A, vector_t* x, size_t s, size_t m, double tol,
+                               size_t max_restarts, arnoldi_info_t* info)
+{
+    stats_t* stats = stats_init(title, n);
+    if (!stats) return NULL;
+
+    // The solvers may overwrite their starting vector, each run starts from a copy of `x`
+    vector_t* x_run = vector_zeroes(n);
+    double complex* ritz_values = malloc(s * sizeof(double complex));
+    arena_t* ws = arena_init(ws_size);
+    if (!x_run || !ritz_values || !ws) {
+        vector_deinit(x_run);
+        free(ritz_values);
+        arena_deinit(ws);
+        stats_deinit(stats);
+        return NULL;
+    }
+
+    arnoldi_info_t run;
+    arnoldi_info_t total = { 0 };
+    for (size_t i = 0; i < MAX_SAMPLES; ++i) {
+        memcpy(x_run->data, x->data, n * sizeof(double));
+        instant_t start = instant_now();
+        int ret = solver(n, s, m, A, x_run->data, tol, max_restarts, ritz_values, NULL, ws, &run);
+        instant_t stop = instant_now();
+        // A run that did not converge has no meaningful timing
+        if (ret != 0) {
+            if (info) {
+                *info = run;
+            }
+            vector_deinit(x_run);
+            free(ritz_values);
+            arena_deinit(ws);
+            stats_deinit(stats);
+            return NULL;
+        }
+        stats->samples[i] = compute_avg_latency(start, stop, 1);
+        if (i == 0) {
+            stats->resQ = cabs(ritz_values[0]);
+            stats->resH = run.max_residual;
+        }
+        total.t_arnoldi += run.t_arnoldi / MAX_SAMPLES;
+        total.t_ritz += run.t_ritz / MAX_SAMPLES;
+        total.t_restart += run.t_restart / MAX_SAMPLES;
+    }
+
+    if (info) {
+        // Restarts and residuals do not change from one run to the next
+        total.nb_restarts = run.nb_restarts;
+        total.nb_matvecs = run.nb_matvecs;
+        total.nb_converged = run.nb_converged;
+        total.max_residual = run.max_residual;
+        *info = total;
+    }
+    vector_deinit(x_run);
+    free(ritz_values);
+    arena_deinit(ws);
+    stats_compute(stats);
+    return stats;
+}
+
+stats_t* driver_eram(size_t n, matrix_t* A, vector_t* x, size_t s, size_t m, double tol,
+                     size_t max_restarts, arnoldi_info_t* info)
+{
+    return driver_arnoldi("eram", eram, eram_workspace(n, s, m), n, A, x, s, m, tol,
+                          max_restarts, info);
+}
+
+stats_t* driver_iram(size_t n, matrix_t* A, vector_t* x, size_t s, size_t m, double tol,
+                     size_t max_restarts, arnoldi_info_t* info)
+{
+    return driver_arnoldi("iram", iram, iram_workspace(n, s, m), n, A, x, s, m, tol,
+                          max_restarts, info);
+}
+
+int arnoldi_info_dump(char const* title, size_t size, arnoldi_info_t const* info,
+                      char const* filename)
+{
+    if (!info) return -1;
+
+    FILE* ofp = (filename == NULL) ? stdout : fopen(filename, "ab");
+    if (!ofp) return -1;
+
+    fprintf(ofp, "%s; %zu; %zu; %zu; %zu; %.3e; %2.3lf; %2.3lf; %2.3lf\n", title, size,
+            info->nb_restarts, info->nb_matvecs, info->nb_converged, info->max_residual,
+            info->t_arnoldi, info->t_ritz, info->t_restart);
+
+    if (filename) {
+        fclose(ofp);
+    }
+    return 0;
+}
+
+typedef int (*gmres_fn)(size_t n, void const* A, double const* b, double* x, size_t m,
+                        double tol, size_t max_restarts, preconditioner_fn precond,
+                        void const* ctx, arena_t* ws, gmres_info_t* info);
+
+static int gmres_dense(size_t n, void const* A, double const* b, double* x, size_t m, double tol,
+                       size_t max_restarts, preconditioner_fn precond, void const* ctx,
+                       arena_t* ws, gmres_info_t* info)
+{
+    return gmres(n, A, b, x, m, tol, max_restarts, precond, ctx, ws, info);
+}
+
+static int gmres_csr(size_t n, void const* A, double const* b, double* x, size_t m, double tol,
+                     size_t max_restarts, preconditioner_fn precond, void const* ctx,
+                     arena_t* ws, gmres_info_t* info)
+{
+    return gmres_sparse(n, A, b, x, m, tol, max_restarts, precond, ctx, ws, info);
+}
+
+/**
+ * Times GMRES(m) from a zero initial guess to a solution, with `diag` the
+ * diagonal of `A` for the Jacobi preconditioner or NULL for none. `resQ` is
+ * the final relative residual and `resH` the number of iterations.
+ **/
+static stats_t* driver_gmres_run(char const* title, gmres_fn solver, size_t n, void const* A,
+                                 double const* diag, size_t m, double tol, size_t max_restarts,
+                                 gmres_info_t* info)
+{
+    stats_t* stats = stats_init(title, n);
+    if (!stats) return NULL;
+
+    vector_t* b = vector_zeroes(n);
+    vector_t* x = vector_zeroes(n);
+    vector_t* inv_diag = vector_zeroes(n);
+    arena_t* ws = arena_init(gmres_workspace(n, m));
+    if (!b || !x || !inv_diag || !ws) {
+        vector_deinit(b);
+        vector_deinit(x);
+        vector_deinit(inv_diag);
+        arena_deinit(ws);
+        stats_deinit(stats);
+        return NULL;
+    }
+    for (size_t i = 0; i < n; ++i) {
+        b->data[i] = counter_double_range(n, i, -1.0, 1.0);
+        if (diag) {
+            inv_diag->data[i] = diag[i] != 0.0 ? 1.0 / diag[i] : 1.0;
+        }
+    }
+    preconditioner_fn const precond = diag ? jacobi_preconditioner : NULL;
+
+    gmres_info_t run;
+    gmres_info_t total = { 0 };
+    for (size_t i = 0; i < MAX_SAMPLES; ++i) {
+        memset(x->data, 0, n * sizeof(double));
+        instant_t start = instant_now();
+        int ret = solver(n, A, b->data, x->data, m, tol, max_restarts, precond, inv_diag->data, ws,
+                         &run);
+        instant_t stop = instant_now();
+        if (ret < 0) {
+            vector_deinit(b);
+            vector_deinit(x);
+            vector_deinit(inv_diag);
+            arena_deinit(ws);
+            stats_deinit(stats);
+            return NULL;
+        }
+        stats->samples[i] = compute_avg_latency(start, stop, 1);
+        if (i == 0) {
+            stats->resQ = run.residual;
+            stats->resH = (double)(run.nb_iterations);
+        }
+        total.t_arnoldi += run.t_arnoldi / MAX_SAMPLES;
+        total.t_givens += run.t_givens / MAX_SAMPLES;
+        total.t_update += run.t_update / MAX_SAMPLES;
+        total.t_total += run.t_total / MAX_SAMPLES;
+    }
+
+    if (info) {
+        // Iterations and residuals do not change from one run to the next
+        total.nb_restarts = run.nb_restarts;
+        total.nb_iterations = run.nb_iterations;
+        total.residual = run.residual;
+        *info = total;
+    }
+    vector_deinit(b);
+    vector_deinit(x);
+    vector_deinit(inv_diag);
+    arena_deinit(ws);
+    stats_compute(stats);
+    return stats;
+}
+
+stats_t* driver_gmres(size_t n, matrix_t* A, size_t m, double tol, size_t max_restarts,
+                      bool jacobi, gmres_info_t* info)
+{
+    vector_t* diag = vector_zeroes(n);
+    if (!diag) return NULL;
+    for (size_t i = 0; i < n; ++i) {
+        diag->data[i] = A->data[matrix_index(A, i, i)];
+    }
+    stats_t* stats = driver_gmres_run(jacobi ? "gmres_jacobi" : "gmres", gmres_dense, n, A,
+                                      jacobi ? diag->data : NULL, m, tol, max_restarts, info);
+    vector_deinit(diag);
+    return stats;
+}
+
+stats_t* driver_gmres_sparse(sparse_t const* A, size_t m, double tol, size_t max_restarts,
+                             bool jacobi, gmres_info_t* info)
+{
+    char title[BUF_LEN];
+    snprintf(title, BUF_LEN, "gmres%s_%s", jacobi ? "_jacobi" : "",
+             sparse_format_to_str(A->format));
+    size_t const n = sparse_rows(A);
+    assert(A->format == SPARSE_CSR);
+    vector_t* diag = vector_zeroes(n);
+    if (!diag) return NULL;
+    csr_diagonal(A->csr, diag->data);
+    stats_t* stats = driver_gmres_run(title, gmres_csr, n, A, jacobi ? diag->data : NULL, m, tol,
+                                      max_restarts, info);
+    vector_deinit(diag);
+    return stats;
+}
+
+int gmres_info_dump(char const* title, size_t size, gmres_info_t const* info,
+                    char const* filename)
+{
+    if (!info) return -1;
+
+    FILE* ofp = (filename == NULL) ? stdout : fopen(filename, "ab");
+    if (!ofp) return -1;
+
+    fprintf(ofp, "%s; %zu; %zu; %zu; %.3e; %2.3lf; %2.3lf; %2.3lf; %2.3lf\n", title, size,
+            info->nb_restarts, info->nb_iterations, info->residual, info->t_arnoldi,
+            info->t_givens, info->t_update, info->t_total);
+
+    if (filename) {
+        fclose(ofp);
+    }
+    return 0;
+}
+
+typedef size_t (*lanczos_fn)(size_t n, double const* x, void const* A, size_t deg_m,
+                             lanczos_reorth_t reorth, matrix_t* mat_Q, double* alpha,
+                             double* beta, arena_t* ws, lanczos_info_t* info);
+
+static size_t lanczos_dense(size_t n, double const* x, void const* A, size_t deg_m,
+                            lanczos_reorth_t reorth, matrix_t* mat_Q, double* alpha,
+                            double* beta, arena_t* ws, lanczos_info_t* info)
+{
+    return lanczos(n, x, A, deg_m, reorth, mat_Q, alpha, beta, ws, info);
+}
+
+static size_t lanczos_spmv(size_t n, double const* x, void const* A, size_t deg_m,
+                          lanczos_reorth_t reorth, matrix_t* mat_Q, double* alpha, double* beta,
+                          arena_t* ws, lanczos_info_t* info)
+{
+    return lanczos_sparse(n, x, A, deg_m, reorth, mat_Q, alpha, beta, ws, info);
+}
+
+static size_t lanczos_operator(size_t n, double const* x, void const* A, size_t deg_m,
+                               lanczos_reorth_t reorth, matrix_t* mat_Q, double* alpha,
+                               double* beta, arena_t* ws, lanczos_info_t* info)
+{
+    (void)(n);
+    return lanczos_op(x, A, deg_m, reorth, mat_Q, alpha, beta, ws, info);
+}
+
+/**
+ * Times `deg_m` Lanczos steps, Ritz values included. `resQ` is the loss of
+ * orthogonality of the basis, or 0 if it is not kept, and `resH` the largest
+ * Ritz value.
+ **/
+static stats_t* driver_lanczos_run(char const* title, lanczos_fn solver, size_t n, void const* A,
+                                   vector_t const* x, size_t deg_m, lanczos_reorth_t reorth,
+                                   bool keep_basis, size_t reps, lanczos_info_t* info)
+{
+    stats_t* stats = stats_init(title, n);
+    if (!stats) return NULL;
+
+    matrix_t* Q = keep_basis ? matrix_zeroes_layout(n, deg_m + 1, COL_MAJOR) : NULL;
+    // Diagonal, off-diagonal and their copies for the eigensolver
+    vector_t* T = vector_zeroes(4 * deg_m);
+    arena_t* ws = arena_init(lanczos_workspace(n, deg_m));
+    if ((keep_basis && !Q) || !T || !ws) {
+        matrix_deinit(Q);
+        vector_deinit(T);
+        arena_deinit(ws);
+        stats_deinit(stats);
+        return NULL;
+    }
+    double* alpha = T->data;
+    double* beta = alpha + deg_m;
+    double* d = beta + deg_m;
+    double* e = d + deg_m;
+
+    double elapsed;
+    size_t steps = 0;
+    for (size_t i = 0; i < MAX_SAMPLES; ++i) {
+        do {
+            instant_t start = instant_now();
+            for (size_t _ = 0; _ < reps; ++_) {
+                steps = solver(n, x->data, A, deg_m, reorth, Q, alpha, beta, ws, info);
+                memcpy(d, alpha, steps * sizeof(double));
+                memcpy(e, beta, steps * sizeof(double));
+                tridiagonal_eigen(steps, d, e, 0, NULL, steps);
+            }
+            instant_t stop = instant_now();
+            elapsed = compute_avg_latency(start, stop, reps);
+            if (i == 0) {
+                stats->resQ = Q ? orthogonality_loss(Q, steps) : 0.0;
+                stats->resH = steps > 0 ? d[steps - 1] : 0.0;
+            }
+        } while (elapsed <= 0.0);
+        stats->samples[i] = elapsed;
+    }
+
+    matrix_deinit(Q);
+    vector_deinit(T);
+    arena_deinit(ws);
+    stats_compute(stats);
+    return stats;
+}
+
+stats_t* driver_lanczos(size_t n, matrix_t* A, vector_t* x, size_t deg_m, lanczos_reorth_t reorth,
+                        size_t reps, lanczos_info_t* info)
+{
+    char title[BUF_LEN];
+    snprintf(title, BUF_LEN, "lanczos_%s", lanczos_reorth_to_str(reorth));
+    return driver_lanczos_run(title, lanczos_dense, n, A, x, deg_m, reorth, true, reps, info);
+}
+
+stats_t* driver_lanczos_sparse(sparse_t const* A, vector_t* x, size_t deg_m,
+                               lanczos_reorth_t reorth, size_t reps, lanczos_info_t* info)
+{
+    char title[BUF_LEN];
+    snprintf(title, BUF_LEN, "lanczos_%s_%s", lanczos_reorth_to_str(reorth),
+             sparse_format_to_str(A->format));
+    return driver_lanczos_run(title, lanczos_spmv, sparse_rows(A), A, x, deg_m, reorth, true,
+                              reps, info);
+}
+
+stats_t* driver_lanczos_op(char const* name, operator_t const* A, vector_t* x, size_t deg_m,
+                           lanczos_reorth_t reorth, size_t reps, lanczos_info_t* info)
+{
+    char title[BUF_LEN];
+    snprintf(title, BUF_LEN, "lanczos_%s_%s", lanczos_reorth_to_str(reorth), name);
+    return driver_lanczos_run(title, lanczos_operator, A->n, A, x, deg_m, reorth,
+                              reorth != LANCZOS_NO_REORTH, reps, info);
+}
+
+int lanczos_info_dump(char const* title, size_t size, lanczos_info_t const* info,
+                      char const* filename)
+{
+    if (!info) return -1;
+
+    FILE* ofp = (filename == NULL) ? stdout : fopen(filename, "ab");
+    if (!ofp) return -1;
+
+    fprintf(ofp, "%s; %zu; %zu; %zu; %2.3lf\n", title, size, info->nb_steps, info->nb_reorth,
+            info->t_reorth);
+
+    if (filename) {
+        fclose(ofp);
+    }
+    return 0;
+}
+
+stats_t* driver_laplacian(laplacian_t const* grid, size_t reps)
+{
+    char title[BUF_LEN];
+    snprintf(title, BUF_LEN, "laplacian_%zud", grid->dim);
+    size_t const n = laplacian_size(grid);
+    stats_t* stats = stats_init(title, n);
+    if (!stats) return NULL;
+
+    // A multiply and `2 dim` subtractions per point, `x` and `y` streamed once
+    stats->nb_flops = (2 * grid->dim + 1) * n;
+    stats->nb_bytes = 2 * n * sizeof(double);
+
+    vector_t* x = vector_zeroes(n);
+    vector_t* y = vector_zeroes(n);
+    if (!x || !y) {
+        vector_deinit(x);
+        vector_deinit(y);
+        stats_deinit(stats);
+        return NULL;
+    }
+    // Smoothest eigenvector, the product of the first sine mode along each axis
+    size_t const sides[3] = { grid->nx, grid->ny, grid->nz };
+    double const lambda = laplacian_min_eigval(grid);
+    for (size_t i = 0; i < n; ++i) {
+        size_t const coords[3] = { i % grid->nx, i / grid->nx % grid->ny,
+                                   i / (grid->nx * grid->ny) };
+        x->data[i] = 1.0;
+        for (size_t d = 0; d < grid->dim; ++d) {
+            x->data[i] *= sin(M_PI * (double)(coords[d] + 1) / (double)(sides[d] + 1));
+        }
+    }
+
+    operator_t const A = laplacian_operator(grid);
+    double elapsed;
+    for (size_t i = 0; i < MAX_SAMPLES; ++i) {
+        do {
+            instant_t start = instant_now();
+            for (size_t _ = 0; _ < reps; ++_) {
+                operator_apply(&A, x->data, 1, y->data);
+            }
+            instant_t stop = instant_now();
+            elapsed = compute_avg_latency(start, stop, reps);
+            if (i == 0) {
+                // Residual of the eigenpair relative to ||A||, checks the stencil
+                double err = 0.0;
+                for (size_t r = 0; r < n; ++r) {
+                    double const diff = y->data[r] - lambda * x->data[r];
+                    err += diff * diff;
+                }
+                stats->resQ = sqrt(err) / (laplacian_max_eigval(grid) * dnrm2(n, x->data));
+                stats->resH = 0.0;
+            }
+        } while (elapsed <= 0.0);
+        stats->samples[i] = elapsed;
+    }
+
+    vector_deinit(x);
+    vector_deinit(y);
+    stats_compute(stats);
+    return stats;
+}
+
+typedef size_t (*block_arnoldi_fn)(size_t n, size_t b, matrix_t const* mat_X, void const* A,
+                                   size_t deg_m, matrix_t* mat_Q, matrix_t* mat_H, arena_t* ws);
+
+static size_t block_arnoldi_dense(size_t n, size_t b, matrix_t const* mat_X, void const* A,
+                                  size_t deg_m, matrix_t* mat_Q, matrix_t* mat_H, arena_t* ws)
+{
+    return block_arnoldi(n, b, mat_X, A, deg_m, mat_Q, mat_H, ws);
+}
+
+static size_t block_arnoldi_spmm(size_t n, size_t b, matrix_t const* mat_X, void const* A,
+                                 size_t deg_m, matrix_t* mat_Q, matrix_t* mat_H, arena_t* ws)
+{
+    return block_arnoldi_sparse(n, b, mat_X, A, deg_m, mat_Q, mat_H, ws);
+}
+
+/**
+ * Times a block Arnoldi of `deg_m` vectors started from the columns of `X`.
+ * `resQ` is the loss of orthogonality of the basis and `resH` the norm of
+ * `H`.
+ **/
+static stats_t* driver_block_arnoldi_run(char const* title, block_arnoldi_fn solver, size_t n,
+                                         void const* A, matrix_t const* X, size_t deg_m,
+                                         size_t reps)
+{
+    stats_t* stats = stats_init(title, n);
+    if (!stats) return NULL;
+
+    size_t const b = X->cols;
+    matrix_t* Q = matrix_zeroes_layout(n, deg_m + 1, COL_MAJOR);
     matrix_t* H = matrix_zeroes(deg_m + 1, deg_m);
+    arena_t* ws = arena_init(block_arnoldi_workspace(n, deg_m, b));
+    if (!Q || !H || !ws) {
+        matrix_deinit(Q);
+        matrix_deinit(H);
+        arena_deinit(ws);
+        stats_deinit(stats);
+        return NULL;
+    }
 
     double elapsed;
+    size_t built = 0;
     for (size_t i = 0; i < MAX_SAMPLES; ++i) {
         do {
             instant_t start = instant_now();
             for (size_t _ = 0; _ < reps; ++_) {
-                modified_gram_schmidt(n, x->data, A->data, deg_m, Q, H);
+                built = solver(n, b, X, A, deg_m, Q, H, ws);
             }
             instant_t stop = instant_now();
             elapsed = compute_avg_latency(start, stop, reps);
             if (i == 0) {
-                stats->resQ = dnrmf(Q->rows, Q->cols, Q->data);
-                stats->resH = dnrmf(H->rows, H->cols, H->data);
+                stats->resQ = orthogonality_loss(Q, built);
+                stats->resH = dnrmf_view(matrix_view(H));
             }
         } while (elapsed <= 0.0);
         stats->samples[i] = elapsed;
     }
 
+    matrix_deinit(Q);
+    matrix_deinit(H);
+    arena_deinit(ws);
     stats_compute(stats);
     return stats;
 }
+
+stats_t* driver_block_arnoldi(size_t n, matrix_t* A, matrix_t const* X, size_t deg_m,
+                              size_t reps)
+{
+    char title[BUF_LEN];
+    snprintf(title, BUF_LEN, "block_arnoldi_b%zu%s", X->cols, matrix_is_padded(A) ? "_padded" : "");
+    return driver_block_arnoldi_run(title, block_arnoldi_dense, n, A, X, deg_m, reps);
+}
+
+stats_t* driver_block_arnoldi_sparse(sparse_t const* A, matrix_t const* X, size_t deg_m,
+                                     size_t reps)
+{
+    char title[BUF_LEN];
+    snprintf(title, BUF_LEN, "block_arnoldi_b%zu_%s", X->cols, sparse_format_to_str(A->format));
+    return driver_block_arnoldi_run(title, block_arnoldi_spmm, sparse_rows(A), A, X, deg_m, reps);
+}
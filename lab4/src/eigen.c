@@ -0,0 +1,575 @@
+#include "eigen.h"
+
+#include <float.h>
+#include <stdbool.h>
+#include <math.h>
+
+// Iterations allowed to deflate a single eigenvalue (or pair) before giving up
+#define HQR_MAX_ITERS 60
+// Inverse iteration steps, starting from a vector of ones
+#define INVERSE_ITERS 3
+// QL iterations allowed to deflate a single eigenvalue of a tridiagonal matrix
+#define TQL_MAX_ITERS 30
+
+int hessenberg_eigvals(size_t n, double const* H, size_t ld, double complex* w, double* work)
+{
+    if (n == 0)
+        return 0;
+
+    // Working copy, indexed from 1 as in the EISPACK formulation of `hqr`
+    double(*restrict a)[n] = (double(*)[n])work;
+#define A(i, j) a[(i)-1][(j)-1]
+    double anorm = 0.0;
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = 0; j < n; ++j) {
+            a[i][j] = j + 1 >= i ? H[i * ld + j] : 0.0;
+            anorm += fabs(a[i][j]);
+        }
+    }
+
+    // `nn` is the last row of the active block, `t` the accumulated exceptional shifts
+    long nn = (long)(n);
+    double t = 0.0;
+    while (nn >= 1) {
+        size_t its = 0;
+        long l;
+        do {
+            // Look for a negligible subdiagonal element to split the matrix
+            for (l = nn; l >= 2; --l) {
+                double s = fabs(A(l - 1, l - 1)) + fabs(A(l, l));
+                if (s == 0.0) {
+                    s = anorm;
+                }
+                if (fabs(A(l, l - 1)) <= DBL_EPSILON * s) {
+                    A(l, l - 1) = 0.0;
+                    break;
+                }
+            }
+
+            double x = A(nn, nn);
+            if (l == nn) {
+                // One real root found
+                w[nn - 1] = x + t;
+                nn -= 1;
+                continue;
+            }
+
+            double y = A(nn - 1, nn - 1);
+            double ww = A(nn, nn - 1) * A(nn - 1, nn);
+            if (l == nn - 1) {
+                // Two roots found, from the trailing 2x2 block
+                double const p = 0.5 * (y - x);
+                double const q = p * p + ww;
+                double z = sqrt(fabs(q));
+                x += t;
+                if (q >= 0.0) {
+                    z = p + copysign(z, p);
+                    w[nn - 2] = x + z;
+                    w[nn - 1] = z != 0.0 ? x - ww / z : x + z;
+                }
+                else {
+                    w[nn - 2] = x + p + I * z;
+                    w[nn - 1] = x + p - I * z;
+                }
+                nn -= 2;
+                continue;
+            }
+
+            if (its == HQR_MAX_ITERS)
+                return -1;
+            if (its == 10 || its == 20) {
+                // Exceptional shift, to break out of a cycle
+                t += x;
+                for (long i = 1; i <= nn; ++i) {
+                    A(i, i) -= x;
+                }
+                double const s = fabs(A(nn, nn - 1)) + fabs(A(nn - 1, nn - 2));
+                x = y = 0.75 * s;
+                ww = -0.4375 * s * s;
+            }
+            its += 1;
+
+            // Look for two consecutive small subdiagonal elements
+            long m;
+            double p = 0.0, q = 0.0, r = 0.0, z;
+            for (m = nn - 2; m >= l; --m) {
+                z = A(m, m);
+                r = x - z;
+                double s = y - z;
+                p = (r * s - ww) / A(m + 1, m) + A(m, m + 1);
+                q = A(m + 1, m + 1) - z - r - s;
+                r = A(m + 2, m + 1);
+                s = fabs(p) + fabs(q) + fabs(r);
+                p /= s;
+                q /= s;
+                r /= s;
+                if (m == l)
+                    break;
+                double const u = fabs(A(m, m - 1)) * (fabs(q) + fabs(r));
+                double const v = fabs(p) * (fabs(A(m - 1, m - 1)) + fabs(z) + fabs(A(m + 1, m + 1)));
+                if (u <= DBL_EPSILON * v)
+                    break;
+            }
+            for (long i = m + 2; i <= nn; ++i) {
+                A(i, i - 2) = 0.0;
+                if (i != m + 2) {
+                    A(i, i - 3) = 0.0;
+                }
+            }
+
+            // Double QR step on rows `l..nn` and columns `m..nn`
+            for (long k = m; k <= nn - 1; ++k) {
+                if (k != m) {
+                    p = A(k, k - 1);
+                    q = A(k + 1, k - 1);
+                    r = k != nn - 1 ? A(k + 2, k - 1) : 0.0;
+                    x = fabs(p) + fabs(q) + fabs(r);
+                    if (x != 0.0) {
+                        p /= x;
+                        q /= x;
+                        r /= x;
+                    }
+                }
+                double const s = copysign(sqrt(p * p + q * q + r * r), p);
+                if (s == 0.0)
+                    continue;
+
+                if (k == m) {
+                    if (l != m) {
+                        A(k, k - 1) = -A(k, k - 1);
+                    }
+                }
+                else {
+                    A(k, k - 1) = -s * x;
+                }
+                p += s;
+                x = p / s;
+                y = q / s;
+                z = r / s;
+                q /= p;
+                r /= p;
+                // Row modification
+                for (long j = k; j <= nn; ++j) {
+                    p = A(k, j) + q * A(k + 1, j);
+                    if (k != nn - 1) {
+                        p += r * A(k + 2, j);
+                        A(k + 2, j) -= p * z;
+                    }
+                    A(k + 1, j) -= p * y;
+                    A(k, j) -= p * x;
+                }
+                // Column modification
+                long const i_end = nn < k + 3 ? nn : k + 3;
+                for (long i = l; i <= i_end; ++i) {
+                    p = x * A(i, k) + y * A(i, k + 1);
+                    if (k != nn - 1) {
+                        p += z * A(i, k + 2);
+                        A(i, k + 2) -= p * r;
+                    }
+                    A(i, k + 1) -= p * q;
+                    A(i, k) -= p;
+                }
+            }
+        } while (l < nn - 1);
+    }
+#undef A
+
+    return 0;
+}
+
+void hessenberg_eigvec(size_t n, double const* H, size_t ld, double complex lambda,
+                       double complex* y, double complex* work)
+{
+    double complex(*restrict lu)[n] = (double complex(*)[n])work;
+
+    // Perturb the shift so that `H - mu * I` is not exactly singular
+    double hnorm = 0.0;
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = i > 0 ? i - 1 : 0; j < n; ++j) {
+            hnorm += fabs(H[i * ld + j]);
+        }
+    }
+    double const tiny = (hnorm > 0.0 ? hnorm : 1.0) * DBL_EPSILON;
+    double complex const mu = lambda + tiny;
+
+    for (size_t i = 0; i < n; ++i) {
+        y[i] = 1.0;
+    }
+
+    for (size_t it = 0; it < INVERSE_ITERS; ++it) {
+        // Solve `(H - mu * I) z = y` by Gaussian elimination with partial
+        // pivoting: only the subdiagonal needs eliminating, so each step
+        // compares and combines two adjacent rows, right-hand side included.
+        for (size_t i = 0; i < n; ++i) {
+            for (size_t j = 0; j < n; ++j) {
+                lu[i][j] = j + 1 >= i ? H[i * ld + j] : 0.0;
+            }
+            lu[i][i] -= mu;
+        }
+        for (size_t k = 0; k + 1 < n; ++k) {
+            if (cabs(lu[k + 1][k]) > cabs(lu[k][k])) {
+                for (size_t j = k; j < n; ++j) {
+                    double complex const tmp = lu[k][j];
+                    lu[k][j] = lu[k + 1][j];
+                    lu[k + 1][j] = tmp;
+                }
+                double complex const tmp = y[k];
+                y[k] = y[k + 1];
+                y[k + 1] = tmp;
+            }
+            if (lu[k][k] == 0.0) {
+                lu[k][k] = tiny;
+            }
+            double complex const l = lu[k + 1][k] / lu[k][k];
+            for (size_t j = k + 1; j < n; ++j) {
+                lu[k + 1][j] -= l * lu[k][j];
+            }
+            y[k + 1] -= l * y[k];
+        }
+        if (lu[n - 1][n - 1] == 0.0) {
+            lu[n - 1][n - 1] = tiny;
+        }
+
+        // Back substitution, then normalization
+        double nrm = 0.0;
+        for (size_t i = n; i-- > 0;) {
+            double complex acc = y[i];
+            for (size_t j = i + 1; j < n; ++j) {
+                acc -= lu[i][j] * y[j];
+            }
+            y[i] = acc / lu[i][i];
+            nrm += creal(y[i] * conj(y[i]));
+        }
+        nrm = sqrt(nrm);
+        for (size_t i = 0; i < n; ++i) {
+            y[i] /= nrm;
+        }
+    }
+}
+
+void eigvals_sort_by_modulus(size_t n, double complex const* w, size_t* idx)
+{
+    for (size_t i = 0; i < n; ++i) {
+        idx[i] = i;
+    }
+    // Insertion sort, `n` is the size of a Krylov basis
+    for (size_t i = 1; i < n; ++i) {
+        size_t const cur = idx[i];
+        size_t j = i;
+        for (; j > 0 && cabs(w[idx[j - 1]]) < cabs(w[cur]); --j) {
+            idx[j] = idx[j - 1];
+        }
+        idx[j] = cur;
+    }
+}
+
+void hessenberg_shifted_qr(size_t n, double* H, size_t ld, double complex shift, size_t rows,
+                           double* Z, size_t ldz, double* work)
+{
+    double(*restrict M)[n] = (double(*)[n])work;
+    double* restrict v = work + n * n;
+
+    // M = H - mu * I, or H^2 - 2 Re(mu) H + |mu|^2 I for a complex pair
+    double const re = creal(shift);
+    double const abs2 = re * re + cimag(shift) * cimag(shift);
+    bool const pair = cimag(shift) != 0.0;
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = 0; j < n; ++j) {
+            double m_ij = 0.0;
+            if (pair) {
+                // H is Hessenberg, H[i][l] H[l][j] vanishes unless i - 1 <= l <= j + 1
+                size_t const l_end = j + 2 < n ? j + 2 : n;
+                for (size_t l = i > 0 ? i - 1 : 0; l < l_end; ++l) {
+                    m_ij += H[i * ld + l] * H[l * ld + j];
+                }
+                m_ij -= 2.0 * re * H[i * ld + j];
+            }
+            else {
+                m_ij = H[i * ld + j];
+            }
+            M[i][j] = m_ij;
+        }
+        M[i][i] -= pair ? -abs2 : re;
+    }
+
+    // Householder QR of M, applying each reflector to H on both sides and to
+    // Z on the right. M has at most two subdiagonals, so each reflector only
+    // spans two or three rows.
+    size_t const band = pair ? 2 : 1;
+    for (size_t k = 0; k + 1 < n; ++k) {
+        size_t const end = k + band + 1 < n ? k + band + 1 : n;
+        double alpha = 0.0;
+        for (size_t i = k; i < end; ++i) {
+            alpha += M[i][k] * M[i][k];
+        }
+        alpha = sqrt(alpha);
+        if (alpha == 0.0)
+            continue;
+        alpha = M[k][k] > 0.0 ? -alpha : alpha;
+
+        // v = M[k:end, k] - alpha e_1, normalized
+        double vnrm = 0.0;
+        for (size_t i = k; i < end; ++i) {
+            v[i] = M[i][k] - (i == k ? alpha : 0.0);
+            vnrm += v[i] * v[i];
+        }
+        if (vnrm == 0.0)
+            continue;
+        vnrm = sqrt(vnrm);
+        for (size_t i = k; i < end; ++i) {
+            v[i] /= vnrm;
+        }
+
+        // M <- (I - 2 v v^T) M
+        for (size_t j = k; j < n; ++j) {
+            double dot = 0.0;
+            for (size_t i = k; i < end; ++i) {
+                dot += v[i] * M[i][j];
+            }
+            for (size_t i = k; i < end; ++i) {
+                M[i][j] -= 2.0 * dot * v[i];
+            }
+        }
+        // H <- (I - 2 v v^T) H (I - 2 v v^T). Rows `k..end` are zero left of
+        // the bulge and columns `k..end` below row `end`, up to rounding
+        // errors that lie below the subdiagonal and are cleared at the end.
+        for (size_t j = k > 2 ? k - 2 : 0; j < n; ++j) {
+            double dot = 0.0;
+            for (size_t i = k; i < end; ++i) {
+                dot += v[i] * H[i * ld + j];
+            }
+            for (size_t i = k; i < end; ++i) {
+                H[i * ld + j] -= 2.0 * dot * v[i];
+            }
+        }
+        size_t const i_end = end + 1 < n ? end + 1 : n;
+        for (size_t i = 0; i < i_end; ++i) {
+            double dot = 0.0;
+            for (size_t j = k; j < end; ++j) {
+                dot += H[i * ld + j] * v[j];
+            }
+            for (size_t j = k; j < end; ++j) {
+                H[i * ld + j] -= 2.0 * dot * v[j];
+            }
+        }
+        // Z <- Z (I - 2 v v^T)
+        for (size_t i = 0; i < rows; ++i) {
+            double dot = 0.0;
+            for (size_t j = k; j < end; ++j) {
+                dot += Z[i * ldz + j] * v[j];
+            }
+            for (size_t j = k; j < end; ++j) {
+                Z[i * ldz + j] -= 2.0 * dot * v[j];
+            }
+        }
+    }
+
+    // The result is Hessenberg in exact arithmetic, clear the rounding fill-in
+    for (size_t i = 2; i < n; ++i) {
+        for (size_t j = 0; j + 1 < i; ++j) {
+            H[i * ld + j] = 0.0;
+        }
+    }
+}
+
+void eigvals_leja_order(size_t n, double complex const* w, double complex* shifts)
+{
+    // Candidates are the real eigenvalues and one of each conjugate pair
+    bool taken[n];
+    for (size_t i = 0; i < n; ++i) {
+        taken[i] = cimag(w[i]) < 0.0;
+    }
+
+    size_t count = 0;
+    while (count < n) {
+        size_t best = n;
+        double best_score = -INFINITY;
+        for (size_t i = 0; i < n; ++i) {
+            if (taken[i])
+                continue;
+            // Sum of the log-distances, to avoid overflowing the product
+            double score = count == 0 ? cabs(w[i]) : 0.0;
+            for (size_t j = 0; j < count && isfinite(score); ++j) {
+                score += log(cabs(w[i] - shifts[j]));
+            }
+            if (best == n || score > best_score) {
+                best = i;
+                best_score = score;
+            }
+        }
+        if (best == n)
+            break;
+
+        taken[best] = true;
+        shifts[count++] = w[best];
+        if (cimag(w[best]) > 0.0 && count < n) {
+            shifts[count++] = conj(w[best]);
+        }
+    }
+}
+
+int tridiagonal_eigen(size_t n, double* d, double* e, size_t rows, double* Z, size_t ldz)
+{
+    if (n == 0)
+        return 0;
+    e[n - 1] = 0.0;
+
+    for (size_t l = 0; l < n; ++l) {
+        size_t its = 0;
+        size_t m;
+        do {
+            // Look for a negligible off-diagonal element to split the matrix
+            for (m = l; m + 1 < n; ++m) {
+                double const dd = fabs(d[m]) + fabs(d[m + 1]);
+                if (fabs(e[m]) <= DBL_EPSILON * dd)
+                    break;
+            }
+            if (m == l)
+                break;
+            if (its++ == TQL_MAX_ITERS)
+                return -1;
+
+            // Wilkinson shift from the leading 2x2 block, chased up from row `m`
+            double g = (d[l + 1] - d[l]) / (2.0 * e[l]);
+            double r = sqrt(g * g + 1.0);
+            g = d[m] - d[l] + e[l] / (g + copysign(r, g));
+            double s = 1.0;
+            double c = 1.0;
+            double p = 0.0;
+            bool underflow = false;
+            for (size_t i = m; i-- > l;) {
+                double const f = s * e[i];
+                double const b = c * e[i];
+                r = sqrt(f * f + g * g);
+                e[i + 1] = r;
+                if (r == 0.0) {
+                    // Recover from underflow, the matrix splits at `i + 1`
+                    d[i + 1] -= p;
+                    e[m] = 0.0;
+                    underflow = true;
+                    break;
+                }
+                s = f / r;
+                c = g / r;
+                g = d[i + 1] - p;
+                r = (d[i] - g) * s + 2.0 * c * b;
+                p = s * r;
+                d[i + 1] = g + p;
+                g = c * r - b;
+
+                for (size_t k = 0; k < rows; ++k) {
+                    double* z = Z + k * ldz;
+                    double const z_next = z[i + 1];
+                    z[i + 1] = s * z[i] + c * z_next;
+                    z[i] = c * z[i] - s * z_next;
+                }
+            }
+            if (!underflow) {
+                d[l] -= p;
+                e[l] = g;
+                e[m] = 0.0;
+            }
+        } while (true);
+    }
+
+    // Selection sort, which moves each column of `Z` at most once
+    for (size_t i = 0; i + 1 < n; ++i) {
+        size_t min = i;
+        for (size_t j = i + 1; j < n; ++j) {
+            if (d[j] < d[min]) {
+                min = j;
+            }
+        }
+        if (min != i) {
+            double const tmp = d[i];
+            d[i] = d[min];
+            d[min] = tmp;
+            for (size_t k = 0; k < rows; ++k) {
+                double const z = Z[k * ldz + i];
+                Z[k * ldz + i] = Z[k * ldz + min];
+                Z[k * ldz + min] = z;
+            }
+        }
+    }
+
+    return 0;
+}
+
+void tridiagonal_eigvec(size_t n, double const* d, double const* e, double lambda, double* y,
+                        double* work)
+{
+    if (n == 0)
+        return;
+
+    // U has two superdiagonals because of the row interchanges
+    double* restrict l = work;
+    double* restrict u0 = work + n;
+    double* restrict u1 = work + 2 * n;
+    double* restrict u2 = work + 3 * n;
+    double* restrict swapped = work + 4 * n;
+    double tnorm = 0.0;
+    for (size_t i = 0; i < n; ++i) {
+        tnorm = fmax(tnorm, fabs(d[i]) + (i + 1 < n ? 2.0 * fabs(e[i]) : 0.0));
+    }
+    double const tiny = DBL_EPSILON * (tnorm > 0.0 ? tnorm : 1.0);
+
+    double c = d[0] - lambda;
+    double b = n > 1 ? e[0] : 0.0;
+    for (size_t i = 0; i + 1 < n; ++i) {
+        double const next_d = d[i + 1] - lambda;
+        double const next_e = i + 2 < n ? e[i + 1] : 0.0;
+        if (fabs(c) >= fabs(e[i])) {
+            c = c != 0.0 ? c : tiny;
+            l[i] = e[i] / c;
+            u0[i] = c;
+            u1[i] = b;
+            u2[i] = 0.0;
+            swapped[i] = 0.0;
+            c = next_d - l[i] * b;
+            b = next_e;
+        }
+        else {
+            l[i] = c / e[i];
+            u0[i] = e[i];
+            u1[i] = next_d;
+            u2[i] = next_e;
+            swapped[i] = 1.0;
+            c = b - l[i] * next_d;
+            b = -l[i] * next_e;
+        }
+    }
+    u0[n - 1] = fabs(c) > tiny ? c : tiny;
+
+    for (size_t i = 0; i < n; ++i) {
+        y[i] = 1.0;
+    }
+    for (size_t it = 0; it < INVERSE_ITERS; ++it) {
+        for (size_t i = 0; i + 1 < n; ++i) {
+            if (swapped[i] != 0.0) {
+                double const tmp = y[i];
+                y[i] = y[i + 1];
+                y[i + 1] = tmp;
+            }
+            y[i + 1] -= l[i] * y[i];
+        }
+        for (size_t i = n; i-- > 0;) {
+            double t = y[i];
+            if (i + 1 < n) {
+                t -= u1[i] * y[i + 1];
+            }
+            if (i + 2 < n) {
+                t -= u2[i] * y[i + 2];
+            }
+            y[i] = t / u0[i];
+        }
+
+        double nrm = 0.0;
+        for (size_t i = 0; i < n; ++i) {
+            nrm += y[i] * y[i];
+        }
+        nrm = sqrt(nrm);
+        for (size_t i = 0; i < n; ++i) {
+            y[i] /= nrm;
+        }
+    }
+}
@@ -1,23 +1,50 @@
+#include "blas.h"
 #include "drivers.h"
 #include "matrix.h"
+#include "mtx.h"
+#include "ooc.h"
+#include "sparse.h"
 #include "stats.h"
 #include "utils.h"
 
 #include <assert.h>
+#include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <unistd.h>
+
+// Non-zeros per row of the sparse operator generated when none is given
+#define SPARSE_NNZ_PER_ROW 16
+// Number of tiles the out-of-core kernels split the matrix into
+#define OOC_NB_TILES 16
+// Number of columns of the right-hand side of the out-of-core dgemm
+#define OOC_GEMM_COLS 8
+// Vectors per block of the s-step Arnoldi
+#define S_STEP_BLOCK 8
+// Starting vectors of the block Arnoldi
+#define ARNOLDI_BLOCK 4
+// Wanted eigenpairs, relative residual and restart budget of ERAM and IRAM
+#define ERAM_NB_WANTED 4
+#define ERAM_TOL 1e-8
+#define ERAM_MAX_RESTARTS 1000
+// Relative residual and restart budget of GMRES, whose restart length is the degree
+#define GMRES_TOL 1e-10
+#define GMRES_MAX_RESTARTS 100
+// Agreement expected between the largest Ritz values of the Lanczos variants
+#define LANCZOS_TOL 1e-8
 
 int main(int argc, char* argv[argc + 1])
 {
     if (argc < 4) {
-        fprintf(stderr, "Usage: %s <SIZE> <DEGREE> <REPETITIONS> [OUTFILE]\n", argv[0]);
+        fprintf(stderr, "Usage: %s <SIZE> <DEGREE> <REPETITIONS> [OUTFILE] [MATRIX.mtx]\n", argv[0]);
         return -1;
     }
 
     size_t const size = (size_t)(atoi(argv[1]));
     size_t const degree = (size_t)(atoi(argv[2]));
     size_t const reps = (size_t)(atoi(argv[3]));
-    char *outfile = argc == 5 ? argv[4] : NULL;
+    char *outfile = argc >= 5 ? argv[4] : NULL;
+    char *mtxfile = argc >= 6 ? argv[5] : NULL;
 
     matrix_t* A = matrix_rand_init(size, size);
     vector_t* x = vector_zeroes(size);
@@ -29,24 +56,356 @@ int main(int argc, char* argv[argc + 1])
             fprintf(stderr, "error: failed to open output file `%s`.", outfile);
             return -1;
         }
-        fprintf(ofp, "#%s; %s; %s; %s; %s; %s; %s\n",
-                "title", "size", "min", "mean", "max", "median", "stddevp");
+        fprintf(ofp, "#%s; %s; %s; %s; %s; %s; %s; %s; %s\n",
+                "title", "size", "min", "mean", "max", "median", "stddevp", "GiB/s", "GFLOP/s");
         if (ofp != stdout) fclose(ofp);
     }
 
     stats_t* cgs = driver_cgs(size, A, x, degree, reps);
     stats_t* mgs = driver_mgs(size, A, x, degree, reps);
+    stats_t* cgs2 = driver_cgs2(size, A, x, degree, reps);
+    stats_t* cgs2_omp = driver_cgs2_omp(size, A, x, degree, reps);
+    stats_t* householder = driver_householder(size, A, x, degree, reps);
+    stats_t* sstep_monomial =
+        driver_s_step(size, A, x, degree, S_STEP_BLOCK, S_STEP_MONOMIAL, reps);
+    stats_t* sstep_newton = driver_s_step(size, A, x, degree, S_STEP_BLOCK, S_STEP_NEWTON, reps);
 
     double err_Q = compute_error(cgs->resQ, mgs->resQ);
     assert(err_Q <= ERR_TOL);
     double err_H = compute_error(cgs->resH, mgs->resH);
     assert(err_H <= ERR_TOL);
+    err_Q = compute_error(cgs2->resQ, mgs->resQ);
+    assert(err_Q <= ERR_TOL);
+    err_H = compute_error(cgs2->resH, mgs->resH);
+    assert(err_H <= ERR_TOL);
+    err_Q = compute_error(cgs2_omp->resQ, cgs2->resQ);
+    assert(err_Q <= ERR_TOL);
+    err_H = compute_error(cgs2_omp->resH, cgs2->resH);
+    assert(err_H <= ERR_TOL);
+    err_Q = compute_error(householder->resQ, mgs->resQ);
+    assert(err_Q <= ERR_TOL);
+    err_H = compute_error(householder->resH, mgs->resH);
+    assert(err_H <= ERR_TOL);
+    // The monomial basis loses digits as the blocks grow, only Newton is checked
+    err_H = compute_error(sstep_newton->resH, mgs->resH);
+    assert(err_H <= ERR_TOL);
 
     stats_dump(cgs, outfile);
     stats_dump(mgs, outfile);
+    stats_dump(cgs2, outfile);
+    stats_dump(cgs2_omp, outfile);
+    stats_dump(householder, outfile);
+    stats_dump(sstep_monomial, outfile);
+    stats_dump(sstep_newton, outfile);
+    driver_orthogonality(size, A, x, degree, S_STEP_BLOCK, outfile);
+
+    // Same runs without padding, where the size would alias in cache
+    if (matrix_is_padded(A)) {
+        matrix_set_padding(false);
+        matrix_t* A_unpadded = matrix_copy(A);
+        stats_t* cgs_unpadded = driver_cgs(size, A_unpadded, x, degree, reps);
+        stats_t* mgs_unpadded = driver_mgs(size, A_unpadded, x, degree, reps);
+        matrix_set_padding(true);
+
+        err_Q = compute_error(cgs->resQ, cgs_unpadded->resQ);
+        assert(err_Q <= ERR_TOL);
+        err_H = compute_error(mgs->resH, mgs_unpadded->resH);
+        assert(err_H <= ERR_TOL);
+
+        stats_dump(cgs_unpadded, outfile);
+        stats_dump(mgs_unpadded, outfile);
+
+        stats_deinit(cgs_unpadded);
+        stats_deinit(mgs_unpadded);
+        matrix_deinit(A_unpadded);
+    }
+
+    // Block Arnoldi from the first canonical vectors, on as many whole blocks
+    // as the degree allows
+    size_t const block_degree = degree / ARNOLDI_BLOCK * ARNOLDI_BLOCK;
+    if (block_degree >= 2 * ARNOLDI_BLOCK && size >= ARNOLDI_BLOCK) {
+        matrix_t* X = matrix_zeroes_layout(size, ARNOLDI_BLOCK, COL_MAJOR);
+        assert(X);
+        for (size_t j = 0; j < ARNOLDI_BLOCK; ++j) {
+            X->data[j * X->ld + j] = 1.0;
+        }
+        stats_t* block = driver_block_arnoldi(size, A, X, block_degree, reps);
+        assert(block && block->resQ <= ERR_TOL);
+        stats_dump(block, outfile);
+        stats_deinit(block);
+        matrix_deinit(X);
+    }
 
     stats_deinit(cgs);
     stats_deinit(mgs);
+    stats_deinit(cgs2);
+    stats_deinit(cgs2_omp);
+    stats_deinit(householder);
+    stats_deinit(sstep_monomial);
+    stats_deinit(sstep_newton);
+
+    // Largest eigenvalues of `A`, with a basis of `degree` vectors
+    if (degree > ERAM_NB_WANTED) {
+        arnoldi_info_t eram_info = { 0 };
+        stats_t* eram_stats = driver_eram(size, A, x, ERAM_NB_WANTED, degree, ERAM_TOL,
+                                          ERAM_MAX_RESTARTS, &eram_info);
+        if (!eram_stats) {
+            fprintf(stderr, "error: ERAM converged %zu of %d eigenpairs in %zu restarts.\n",
+                    eram_info.nb_converged, ERAM_NB_WANTED, eram_info.nb_restarts);
+            return -1;
+        }
+        stats_dump(eram_stats, outfile);
+        arnoldi_info_dump("eram_info", size, &eram_info, outfile);
+        stats_deinit(eram_stats);
+    }
+
+    // Same eigenpairs with implicit restarts, which needs fewer matvecs
+    if (degree >= ERAM_NB_WANTED + 3) {
+        arnoldi_info_t iram_info = { 0 };
+        stats_t* iram_stats = driver_iram(size, A, x, ERAM_NB_WANTED, degree, ERAM_TOL,
+                                          ERAM_MAX_RESTARTS, &iram_info);
+        if (!iram_stats) {
+            fprintf(stderr, "error: IRAM converged %zu of %d eigenpairs in %zu restarts.\n",
+                    iram_info.nb_converged, ERAM_NB_WANTED, iram_info.nb_restarts);
+            return -1;
+        }
+        stats_dump(iram_stats, outfile);
+        arnoldi_info_dump("iram_info", size, &iram_info, outfile);
+        stats_deinit(iram_stats);
+    }
+
+    // Linear solves on `A` shifted by `sqrt(size) I`, which moves its spectrum,
+    // a disc of radius about `sqrt(size / 3)`, away from the origin
+    matrix_t* A_shifted = matrix_copy(A);
+    assert(A_shifted);
+    for (size_t i = 0; i < size; ++i) {
+        A_shifted->data[matrix_index(A_shifted, i, i)] += sqrt((double)(size));
+    }
+    gmres_info_t gmres_info;
+    gmres_info_t gmres_jacobi_info;
+    stats_t* gmres_stats =
+        driver_gmres(size, A_shifted, degree, GMRES_TOL, GMRES_MAX_RESTARTS, false, &gmres_info);
+    stats_t* gmres_jacobi_stats = driver_gmres(size, A_shifted, degree, GMRES_TOL,
+                                               GMRES_MAX_RESTARTS, true, &gmres_jacobi_info);
+    assert(gmres_stats && gmres_jacobi_stats);
+    assert(gmres_stats->resQ <= GMRES_TOL && gmres_jacobi_stats->resQ <= GMRES_TOL);
+    stats_dump(gmres_stats, outfile);
+    stats_dump(gmres_jacobi_stats, outfile);
+    gmres_info_dump("gmres_info", size, &gmres_info, outfile);
+    gmres_info_dump("gmres_jacobi_info", size, &gmres_jacobi_info, outfile);
+    stats_deinit(gmres_stats);
+    stats_deinit(gmres_jacobi_stats);
+    matrix_deinit(A_shifted);
+
+    // Lanczos on the symmetric part of `A`, with every reorthogonalization
+    matrix_t* A_sym = matrix_copy(A);
+    assert(A_sym);
+    for (size_t i = 0; i < size; ++i) {
+        for (size_t j = 0; j < size; ++j) {
+            A_sym->data[matrix_index(A_sym, i, j)] =
+                0.5 * (A->data[matrix_index(A, i, j)] + A->data[matrix_index(A, j, i)]);
+        }
+    }
+    lanczos_reorth_t const reorths[] = {
+        LANCZOS_NO_REORTH, LANCZOS_SELECTIVE, LANCZOS_PARTIAL, LANCZOS_FULL
+    };
+    stats_t* lanczos_stats[4];
+    for (size_t r = 0; r < 4; ++r) {
+        lanczos_info_t info;
+        lanczos_stats[r] = driver_lanczos(size, A_sym, x, degree, reorths[r], reps, &info);
+        assert(lanczos_stats[r]);
+        stats_dump(lanczos_stats[r], outfile);
+        char title[BUF_LEN];
+        snprintf(title, BUF_LEN, "lanczos_%s_info", lanczos_reorth_to_str(reorths[r]));
+        lanczos_info_dump(title, size, &info, outfile);
+    }
+    for (size_t r = 1; r < 3; ++r) {
+        double const err_ritz = compute_error(lanczos_stats[r]->resH, lanczos_stats[3]->resH);
+        assert(err_ritz <= LANCZOS_TOL);
+    }
+    for (size_t r = 0; r < 4; ++r) {
+        stats_deinit(lanczos_stats[r]);
+    }
+    matrix_deinit(A_sym);
+
+    // Matrix-free Laplacians with about `size^2` unknowns, as many as `A` has
+    // entries, of which Lanczos without reorthogonalization stores a few vectors
+    for (size_t dim = 2; dim <= 3; ++dim) {
+        size_t const side = dim == 2 ? size : (size_t)(cbrt((double)(size * size)) + 0.5);
+        laplacian_t const grid = laplacian_init(dim, side);
+        operator_t const op = laplacian_operator(&grid);
+        stats_t* stencil = driver_laplacian(&grid, reps);
+        assert(stencil && stencil->resQ <= ERR_TOL);
+
+        char name[BUF_LEN];
+        snprintf(name, BUF_LEN, "laplacian_%zud", dim);
+        vector_t* x_op = vector_ones(op.n);
+        lanczos_info_t info;
+        stats_t* lanczos_op =
+            driver_lanczos_op(name, &op, x_op, degree, LANCZOS_NO_REORTH, reps, &info);
+        // Ritz values lie within the spectrum
+        assert(lanczos_op);
+        assert(lanczos_op->resH <= laplacian_max_eigval(&grid) * (1.0 + ERR_TOL));
+
+        stats_dump(stencil, outfile);
+        stats_dump(lanczos_op, outfile);
+        stats_deinit(stencil);
+        stats_deinit(lanczos_op);
+        vector_deinit(x_op);
+    }
+
+    // Sparse operator, either read from a Matrix Market file or generated
+    csr_t* csr = mtxfile != NULL ? mtx_read_csr(mtxfile) : csr_rand_init(size, SPARSE_NNZ_PER_ROW);
+    if (!csr || csr->rows != csr->cols) {
+        fprintf(stderr, "error: failed to load a square sparse matrix.\n");
+        csr_deinit(csr);
+        matrix_deinit(A);
+        vector_deinit(x);
+        return -1;
+    }
+    sell_t* sell = sell_from_csr(csr, SELL_CHUNK_HEIGHT, SELL_SIGMA);
+    sparse_t const sparse_csr = { .format = SPARSE_CSR, .csr = csr };
+    sparse_t const sparse_sell = { .format = SPARSE_SELL, .sell = sell };
+    vector_t* x_sparse = vector_zeroes(csr->rows);
+    x_sparse->data[0] = 1.0;
+
+    stats_t* spmv_csr = driver_spmv(&sparse_csr, reps);
+    stats_t* spmv_sell = driver_spmv(&sparse_sell, reps);
+    stats_t* cgs_csr = driver_cgs_sparse(&sparse_csr, x_sparse, degree, reps);
+    stats_t* cgs_sell = driver_cgs_sparse(&sparse_sell, x_sparse, degree, reps);
+    stats_t* mgs_sell = driver_mgs_sparse(&sparse_sell, x_sparse, degree, reps);
+    stats_t* cgs2_sell = driver_cgs2_sparse(&sparse_sell, x_sparse, degree, reps);
+
+    matrix_t* X_sparse = NULL;
+    stats_t* block_csr = NULL;
+    stats_t* block_sell = NULL;
+    if (block_degree >= 2 * ARNOLDI_BLOCK && csr->rows >= ARNOLDI_BLOCK) {
+        X_sparse = matrix_zeroes_layout(csr->rows, ARNOLDI_BLOCK, COL_MAJOR);
+        assert(X_sparse);
+        for (size_t j = 0; j < ARNOLDI_BLOCK; ++j) {
+            X_sparse->data[j * X_sparse->ld + j] = 1.0;
+        }
+        block_csr = driver_block_arnoldi_sparse(&sparse_csr, X_sparse, block_degree, reps);
+        block_sell = driver_block_arnoldi_sparse(&sparse_sell, X_sparse, block_degree, reps);
+        assert(block_csr && block_sell);
+    }
+
+    double err_y = compute_error(spmv_csr->resQ, spmv_sell->resQ);
+    assert(err_y <= ERR_TOL);
+    err_Q = compute_error(cgs_csr->resQ, cgs_sell->resQ);
+    assert(err_Q <= ERR_TOL);
+    err_H = compute_error(cgs_sell->resH, mgs_sell->resH);
+    assert(err_H <= ERR_TOL);
+    err_H = compute_error(cgs2_sell->resH, mgs_sell->resH);
+    assert(err_H <= ERR_TOL);
+
+    stats_dump(spmv_csr, outfile);
+    stats_dump(spmv_sell, outfile);
+    stats_dump(cgs_csr, outfile);
+    stats_dump(cgs_sell, outfile);
+    stats_dump(mgs_sell, outfile);
+    stats_dump(cgs2_sell, outfile);
+    if (block_csr && block_sell) {
+        err_H = compute_error(block_csr->resH, block_sell->resH);
+        assert(err_H <= ERR_TOL);
+        assert(block_sell->resQ <= ERR_TOL);
+        stats_dump(block_csr, outfile);
+        stats_dump(block_sell, outfile);
+    }
+
+    // Lanczos only applies to symmetric operators, such as some given matrices
+    if (csr_is_symmetric(csr)) {
+        lanczos_info_t info_csr;
+        lanczos_info_t info_sell;
+        stats_t* lanczos_csr =
+            driver_lanczos_sparse(&sparse_csr, x_sparse, degree, LANCZOS_PARTIAL, reps, &info_csr);
+        stats_t* lanczos_sell = driver_lanczos_sparse(&sparse_sell, x_sparse, degree,
+                                                      LANCZOS_PARTIAL, reps, &info_sell);
+        assert(lanczos_csr && lanczos_sell);
+        double const err_ritz = compute_error(lanczos_csr->resH, lanczos_sell->resH);
+        assert(err_ritz <= LANCZOS_TOL);
+        stats_dump(lanczos_csr, outfile);
+        stats_dump(lanczos_sell, outfile);
+        lanczos_info_dump("lanczos_partial_csr_info", csr->rows, &info_csr, outfile);
+        lanczos_info_dump("lanczos_partial_sell_info", csr->rows, &info_sell, outfile);
+        stats_deinit(lanczos_csr);
+        stats_deinit(lanczos_sell);
+    }
+
+    // GMRES only on a given matrix, the generated one being far from any
+    // well-posed problem: its convergence is reported but not checked
+    if (mtxfile != NULL) {
+        gmres_info_t info;
+        for (int jacobi = 0; jacobi < 2; ++jacobi) {
+            stats_t* gmres_csr = driver_gmres_sparse(&sparse_csr, degree, GMRES_TOL,
+                                                     GMRES_MAX_RESTARTS, jacobi, &info);
+            assert(gmres_csr);
+            stats_dump(gmres_csr, outfile);
+            gmres_info_dump(jacobi ? "gmres_jacobi_csr_info" : "gmres_csr_info", csr->rows, &info,
+                            outfile);
+            stats_deinit(gmres_csr);
+        }
+    }
+
+    stats_deinit(spmv_csr);
+    stats_deinit(spmv_sell);
+    stats_deinit(cgs_csr);
+    stats_deinit(cgs_sell);
+    stats_deinit(mgs_sell);
+    stats_deinit(cgs2_sell);
+    stats_deinit(block_csr);
+    stats_deinit(block_sell);
+    matrix_deinit(X_sparse);
+    vector_deinit(x_sparse);
+    sell_deinit(sell);
+    csr_deinit(csr);
+
+    // Out-of-core kernels, streaming `A` back from a temporary binary file
+    char path[] = "/tmp/arnoldi-XXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0 || matrix_write(A, path) != 0) {
+        fprintf(stderr, "error: failed to write temporary matrix file.\n");
+        matrix_deinit(A);
+        vector_deinit(x);
+        return -1;
+    }
+    close(fd);
+    ooc_matrix_t* A_ooc = ooc_open(path);
+    // The file stays readable through `A_ooc` until it is closed
+    unlink(path);
+    if (!A_ooc) {
+        matrix_deinit(A);
+        vector_deinit(x);
+        return -1;
+    }
+
+    size_t const tile_bytes = size * size * sizeof(double) / OOC_NB_TILES;
+    ooc_stats_t io_gemv;
+    ooc_stats_t io_gemm;
+    stats_t* ooc_gemv = driver_ooc_dgemv(A_ooc, tile_bytes, 1, &io_gemv);
+    stats_t* ooc_gemm = driver_ooc_dgemm(A_ooc, OOC_GEMM_COLS, tile_bytes, 1, &io_gemm);
+    assert(ooc_gemv && ooc_gemm);
+
+    // Same product in memory, with the `x` used by `driver_ooc_dgemv`
+    vector_t* x_ref = vector_zeroes(size);
+    vector_t* y_ref = vector_zeroes(size);
+    for (size_t i = 0; i < size; ++i) {
+        x_ref->data[i] = counter_double_range(size, i, -1.0, 1.0);
+    }
+    dgemv_view(1.0, matrix_view(A), matrix_col(x_ref, 0), 0.0, matrix_col(y_ref, 0));
+    double err_ooc = compute_error(dnrm2(size, y_ref->data), ooc_gemv->resQ);
+    assert(err_ooc <= ERR_TOL);
+    vector_deinit(x_ref);
+    vector_deinit(y_ref);
+
+    stats_dump(ooc_gemv, outfile);
+    stats_dump(ooc_gemm, outfile);
+    ooc_stats_dump("ooc_dgemv_io", &io_gemv, outfile);
+    ooc_stats_dump("ooc_dgemm_io", &io_gemm, outfile);
+
+    stats_deinit(ooc_gemv);
+    stats_deinit(ooc_gemm);
+    ooc_close(A_ooc);
     matrix_deinit(A);
     vector_deinit(x);
 
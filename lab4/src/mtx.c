@@ -0,0 +1,572 @@
+#include "mtx.h"
+#include "utils.h"
+
+#include <fcntl.h>
+#include <math.h>
+#include <omp.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Maximum number of significant digits accumulated by `parse_double`
+#define MAX_DIGITS 19
+
+typedef enum mtx_format_e {
+    MTX_COORDINATE,
+    MTX_ARRAY,
+} mtx_format_t;
+
+typedef enum mtx_field_e {
+    MTX_REAL,
+    MTX_INTEGER,
+    MTX_PATTERN,
+} mtx_field_t;
+
+typedef enum mtx_symmetry_e {
+    MTX_GENERAL,
+    MTX_SYMMETRIC,
+    MTX_SKEW_SYMMETRIC,
+} mtx_symmetry_t;
+
+/**
+ * Memory-mapped Matrix Market file, with its parsed header.
+ **/
+typedef struct mtx_file_s {
+    char* map;
+    size_t len;
+    // First byte after the size line
+    char const* body;
+    mtx_format_t format;
+    mtx_field_t field;
+    mtx_symmetry_t symmetry;
+    size_t rows;
+    size_t cols;
+    // Number of entries stored in the file, before symmetric expansion
+    size_t nb_entries;
+} mtx_file_t;
+
+/**
+ * Entries of a Matrix Market file, 0-based, as stored in the file.
+ **/
+typedef struct mtx_entries_s {
+    size_t* rows;
+    size_t* cols;
+    double* values;
+    size_t len;
+} mtx_entries_t;
+
+// Exactly representable powers of ten
+static double const POW10[] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+};
+
+static inline bool is_digit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+static inline char const* skip_blanks(char const* p, char const* end)
+{
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\r')) {
+        ++p;
+    }
+    return p;
+}
+
+static inline char const* next_line(char const* p, char const* end)
+{
+    char const* nl = memchr(p, '\n', (size_t)(end - p));
+    return nl ? nl + 1 : end;
+}
+
+/**
+ * Whether the line starting at `p` holds an entry, i.e. is neither blank nor
+ * a comment.
+ **/
+static inline bool is_entry_line(char const* p, char const* end)
+{
+    p = skip_blanks(p, end);
+    return p < end && *p != '\n' && *p != '%';
+}
+
+/**
+ * Parses an unsigned integer. Returns the position after it, or NULL if there
+ * is none.
+ **/
+static char const* parse_size(char const* p, char const* end, size_t* val)
+{
+    p = skip_blanks(p, end);
+    if (p == end || !is_digit(*p))
+        return NULL;
+
+    size_t res = 0;
+    for (; p < end && is_digit(*p); ++p) {
+        res = res * 10 + (size_t)(*p - '0');
+    }
+
+    *val = res;
+    return p;
+}
+
+/**
+ * Parses a decimal floating-point number (with an optional `e`/`E`/`d`/`D`
+ * exponent). The first `MAX_DIGITS` significant digits are accumulated in an
+ * integer and scaled once by a power of ten, which is exact when both fit in a
+ * double. Returns the position after the number, or NULL if there is none.
+ **/
+static char const* parse_double(char const* p, char const* end, double* val)
+{
+    p = skip_blanks(p, end);
+
+    bool neg = false;
+    if (p < end && (*p == '-' || *p == '+')) {
+        neg = *p == '-';
+        ++p;
+    }
+
+    uint64_t mant = 0;
+    int nb_digits = 0;
+    int exp10 = 0;
+    bool has_digits = false;
+    for (; p < end && is_digit(*p); ++p) {
+        has_digits = true;
+        if (nb_digits < MAX_DIGITS) {
+            mant = mant * 10 + (uint64_t)(*p - '0');
+            nb_digits += mant != 0;
+        }
+        else {
+            exp10 += 1;
+        }
+    }
+    if (p < end && *p == '.') {
+        for (++p; p < end && is_digit(*p); ++p) {
+            has_digits = true;
+            if (nb_digits < MAX_DIGITS) {
+                mant = mant * 10 + (uint64_t)(*p - '0');
+                nb_digits += mant != 0;
+                exp10 -= 1;
+            }
+        }
+    }
+    if (!has_digits)
+        return NULL;
+
+    if (p < end && (*p == 'e' || *p == 'E' || *p == 'd' || *p == 'D')) {
+        char const* q = p + 1;
+        bool exp_neg = false;
+        if (q < end && (*q == '-' || *q == '+')) {
+            exp_neg = *q == '-';
+            ++q;
+        }
+        if (q < end && is_digit(*q)) {
+            int exp = 0;
+            for (; q < end && is_digit(*q); ++q) {
+                exp = exp < 100000 ? exp * 10 + (*q - '0') : exp;
+            }
+            exp10 += exp_neg ? -exp : exp;
+            p = q;
+        }
+    }
+
+    double res = (double)(mant);
+    if (mant == 0 || exp10 == 0) {
+        // Nothing to scale
+    }
+    else if (exp10 > 0 && exp10 <= 22) {
+        res *= POW10[exp10];
+    }
+    else if (exp10 < 0 && exp10 >= -22) {
+        res /= POW10[-exp10];
+    }
+    else {
+        res *= pow(10.0, exp10);
+    }
+
+    *val = neg ? -res : res;
+    return p;
+}
+
+/**
+ * Maps a Matrix Market file and parses its banner and size line.
+ **/
+static bool mtx_open(char const* filename, mtx_file_t* file)
+{
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "error: failed to open file `%s`\n", filename);
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        fprintf(stderr, "error: failed to read from file `%s`\n", filename);
+        close(fd);
+        return false;
+    }
+
+    file->len = (size_t)(st.st_size);
+    file->map = mmap(NULL, file->len, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (file->map == MAP_FAILED) {
+        fprintf(stderr, "error: failed to map file `%s`\n", filename);
+        return false;
+    }
+    madvise(file->map, file->len, MADV_SEQUENTIAL);
+
+    char const* end = file->map + file->len;
+    char const* line_end = next_line(file->map, end);
+
+    // Banner: `%%MatrixMarket matrix <format> <field> <symmetry>`
+    char banner[BUF_LEN] = { 0 };
+    char object[BUF_LEN], format[BUF_LEN], field[BUF_LEN], symmetry[BUF_LEN];
+    memcpy(banner, file->map, (size_t)(line_end - file->map) < BUF_LEN - 1
+                                  ? (size_t)(line_end - file->map)
+                                  : BUF_LEN - 1);
+    if (sscanf(banner, "%%%%MatrixMarket %255s %255s %255s %255s", object, format, field,
+               symmetry) != 4 ||
+        strcasecmp(object, "matrix") != 0) {
+        fprintf(stderr, "error: `%s` is not a Matrix Market matrix file\n", filename);
+        goto error;
+    }
+
+    if (strcasecmp(format, "coordinate") == 0) {
+        file->format = MTX_COORDINATE;
+    }
+    else if (strcasecmp(format, "array") == 0) {
+        file->format = MTX_ARRAY;
+    }
+    else {
+        fprintf(stderr, "error: unsupported Matrix Market format `%s`\n", format);
+        goto error;
+    }
+
+    if (strcasecmp(field, "real") == 0 || strcasecmp(field, "double") == 0) {
+        file->field = MTX_REAL;
+    }
+    else if (strcasecmp(field, "integer") == 0) {
+        file->field = MTX_INTEGER;
+    }
+    else if (strcasecmp(field, "pattern") == 0 && file->format == MTX_COORDINATE) {
+        file->field = MTX_PATTERN;
+    }
+    else {
+        fprintf(stderr, "error: unsupported Matrix Market field `%s`\n", field);
+        goto error;
+    }
+
+    if (strcasecmp(symmetry, "general") == 0) {
+        file->symmetry = MTX_GENERAL;
+    }
+    else if (strcasecmp(symmetry, "symmetric") == 0) {
+        file->symmetry = MTX_SYMMETRIC;
+    }
+    else if (strcasecmp(symmetry, "skew-symmetric") == 0) {
+        file->symmetry = MTX_SKEW_SYMMETRIC;
+    }
+    else {
+        fprintf(stderr, "error: unsupported Matrix Market symmetry `%s`\n", symmetry);
+        goto error;
+    }
+
+    // Skip comments up to the size line
+    char const* p = line_end;
+    while (p < end && !is_entry_line(p, end)) {
+        p = next_line(p, end);
+    }
+
+    p = parse_size(p, end, &file->rows);
+    if (p) {
+        p = parse_size(p, end, &file->cols);
+    }
+    if (p && file->format == MTX_COORDINATE) {
+        p = parse_size(p, end, &file->nb_entries);
+    }
+    if (!p || (file->symmetry != MTX_GENERAL && file->rows != file->cols)) {
+        fprintf(stderr, "error: invalid Matrix Market size line in `%s`\n", filename);
+        goto error;
+    }
+
+    if (file->format == MTX_ARRAY) {
+        size_t const n = file->rows;
+        switch (file->symmetry) {
+            case MTX_GENERAL:
+                file->nb_entries = file->rows * file->cols;
+                break;
+            case MTX_SYMMETRIC:
+                file->nb_entries = n * (n + 1) / 2;
+                break;
+            case MTX_SKEW_SYMMETRIC:
+                file->nb_entries = n * (n - 1) / 2;
+                break;
+        }
+    }
+
+    file->body = next_line(p, end);
+    return true;
+
+error:
+    munmap(file->map, file->len);
+    return false;
+}
+
+/**
+ * Position of the `k`-th entry of an array file, which stores columns one
+ * after the other (only the lower triangle for symmetric variants).
+ **/
+static void array_position(mtx_file_t const* file, size_t k, size_t* i, size_t* j)
+{
+    if (file->symmetry == MTX_GENERAL) {
+        *i = k % file->rows;
+        *j = k / file->rows;
+        return;
+    }
+
+    // Column `c` holds the rows from `c` (or `c + 1` if skew) to the last one
+    size_t const skip = file->symmetry == MTX_SKEW_SYMMETRIC ? 1 : 0;
+    size_t c = 0;
+    while (k >= file->rows - c - skip) {
+        k -= file->rows - c - skip;
+        c += 1;
+    }
+    *i = c + skip + k;
+    *j = c;
+}
+
+/**
+ * Parses all the entries of a mapped file in parallel. The body is split into
+ * one chunk per thread at newline boundaries. A first pass counts the entries
+ * of each chunk, so that each thread knows where to store its entries during
+ * the second pass.
+ **/
+static bool mtx_parse_entries(mtx_file_t const* file, mtx_entries_t* entries)
+{
+    char const* const end = file->map + file->len;
+    size_t const body_len = (size_t)(end - file->body);
+    size_t const nb_chunks = (size_t)(omp_get_max_threads());
+
+    char const** bounds = malloc((nb_chunks + 1) * sizeof(char const*));
+    size_t* offsets = calloc(nb_chunks + 1, sizeof(size_t));
+    entries->len = file->nb_entries;
+    entries->rows = malloc(entries->len * sizeof(size_t) + 1);
+    entries->cols = malloc(entries->len * sizeof(size_t) + 1);
+    entries->values = malloc(entries->len * sizeof(double) + 1);
+    bool ok = bounds && offsets && entries->rows && entries->cols && entries->values;
+    if (!ok)
+        goto cleanup;
+
+    // Chunk boundaries, moved forward to the start of the next line
+    bounds[0] = file->body;
+    bounds[nb_chunks] = end;
+    for (size_t c = 1; c < nb_chunks; ++c) {
+        char const* p = file->body + body_len * c / nb_chunks;
+        p = p > file->body && p[-1] != '\n' ? next_line(p, end) : p;
+        bounds[c] = p > bounds[c - 1] ? p : bounds[c - 1];
+    }
+
+#pragma omp parallel for schedule(static, 1)
+    for (size_t c = 0; c < nb_chunks; ++c) {
+        size_t count = 0;
+        for (char const* p = bounds[c]; p < bounds[c + 1]; p = next_line(p, end)) {
+            count += is_entry_line(p, end);
+        }
+        offsets[c + 1] = count;
+    }
+
+    for (size_t c = 0; c < nb_chunks; ++c) {
+        offsets[c + 1] += offsets[c];
+    }
+    if (offsets[nb_chunks] != file->nb_entries) {
+        fprintf(stderr, "error: expected %zu Matrix Market entries, found %zu\n",
+                file->nb_entries, offsets[nb_chunks]);
+        ok = false;
+        goto cleanup;
+    }
+
+#pragma omp parallel for schedule(static, 1) reduction(&& : ok)
+    for (size_t c = 0; c < nb_chunks; ++c) {
+        size_t k = offsets[c];
+        size_t i = 0;
+        size_t j = 0;
+        if (file->format == MTX_ARRAY && k < file->nb_entries) {
+            array_position(file, k, &i, &j);
+        }
+
+        for (char const* p = bounds[c]; p < bounds[c + 1] && ok; p = next_line(p, end)) {
+            if (!is_entry_line(p, end))
+                continue;
+
+            double v = 1.0;
+            char const* q = p;
+            if (file->format == MTX_COORDINATE) {
+                q = parse_size(q, end, &i);
+                q = q ? parse_size(q, end, &j) : NULL;
+                if (q && file->field != MTX_PATTERN) {
+                    q = parse_double(q, end, &v);
+                }
+                // 1-based in the file
+                if (!q || i == 0 || j == 0 || i > file->rows || j > file->cols) {
+                    ok = false;
+                    break;
+                }
+                i -= 1;
+                j -= 1;
+            }
+            else {
+                q = parse_double(q, end, &v);
+                if (!q) {
+                    ok = false;
+                    break;
+                }
+            }
+
+            entries->rows[k] = i;
+            entries->cols[k] = j;
+            entries->values[k] = v;
+            k += 1;
+
+            // Next position in column-major order (lower triangle if symmetric)
+            if (file->format == MTX_ARRAY && ++i == file->rows) {
+                j += 1;
+                i = file->symmetry == MTX_GENERAL        ? 0
+                    : file->symmetry == MTX_SYMMETRIC    ? j
+                                                         : j + 1;
+            }
+        }
+    }
+    if (!ok) {
+        fprintf(stderr, "error: invalid Matrix Market entry\n");
+    }
+
+cleanup:
+    free(bounds);
+    free(offsets);
+    if (!ok) {
+        free(entries->rows);
+        free(entries->cols);
+        free(entries->values);
+    }
+    return ok;
+}
+
+static void mtx_close(mtx_file_t* file, mtx_entries_t* entries)
+{
+    if (entries) {
+        free(entries->rows);
+        free(entries->cols);
+        free(entries->values);
+    }
+    munmap(file->map, file->len);
+}
+
+matrix_t* mtx_read_dense(char const* filename)
+{
+    mtx_file_t file;
+    if (!mtx_open(filename, &file))
+        return NULL;
+
+    mtx_entries_t entries;
+    if (!mtx_parse_entries(&file, &entries)) {
+        mtx_close(&file, NULL);
+        return NULL;
+    }
+
+    matrix_t* self = matrix_zeroes(file.rows, file.cols);
+    if (!self) {
+        mtx_close(&file, &entries);
+        return NULL;
+    }
+
+    double const mirror = file.symmetry == MTX_SKEW_SYMMETRIC ? -1.0 : 1.0;
+#pragma omp parallel for schedule(static)
+    for (size_t k = 0; k < entries.len; ++k) {
+        size_t const i = entries.rows[k];
+        size_t const j = entries.cols[k];
+        // Atomic so that duplicate entries are summed
+#pragma omp atomic
+        self->data[matrix_index(self, i, j)] += entries.values[k];
+        if (file.symmetry != MTX_GENERAL && i != j) {
+#pragma omp atomic
+            self->data[matrix_index(self, j, i)] += mirror * entries.values[k];
+        }
+    }
+
+    mtx_close(&file, &entries);
+    return self;
+}
+
+csr_t* mtx_read_csr(char const* filename)
+{
+    mtx_file_t file;
+    if (!mtx_open(filename, &file))
+        return NULL;
+
+    mtx_entries_t entries;
+    if (!mtx_parse_entries(&file, &entries)) {
+        mtx_close(&file, NULL);
+        return NULL;
+    }
+
+    // Off-diagonal entries of symmetric matrices are stored twice
+    bool const is_general = file.symmetry == MTX_GENERAL;
+    size_t nb_mirrored = 0;
+#pragma omp parallel for reduction(+ : nb_mirrored)
+    for (size_t k = 0; k < entries.len; ++k) {
+        nb_mirrored += !is_general && entries.rows[k] != entries.cols[k];
+    }
+
+    csr_t* self = csr_init(file.rows, file.cols, entries.len + nb_mirrored);
+    size_t* fill = calloc(file.rows + 1, sizeof(size_t));
+    if (!self || !fill) {
+        csr_deinit(self);
+        free(fill);
+        mtx_close(&file, &entries);
+        return NULL;
+    }
+
+    // Count the non-zeros of each row, shifted by one for the prefix sum
+#pragma omp parallel for schedule(static)
+    for (size_t k = 0; k < entries.len; ++k) {
+#pragma omp atomic
+        self->row_ptr[entries.rows[k] + 1] += 1;
+        if (!is_general && entries.rows[k] != entries.cols[k]) {
+#pragma omp atomic
+            self->row_ptr[entries.cols[k] + 1] += 1;
+        }
+    }
+    for (size_t i = 0; i < file.rows; ++i) {
+        self->row_ptr[i + 1] += self->row_ptr[i];
+    }
+    memcpy(fill, self->row_ptr, (file.rows + 1) * sizeof(size_t));
+
+    // Scatter the entries into their row, then restore the column order
+    double const mirror = file.symmetry == MTX_SKEW_SYMMETRIC ? -1.0 : 1.0;
+#pragma omp parallel for schedule(static)
+    for (size_t k = 0; k < entries.len; ++k) {
+        size_t const i = entries.rows[k];
+        size_t const j = entries.cols[k];
+        size_t pos;
+#pragma omp atomic capture
+        pos = fill[i]++;
+        self->col_idx[pos] = j;
+        self->values[pos] = entries.values[k];
+
+        if (!is_general && i != j) {
+#pragma omp atomic capture
+            pos = fill[j]++;
+            self->col_idx[pos] = i;
+            self->values[pos] = mirror * entries.values[k];
+        }
+    }
+    csr_sort_rows(self);
+
+    free(fill);
+    mtx_close(&file, &entries);
+    return self;
+}
@@ -0,0 +1,359 @@
+#include "ooc.h"
+#include "utils.h"
+
+#include <cblas.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+ooc_matrix_t* ooc_open(char const* filename)
+{
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "error: failed to open file `%s`\n", filename);
+        return NULL;
+    }
+
+    matrix_file_header_t header;
+    if (matrix_file_header_read(fd, &header) != 0) {
+        fprintf(stderr, "error: `%s` is not a valid binary matrix file\n", filename);
+        close(fd);
+        return NULL;
+    }
+
+    ooc_matrix_t* self = malloc(sizeof(ooc_matrix_t));
+    if (!self) {
+        close(fd);
+        return NULL;
+    }
+
+    // Tiles are read once, front to back: let the kernel read ahead
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+    self->fd = fd;
+    self->rows = header.rows;
+    self->cols = header.cols;
+    self->layout = (layout_t)(header.layout);
+    self->data_offset = header.data_offset;
+    return self;
+}
+
+void ooc_close(ooc_matrix_t* self)
+{
+    if (self) {
+        close(self->fd);
+        free(self);
+    }
+}
+
+/**
+ * Multiplies a tile of `count` rows or columns, starting at `first`.
+ **/
+typedef void (*tile_fn)(void* ctx, ooc_matrix_t const* A, double const* tile, size_t first,
+                        size_t count);
+
+/**
+ * State shared by the compute thread and the reader thread. Tile `t` is
+ * read into `buffers[t % 2]`, which is handed over through `ready`: the
+ * reader sets it once the tile is loaded, the compute thread clears it once
+ * the tile is multiplied.
+ **/
+typedef struct reader_s {
+    ooc_matrix_t const* A;
+    size_t unit_bytes;
+    size_t nb_units;
+    size_t units_per_tile;
+    size_t nb_tiles;
+    double* buffers[2];
+    bool ready[2];
+    bool stop;
+    int status;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    size_t bytes_read;
+    double io;
+} reader_t;
+
+/**
+ * Reads exactly `len` bytes at `offset`, retrying on short reads.
+ **/
+static int read_full(int fd, void* buf, size_t len, size_t offset)
+{
+    unsigned char* dst = buf;
+    while (len > 0) {
+        ssize_t nb_read = pread(fd, dst, len, (off_t)(offset));
+        if (nb_read < 0 && errno == EINTR)
+            continue;
+        if (nb_read <= 0)
+            return -1;
+        dst += nb_read;
+        offset += (size_t)(nb_read);
+        len -= (size_t)(nb_read);
+    }
+    return 0;
+}
+
+static void* reader_run(void* arg)
+{
+    reader_t* self = arg;
+    for (size_t t = 0; t < self->nb_tiles; ++t) {
+        size_t const b = t & 1;
+        pthread_mutex_lock(&self->lock);
+        while (self->ready[b] && !self->stop) {
+            pthread_cond_wait(&self->cond, &self->lock);
+        }
+        bool const stop = self->stop;
+        pthread_mutex_unlock(&self->lock);
+        if (stop)
+            break;
+
+        size_t const first = t * self->units_per_tile;
+        size_t const count = first + self->units_per_tile < self->nb_units
+                                 ? self->units_per_tile
+                                 : self->nb_units - first;
+        size_t const len = count * self->unit_bytes;
+        size_t const offset = self->A->data_offset + first * self->unit_bytes;
+
+        instant_t start = instant_now();
+        int status = read_full(self->A->fd, self->buffers[b], len, offset);
+        instant_t stop_io = instant_now();
+        // Each tile is read once, do not let it evict more useful pages
+        posix_fadvise(self->A->fd, (off_t)(offset), (off_t)(len), POSIX_FADV_DONTNEED);
+
+        pthread_mutex_lock(&self->lock);
+        self->io += compute_avg_latency(start, stop_io, 1);
+        self->bytes_read += status == 0 ? len : 0;
+        self->status = status;
+        self->ready[b] = true;
+        pthread_cond_broadcast(&self->cond);
+        pthread_mutex_unlock(&self->lock);
+        if (status != 0)
+            break;
+    }
+    return NULL;
+}
+
+/**
+ * Streams the tiles of `A` through `fn`, in order, while the next tile is
+ * read by a dedicated thread.
+ **/
+static int ooc_stream(ooc_matrix_t const* A, size_t tile_bytes, tile_fn fn, void* ctx,
+                      ooc_stats_t* stats)
+{
+    instant_t start = instant_now();
+    reader_t reader = {
+        .A = A,
+        .unit_bytes = (A->layout == ROW_MAJOR ? A->cols : A->rows) * sizeof(double),
+        .nb_units = A->layout == ROW_MAJOR ? A->rows : A->cols,
+    };
+    if (reader.unit_bytes == 0 || reader.nb_units == 0)
+        return 0;
+    // At least one row or column per tile, at most the whole matrix
+    reader.units_per_tile = tile_bytes / reader.unit_bytes;
+    if (reader.units_per_tile == 0) {
+        reader.units_per_tile = 1;
+    }
+    if (reader.units_per_tile > reader.nb_units) {
+        reader.units_per_tile = reader.nb_units;
+    }
+    reader.nb_tiles = (reader.nb_units + reader.units_per_tile - 1) / reader.units_per_tile;
+
+    // `aligned_alloc` requires a size multiple of the alignment
+    size_t const buf_size =
+        (reader.units_per_tile * reader.unit_bytes + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+    reader.buffers[0] = aligned_alloc(ALIGNMENT, buf_size);
+    reader.buffers[1] = aligned_alloc(ALIGNMENT, buf_size);
+    if (!reader.buffers[0] || !reader.buffers[1]) {
+        free(reader.buffers[0]);
+        free(reader.buffers[1]);
+        return -1;
+    }
+    pthread_mutex_init(&reader.lock, NULL);
+    pthread_cond_init(&reader.cond, NULL);
+
+    pthread_t thread;
+    bool const started = pthread_create(&thread, NULL, reader_run, &reader) == 0;
+    int ret = started ? 0 : -1;
+    double wait = 0.0;
+    double compute = 0.0;
+    for (size_t t = 0; ret == 0 && t < reader.nb_tiles; ++t) {
+        size_t const b = t & 1;
+        instant_t wait_start = instant_now();
+        pthread_mutex_lock(&reader.lock);
+        while (!reader.ready[b]) {
+            pthread_cond_wait(&reader.cond, &reader.lock);
+        }
+        ret = reader.status;
+        pthread_mutex_unlock(&reader.lock);
+        instant_t wait_stop = instant_now();
+        wait += compute_avg_latency(wait_start, wait_stop, 1);
+        if (ret != 0)
+            break;
+
+        size_t const first = t * reader.units_per_tile;
+        size_t const count = first + reader.units_per_tile < reader.nb_units
+                                 ? reader.units_per_tile
+                                 : reader.nb_units - first;
+        fn(ctx, A, reader.buffers[b], first, count);
+        instant_t compute_stop = instant_now();
+        compute += compute_avg_latency(wait_stop, compute_stop, 1);
+
+        pthread_mutex_lock(&reader.lock);
+        reader.ready[b] = false;
+        pthread_cond_broadcast(&reader.cond);
+        pthread_mutex_unlock(&reader.lock);
+    }
+
+    if (started) {
+        // Wakes the reader up if it is still waiting for a free buffer
+        pthread_mutex_lock(&reader.lock);
+        reader.stop = true;
+        pthread_cond_broadcast(&reader.cond);
+        pthread_mutex_unlock(&reader.lock);
+        pthread_join(thread, NULL);
+    }
+    if (ret != 0) {
+        fprintf(stderr, "error: failed to stream binary matrix file\n");
+    }
+
+    pthread_cond_destroy(&reader.cond);
+    pthread_mutex_destroy(&reader.lock);
+    free(reader.buffers[0]);
+    free(reader.buffers[1]);
+
+    if (stats) {
+        instant_t stop = instant_now();
+        stats->bytes_read = reader.bytes_read;
+        stats->nb_tiles = reader.nb_tiles;
+        stats->io = reader.io;
+        stats->compute = compute;
+        stats->wait = wait;
+        stats->total = compute_avg_latency(start, stop, 1);
+    }
+    return ret;
+}
+
+typedef struct dgemv_ctx_s {
+    double alpha;
+    double beta;
+    double const* x;
+    double* y;
+} dgemv_ctx_t;
+
+static void dgemv_tile(void* arg, ooc_matrix_t const* A, double const* tile, size_t first,
+                       size_t count)
+{
+    dgemv_ctx_t const* ctx = arg;
+    if (A->layout == ROW_MAJOR) {
+        // Rows `first..first + count` of `A` give the same rows of `y`
+        cblas_dgemv(CblasRowMajor, CblasNoTrans, count, A->cols, ctx->alpha, tile, A->cols,
+                    ctx->x, 1, ctx->beta, ctx->y + first, 1);
+    }
+    else {
+        // Columns `first..first + count` of `A` add up to the whole of `y`
+        cblas_dgemv(CblasColMajor, CblasNoTrans, A->rows, count, ctx->alpha, tile, A->rows,
+                    ctx->x + first, 1, 1.0, ctx->y, 1);
+    }
+}
+
+/**
+ * Computes `y = beta * y`, without reading `y` if `beta` is zero.
+ **/
+static void scale(size_t len, double beta, double* y)
+{
+    if (beta == 0.0) {
+        memset(y, 0, len * sizeof(double));
+    }
+    else if (beta != 1.0) {
+        cblas_dscal(len, beta, y, 1);
+    }
+}
+
+int ooc_dgemv(double alpha, ooc_matrix_t const* A, double const* x, double beta, double* y,
+              size_t tile_bytes, ooc_stats_t* stats)
+{
+    dgemv_ctx_t ctx = { .alpha = alpha, .beta = beta, .x = x, .y = y };
+    if (A->layout == COL_MAJOR) {
+        scale(A->rows, beta, y);
+    }
+    return ooc_stream(A, tile_bytes, dgemv_tile, &ctx, stats);
+}
+
+typedef struct dgemm_ctx_s {
+    double alpha;
+    double beta;
+    matrix_t const* B;
+    matrix_t* C;
+} dgemm_ctx_t;
+
+static void dgemm_tile(void* arg, ooc_matrix_t const* A, double const* tile, size_t first,
+                       size_t count)
+{
+    dgemm_ctx_t const* ctx = arg;
+    size_t const p = ctx->B->cols;
+    size_t const ldb = ctx->B->ld;
+    size_t const ldc = ctx->C->ld;
+    if (A->layout == ROW_MAJOR) {
+        cblas_dgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, count, p, A->cols, ctx->alpha, tile,
+                    A->cols, ctx->B->data, ldb, ctx->beta, ctx->C->data + first * ldc, ldc);
+    }
+    else {
+        // A column-major tile is the transpose of a row-major one
+        cblas_dgemm(CblasRowMajor, CblasTrans, CblasNoTrans, A->rows, p, count, ctx->alpha, tile,
+                    A->rows, ctx->B->data + first * ldb, ldb, 1.0, ctx->C->data, ldc);
+    }
+}
+
+int ooc_dgemm(double alpha, ooc_matrix_t const* A, matrix_t const* B, double beta, matrix_t* C,
+              size_t tile_bytes, ooc_stats_t* stats)
+{
+    if (B->layout != ROW_MAJOR || C->layout != ROW_MAJOR || B->rows != A->cols ||
+        C->rows != A->rows || C->cols != B->cols) {
+        fprintf(stderr, "error: mismatching operands for out-of-core dgemm\n");
+        return -1;
+    }
+
+    dgemm_ctx_t ctx = { .alpha = alpha, .beta = beta, .B = B, .C = C };
+    if (A->layout == COL_MAJOR) {
+        for (size_t i = 0; i < C->rows; ++i) {
+            scale(C->cols, beta, C->data + i * C->ld);
+        }
+    }
+    return ooc_stream(A, tile_bytes, dgemm_tile, &ctx, stats);
+}
+
+double ooc_io_bandwidth(ooc_stats_t const* stats)
+{
+    double io_s = stats->io / 1e9; // convert to seconds
+    return io_s > 0.0 ? (double)(stats->bytes_read) / (double)(ONE_GIB) / io_s : 0.0;
+}
+
+double ooc_overlap(ooc_stats_t const* stats)
+{
+    double const shorter = stats->io < stats->compute ? stats->io : stats->compute;
+    if (shorter <= 0.0)
+        return 0.0;
+    double const hidden = stats->io + stats->compute - stats->total;
+    double const overlap = hidden / shorter;
+    return overlap < 0.0 ? 0.0 : (overlap > 1.0 ? 1.0 : overlap);
+}
+
+int ooc_stats_dump(char const* title, ooc_stats_t const* stats, char const* filename)
+{
+    if (!stats) return -1;
+
+    FILE* ofp = (filename == NULL) ? stdout : fopen(filename, "ab");
+    if (!ofp) return -1;
+
+    fprintf(ofp, "%s; %zu; %2.3lf; %2.3lf%%\n", title, stats->nb_tiles, ooc_io_bandwidth(stats),
+            ooc_overlap(stats) * 100.0);
+
+    if (filename) {
+        fclose(ofp);
+    }
+    return 0;
+}
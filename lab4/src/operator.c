@@ -0,0 +1,157 @@
+#include "operator.h"
+
+#include <cblas.h>
+#include <math.h>
+
+static void matrix_apply(size_t n, void const* ctx, double const* x, size_t incx, double* y)
+{
+    matrix_t const* A = ctx;
+    CBLAS_ORDER const order = A->layout == ROW_MAJOR ? CblasRowMajor : CblasColMajor;
+    cblas_dgemv(order, CblasNoTrans, n, n, 1.0, A->data, A->ld, x, incx, 0.0, y, 1);
+}
+
+static void sparse_apply(size_t n, void const* ctx, double const* x, size_t incx, double* y)
+{
+    (void)(n);
+    sparse_spmv(1.0, ctx, x, incx, 0.0, y);
+}
+
+operator_t operator_from_matrix(matrix_t const* A)
+{
+    return (operator_t){ .n = A->rows, .apply = matrix_apply, .ctx = A };
+}
+
+operator_t operator_from_sparse(sparse_t const* A)
+{
+    return (operator_t){ .n = sparse_rows(A), .apply = sparse_apply, .ctx = A };
+}
+
+laplacian_t laplacian_init(size_t dim, size_t side)
+{
+    return (laplacian_t){
+        .dim = dim,
+        .nx = side,
+        .ny = dim >= 2 ? side : 1,
+        .nz = dim >= 3 ? side : 1,
+    };
+}
+
+size_t laplacian_size(laplacian_t const* self)
+{
+    return self->nx * self->ny * self->nz;
+}
+
+double laplacian_min_eigval(laplacian_t const* self)
+{
+    size_t const sides[3] = { self->nx, self->ny, self->nz };
+    double lambda = 0.0;
+    for (size_t d = 0; d < self->dim; ++d) {
+        lambda += 2.0 - 2.0 * cos(M_PI / (double)(sides[d] + 1));
+    }
+    return lambda;
+}
+
+double laplacian_max_eigval(laplacian_t const* self)
+{
+    size_t const sides[3] = { self->nx, self->ny, self->nz };
+    double lambda = 0.0;
+    for (size_t d = 0; d < self->dim; ++d) {
+        lambda += 2.0 + 2.0 * cos(M_PI / (double)(sides[d] + 1));
+    }
+    return lambda;
+}
+
+/**
+ * Computes the rows of `y = -Δ x` with a stride of `incx` on `x`. Inlined in
+ * `laplacian_apply` for `incx == 1`, so that the unit-stride case, that of
+ * every column-major basis, is vectorized with contiguous loads.
+ **/
+static inline __attribute__((always_inline)) void
+laplacian_kernel(laplacian_t const* grid, double const* restrict x, size_t incx,
+                 double* restrict y)
+{
+    size_t const nx = grid->nx;
+    size_t const ny = grid->ny;
+    size_t const nz = grid->nz;
+    double const diag = 2.0 * (double)(grid->dim);
+    if (nx == 0)
+        return;
+
+    // A single row, which is split across threads instead
+    if (ny * nz == 1) {
+        y[0] = diag * x[0] - (nx > 1 ? x[incx] : 0.0);
+#pragma omp parallel for simd schedule(static)
+        for (size_t i = 1; i < nx - 1; ++i) {
+            y[i] = diag * x[i * incx] - x[(i - 1) * incx] - x[(i + 1) * incx];
+        }
+        if (nx > 1) {
+            y[nx - 1] = diag * x[(nx - 1) * incx] - x[(nx - 2) * incx];
+        }
+        return;
+    }
+
+#pragma omp parallel for collapse(2) schedule(static)
+    for (size_t k = 0; k < nz; ++k) {
+        for (size_t j = 0; j < ny; ++j) {
+            size_t const row = (k * ny + j) * nx;
+            double const* restrict xr = x + row * incx;
+            double* restrict yr = y + row;
+
+            // Centre and neighbours along x, zero past the boundary
+            yr[0] = diag * xr[0] - (nx > 1 ? xr[incx] : 0.0);
+#pragma omp simd
+            for (size_t i = 1; i < nx - 1; ++i) {
+                yr[i] = diag * xr[i * incx] - xr[(i - 1) * incx] - xr[(i + 1) * incx];
+            }
+            if (nx > 1) {
+                yr[nx - 1] = diag * xr[(nx - 1) * incx] - xr[(nx - 2) * incx];
+            }
+
+            // Neighbours along y and z, whole rows at a time
+            if (j > 0) {
+                double const* restrict xs = xr - nx * incx;
+#pragma omp simd
+                for (size_t i = 0; i < nx; ++i) {
+                    yr[i] -= xs[i * incx];
+                }
+            }
+            if (j + 1 < ny) {
+                double const* restrict xs = xr + nx * incx;
+#pragma omp simd
+                for (size_t i = 0; i < nx; ++i) {
+                    yr[i] -= xs[i * incx];
+                }
+            }
+            if (k > 0) {
+                double const* restrict xs = xr - nx * ny * incx;
+#pragma omp simd
+                for (size_t i = 0; i < nx; ++i) {
+                    yr[i] -= xs[i * incx];
+                }
+            }
+            if (k + 1 < nz) {
+                double const* restrict xs = xr + nx * ny * incx;
+#pragma omp simd
+                for (size_t i = 0; i < nx; ++i) {
+                    yr[i] -= xs[i * incx];
+                }
+            }
+        }
+    }
+}
+
+static void laplacian_apply(size_t n, void const* ctx, double const* x, size_t incx, double* y)
+{
+    (void)(n);
+    if (incx == 1) {
+        laplacian_kernel(ctx, x, 1, y);
+    }
+    else {
+        laplacian_kernel(ctx, x, incx, y);
+    }
+}
+
+operator_t laplacian_operator(laplacian_t const* self)
+{
+    return (operator_t){ .n = laplacian_size(self), .apply = laplacian_apply, .ctx = self };
+}
@@ -0,0 +1,515 @@
+#include "sparse.h"
+#include "utils.h"
+
+#include <stdlib.h>
+
+// Rows up to this length are sorted by insertion, longer ones with a heap sort
+#define CSR_INSERTION_SORT_LEN 32
+
+csr_t* csr_init(size_t rows, size_t cols, size_t nnz)
+{
+    csr_t* self = malloc(sizeof(csr_t));
+    if (!self)
+        return NULL;
+
+    self->rows = rows;
+    self->cols = cols;
+    self->nnz = nnz;
+    self->row_ptr = calloc(rows + 1, sizeof(size_t));
+    // `aligned_alloc` requires a size multiple of the alignment
+    size_t const idx_size = (nnz * sizeof(size_t) + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+    size_t const val_size = (nnz * sizeof(double) + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+    self->col_idx = aligned_alloc(ALIGNMENT, idx_size != 0 ? idx_size : ALIGNMENT);
+    self->values = aligned_alloc(ALIGNMENT, val_size != 0 ? val_size : ALIGNMENT);
+    if (!self->row_ptr || !self->col_idx || !self->values) {
+        csr_deinit(self);
+        return NULL;
+    }
+
+    return self;
+}
+
+void csr_deinit(csr_t* self)
+{
+    if (self) {
+        free(self->row_ptr);
+        free(self->col_idx);
+        free(self->values);
+        free(self);
+    }
+}
+
+static inline void swap_entries(size_t* col, double* val, size_t a, size_t b)
+{
+    size_t c = col[a];
+    col[a] = col[b];
+    col[b] = c;
+    double v = val[a];
+    val[a] = val[b];
+    val[b] = v;
+}
+
+/**
+ * Restores the max-heap property of `col[0..len[` below `root`, moving the
+ * values along with their column index.
+ **/
+static void sift_down(size_t* col, double* val, size_t root, size_t len)
+{
+    for (;;) {
+        size_t child = 2 * root + 1;
+        if (child >= len)
+            return;
+        if (child + 1 < len && col[child + 1] > col[child]) {
+            child += 1;
+        }
+        if (col[root] >= col[child])
+            return;
+        swap_entries(col, val, root, child);
+        root = child;
+    }
+}
+
+/**
+ * Sorts `len` entries by column index, in place and without allocating.
+ **/
+static void sort_entries(size_t* col, double* val, size_t len)
+{
+    if (len <= CSR_INSERTION_SORT_LEN) {
+        for (size_t i = 1; i < len; ++i) {
+            size_t c = col[i];
+            double v = val[i];
+            size_t j = i;
+            for (; j > 0 && col[j - 1] > c; --j) {
+                col[j] = col[j - 1];
+                val[j] = val[j - 1];
+            }
+            col[j] = c;
+            val[j] = v;
+        }
+        return;
+    }
+
+    for (size_t i = len / 2; i-- > 0;) {
+        sift_down(col, val, i, len);
+    }
+    for (size_t end = len - 1; end > 0; --end) {
+        swap_entries(col, val, 0, end);
+        sift_down(col, val, 0, end);
+    }
+}
+
+void csr_sort_rows(csr_t* self)
+{
+#pragma omp parallel for schedule(dynamic, 256)
+    for (size_t i = 0; i < self->rows; ++i) {
+        size_t const begin = self->row_ptr[i];
+        sort_entries(self->col_idx + begin, self->values + begin, self->row_ptr[i + 1] - begin);
+    }
+}
+
+csr_t* csr_from_dense(matrix_t const* mat)
+{
+    size_t nnz = 0;
+    for (size_t i = 0; i < mat->rows; ++i) {
+        for (size_t j = 0; j < mat->cols; ++j) {
+            nnz += mat->data[matrix_index(mat, i, j)] != 0.0;
+        }
+    }
+
+    csr_t* self = csr_init(mat->rows, mat->cols, nnz);
+    if (!self)
+        return NULL;
+
+    size_t k = 0;
+    for (size_t i = 0; i < mat->rows; ++i) {
+        for (size_t j = 0; j < mat->cols; ++j) {
+            double const a_ij = mat->data[matrix_index(mat, i, j)];
+            if (a_ij != 0.0) {
+                self->col_idx[k] = j;
+                self->values[k] = a_ij;
+                k += 1;
+            }
+        }
+        self->row_ptr[i + 1] = k;
+    }
+
+    return self;
+}
+
+csr_t* csr_rand_init(size_t n, size_t nnz_per_row)
+{
+    if (nnz_per_row == 0 || nnz_per_row > n) {
+        nnz_per_row = n;
+    }
+
+    csr_t* self = csr_init(n, n, n * nnz_per_row);
+    if (!self)
+        return NULL;
+
+    uint64_t const key = splitmix64(n ^ splitmix64(nnz_per_row));
+#pragma omp parallel for schedule(static)
+    for (size_t i = 0; i < n; ++i) {
+        size_t const begin = i * nnz_per_row;
+        self->row_ptr[i + 1] = begin + nnz_per_row;
+        self->col_idx[begin] = i;
+        self->values[begin] = counter_double_range(key, 2 * begin, -1.0, 1.0);
+        for (size_t k = begin + 1; k < begin + nnz_per_row; ++k) {
+            // Duplicate columns are kept as is, SpMV sums them up
+            self->col_idx[k] = splitmix64(key ^ splitmix64(2 * k + 1)) % n;
+            self->values[k] = counter_double_range(key, 2 * k, -1.0, 1.0);
+        }
+    }
+    csr_sort_rows(self);
+
+    return self;
+}
+
+void csr_diagonal(csr_t const* A, double* d)
+{
+#pragma omp parallel for schedule(static)
+    for (size_t i = 0; i < A->rows; ++i) {
+        d[i] = 0.0;
+        for (size_t k = A->row_ptr[i]; k < A->row_ptr[i + 1]; ++k) {
+            d[i] += A->col_idx[k] == i ? A->values[k] : 0.0;
+        }
+    }
+}
+
+bool csr_is_symmetric(csr_t const* A)
+{
+    if (A->rows != A->cols)
+        return false;
+
+    // Rows are sorted by column, so a_ji is found by bisection in row `j`
+    bool symmetric = true;
+#pragma omp parallel for schedule(guided, 64) reduction(&& : symmetric)
+    for (size_t i = 0; i < A->rows; ++i) {
+        for (size_t k = A->row_ptr[i]; k < A->row_ptr[i + 1] && symmetric; ++k) {
+            size_t const j = A->col_idx[k];
+            size_t lo = A->row_ptr[j];
+            size_t hi = A->row_ptr[j + 1];
+            while (lo < hi) {
+                size_t const mid = lo + (hi - lo) / 2;
+                if (A->col_idx[mid] < i) {
+                    lo = mid + 1;
+                }
+                else {
+                    hi = mid;
+                }
+            }
+            symmetric = lo < A->row_ptr[j + 1] && A->col_idx[lo] == i &&
+                        A->values[lo] == A->values[k];
+        }
+    }
+    return symmetric;
+}
+
+void csr_spmv(double alpha, csr_t const* A, double const* x, size_t incx, double beta,
+              double* y)
+{
+    size_t const* restrict row_ptr = A->row_ptr;
+    size_t const* restrict col_idx = A->col_idx;
+    double const* restrict values = A->values;
+
+    // Rows are independent, a guided schedule evens out irregular row lengths
+#pragma omp parallel for schedule(guided, 64)
+    for (size_t i = 0; i < A->rows; ++i) {
+        double acc = 0.0;
+#pragma omp simd reduction(+ : acc)
+        for (size_t k = row_ptr[i]; k < row_ptr[i + 1]; ++k) {
+            acc += values[k] * x[col_idx[k] * incx];
+        }
+        y[i] = beta == 0.0 ? alpha * acc : alpha * acc + beta * y[i];
+    }
+}
+
+void csr_spmm(double alpha, csr_t const* A, double const* X, size_t ldx, size_t b, double beta,
+              double* Y, size_t ldy)
+{
+    size_t const* restrict row_ptr = A->row_ptr;
+    size_t const* restrict col_idx = A->col_idx;
+    double const* restrict values = A->values;
+
+    // Each row is read from memory once, then from L1 for the other columns
+#pragma omp parallel for schedule(guided, 64)
+    for (size_t i = 0; i < A->rows; ++i) {
+        for (size_t c = 0; c < b; ++c) {
+            double const* restrict x = X + c * ldx;
+            double acc = 0.0;
+#pragma omp simd reduction(+ : acc)
+            for (size_t k = row_ptr[i]; k < row_ptr[i + 1]; ++k) {
+                acc += values[k] * x[col_idx[k]];
+            }
+            double* y = Y + c * ldy;
+            y[i] = beta == 0.0 ? alpha * acc : alpha * acc + beta * y[i];
+        }
+    }
+}
+
+/**
+ * Row length and index, used to sort the rows of a SELL-C-σ window.
+ **/
+typedef struct row_len_s {
+    size_t len;
+    size_t row;
+} row_len_t;
+
+static int cmp_row_len(void const* lhs, void const* rhs)
+{
+    row_len_t const* a = lhs;
+    row_len_t const* b = rhs;
+    // Decreasing length, ties broken by row index to keep the sort stable
+    if (a->len != b->len)
+        return a->len < b->len ? 1 : -1;
+    return (a->row > b->row) - (a->row < b->row);
+}
+
+sell_t* sell_from_csr(csr_t const* csr, size_t chunk_height, size_t sigma)
+{
+    if (csr->cols > (size_t)(UINT32_MAX) + 1 || chunk_height == 0 ||
+        chunk_height > SELL_MAX_CHUNK_HEIGHT)
+        return NULL;
+    if (sigma == 0) {
+        sigma = 1;
+    }
+
+    sell_t* self = calloc(1, sizeof(sell_t));
+    if (!self)
+        return NULL;
+
+    self->rows = csr->rows;
+    self->cols = csr->cols;
+    self->nnz = csr->nnz;
+    self->chunk_height = chunk_height;
+    self->sigma = sigma;
+    self->nb_chunks = (csr->rows + chunk_height - 1) / chunk_height;
+    self->chunk_ptr = malloc((self->nb_chunks + 1) * sizeof(size_t));
+    self->chunk_len = malloc((self->nb_chunks + 1) * sizeof(size_t));
+    self->perm = malloc((csr->rows + 1) * sizeof(size_t));
+    row_len_t* lens = malloc((csr->rows + 1) * sizeof(row_len_t));
+    if (!self->chunk_ptr || !self->chunk_len || !self->perm || !lens) {
+        free(lens);
+        sell_deinit(self);
+        return NULL;
+    }
+
+    // Sort the rows by decreasing length within each window of `sigma` rows
+#pragma omp parallel for schedule(static)
+    for (size_t i = 0; i < csr->rows; ++i) {
+        lens[i].len = csr->row_ptr[i + 1] - csr->row_ptr[i];
+        lens[i].row = i;
+    }
+    for (size_t w = 0; w < csr->rows; w += sigma) {
+        size_t const len = w + sigma < csr->rows ? sigma : csr->rows - w;
+        qsort(lens + w, len, sizeof(row_len_t), cmp_row_len);
+    }
+
+    // Chunks are as wide as their first row, which is the longest one
+    self->chunk_ptr[0] = 0;
+    for (size_t c = 0; c < self->nb_chunks; ++c) {
+        size_t width = 0;
+        for (size_t r = c * chunk_height; r < (c + 1) * chunk_height && r < csr->rows; ++r) {
+            width = lens[r].len > width ? lens[r].len : width;
+        }
+        self->chunk_len[c] = width;
+        self->chunk_ptr[c + 1] = self->chunk_ptr[c] + width * chunk_height;
+    }
+    for (size_t i = 0; i < csr->rows; ++i) {
+        self->perm[i] = lens[i].row;
+    }
+    free(lens);
+
+    size_t const padded_nnz = self->chunk_ptr[self->nb_chunks];
+    // `aligned_alloc` requires a size multiple of the alignment
+    size_t const idx_size = (padded_nnz * sizeof(uint32_t) + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+    size_t const val_size = (padded_nnz * sizeof(double) + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+    self->col_idx = aligned_alloc(ALIGNMENT, idx_size != 0 ? idx_size : ALIGNMENT);
+    self->values = aligned_alloc(ALIGNMENT, val_size != 0 ? val_size : ALIGNMENT);
+    if (!self->col_idx || !self->values) {
+        sell_deinit(self);
+        return NULL;
+    }
+
+#pragma omp parallel for schedule(dynamic, 16)
+    for (size_t c = 0; c < self->nb_chunks; ++c) {
+        for (size_t r = 0; r < chunk_height; ++r) {
+            size_t const pos = c * chunk_height + r;
+            size_t begin = 0;
+            size_t len = 0;
+            if (pos < csr->rows) {
+                begin = csr->row_ptr[self->perm[pos]];
+                len = csr->row_ptr[self->perm[pos] + 1] - begin;
+            }
+            // Padding repeats the last column of the row so that it reads a
+            // cache line that was already loaded
+            uint32_t last = 0;
+            for (size_t k = 0; k < self->chunk_len[c]; ++k) {
+                size_t const dst = self->chunk_ptr[c] + k * chunk_height + r;
+                if (k < len) {
+                    last = (uint32_t)(csr->col_idx[begin + k]);
+                    self->values[dst] = csr->values[begin + k];
+                }
+                else {
+                    self->values[dst] = 0.0;
+                }
+                self->col_idx[dst] = last;
+            }
+        }
+    }
+
+    return self;
+}
+
+void sell_deinit(sell_t* self)
+{
+    if (self) {
+        free(self->chunk_ptr);
+        free(self->chunk_len);
+        free(self->perm);
+        free(self->col_idx);
+        free(self->values);
+        free(self);
+    }
+}
+
+size_t sell_padded_nnz(sell_t const* self)
+{
+    return self->chunk_ptr[self->nb_chunks];
+}
+
+/**
+ * Computes the `C` dot products of a chunk, one per SIMD lane. `C` is a
+ * compile-time constant when inlined from `sell_spmv`, which lets the
+ * compiler keep the accumulators in registers.
+ **/
+static inline void sell_chunk(size_t C, size_t width, uint32_t const* restrict col_idx,
+                              double const* restrict values, double const* restrict x, size_t incx,
+                              double* restrict acc)
+{
+#pragma omp simd
+    for (size_t r = 0; r < C; ++r) {
+        acc[r] = 0.0;
+    }
+    for (size_t k = 0; k < width; ++k) {
+#pragma omp simd
+        for (size_t r = 0; r < C; ++r) {
+            acc[r] += values[k * C + r] * x[col_idx[k * C + r] * incx];
+        }
+    }
+}
+
+void sell_spmv(double alpha, sell_t const* A, double const* x, size_t incx, double beta,
+               double* y)
+{
+    size_t const C = A->chunk_height;
+
+#pragma omp parallel for schedule(guided, 16)
+    for (size_t c = 0; c < A->nb_chunks; ++c) {
+        double acc[SELL_MAX_CHUNK_HEIGHT] __attribute__((aligned(ALIGNMENT)));
+        size_t const off = A->chunk_ptr[c];
+        if (C == SELL_CHUNK_HEIGHT) {
+            sell_chunk(SELL_CHUNK_HEIGHT, A->chunk_len[c], A->col_idx + off, A->values + off, x,
+                       incx, acc);
+        }
+        else {
+            sell_chunk(C, A->chunk_len[c], A->col_idx + off, A->values + off, x, incx, acc);
+        }
+
+        for (size_t r = 0; r < C && c * C + r < A->rows; ++r) {
+            size_t const i = A->perm[c * C + r];
+            y[i] = beta == 0.0 ? alpha * acc[r] : alpha * acc[r] + beta * y[i];
+        }
+    }
+}
+
+void sell_spmm(double alpha, sell_t const* A, double const* X, size_t ldx, size_t b, double beta,
+               double* Y, size_t ldy)
+{
+    size_t const C = A->chunk_height;
+
+    // Each chunk is read from memory once, then from cache for the other columns
+#pragma omp parallel for schedule(guided, 16)
+    for (size_t c = 0; c < A->nb_chunks; ++c) {
+        double acc[SELL_MAX_CHUNK_HEIGHT] __attribute__((aligned(ALIGNMENT)));
+        size_t const off = A->chunk_ptr[c];
+        for (size_t col = 0; col < b; ++col) {
+            double const* x = X + col * ldx;
+            if (C == SELL_CHUNK_HEIGHT) {
+                sell_chunk(SELL_CHUNK_HEIGHT, A->chunk_len[c], A->col_idx + off, A->values + off,
+                           x, 1, acc);
+            }
+            else {
+                sell_chunk(C, A->chunk_len[c], A->col_idx + off, A->values + off, x, 1, acc);
+            }
+
+            double* y = Y + col * ldy;
+            for (size_t r = 0; r < C && c * C + r < A->rows; ++r) {
+                size_t const i = A->perm[c * C + r];
+                y[i] = beta == 0.0 ? alpha * acc[r] : alpha * acc[r] + beta * y[i];
+            }
+        }
+    }
+}
+
+char const* sparse_format_to_str(sparse_format_t format)
+{
+    switch (format) {
+        case SPARSE_CSR:
+            return "csr";
+        case SPARSE_SELL:
+            return "sell";
+        default:
+            return "unknown";
+    }
+}
+
+size_t sparse_rows(sparse_t const* A)
+{
+    return A->format == SPARSE_CSR ? A->csr->rows : A->sell->rows;
+}
+
+size_t sparse_spmv_bytes(sparse_t const* A)
+{
+    switch (A->format) {
+        case SPARSE_CSR: {
+            csr_t const* csr = A->csr;
+            return csr->nnz * (sizeof(size_t) + sizeof(double)) +
+                   (csr->rows + 1) * sizeof(size_t) + csr->cols * sizeof(double) +
+                   2 * csr->rows * sizeof(double);
+        }
+        case SPARSE_SELL: {
+            sell_t const* sell = A->sell;
+            return sell_padded_nnz(sell) * (sizeof(uint32_t) + sizeof(double)) +
+                   2 * sell->nb_chunks * sizeof(size_t) + sell->rows * sizeof(size_t) +
+                   sell->cols * sizeof(double) + 2 * sell->rows * sizeof(double);
+        }
+        default:
+            return 0;
+    }
+}
+
+void sparse_spmv(double alpha, sparse_t const* A, double const* x, size_t incx, double beta,
+                 double* y)
+{
+    switch (A->format) {
+        case SPARSE_CSR:
+            csr_spmv(alpha, A->csr, x, incx, beta, y);
+            break;
+        case SPARSE_SELL:
+            sell_spmv(alpha, A->sell, x, incx, beta, y);
+            break;
+    }
+}
+
+void sparse_spmm(double alpha, sparse_t const* A, double const* X, size_t ldx, size_t b,
+                 double beta, double* Y, size_t ldy)
+{
+    switch (A->format) {
+        case SPARSE_CSR:
+            csr_spmm(alpha, A->csr, X, ldx, b, beta, Y, ldy);
+            break;
+        case SPARSE_SELL:
+            sell_spmm(alpha, A->sell, X, ldx, b, beta, Y, ldy);
+            break;
+    }
+}
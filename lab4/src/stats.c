@@ -12,6 +12,9 @@ stats_t* stats_init(char const* title, size_t size)
 
     self->title = strdup(title);
     self->size = size;
+    // Set by the drivers that report throughputs
+    self->nb_bytes = 0;
+    self->nb_flops = 0;
     return self;
 }
 
@@ -39,6 +42,10 @@ void stats_compute(stats_t* self)
         self->median = (self->samples[MAX_SAMPLES >> 1] + self->samples[(MAX_SAMPLES >> 1) + 1]) / 2.0;
     }
     self->stddevp = (stddev(self->samples, MAX_SAMPLES) * 100.0) / self->mean;
+
+    double mean_s = self->mean / 1e9; // convert to seconds
+    self->mem_throughput = (double)(self->nb_bytes) / (double)(ONE_GIB) / mean_s;
+    self->ops_throughput = (self->nb_flops / 1e9) / mean_s;
 }
 
 int stats_dump(stats_t const* self, char const* filename)
@@ -48,9 +55,9 @@ int stats_dump(stats_t const* self, char const* filename)
     FILE* ofp = (filename == NULL) ? stdout : fopen(filename, "ab");
     if (!ofp) return -1;
 
-    fprintf(ofp, "%s; %zu; %2.3lf; %2.3lf; %2.3lf; %2.3lf; %2.3lf%%\n",
+    fprintf(ofp, "%s; %zu; %2.3lf; %2.3lf; %2.3lf; %2.3lf; %2.3lf%%; %2.3lf; %2.3lf\n",
             self->title, self->size, self->min, self->mean, self->max,
-            self->median, self->stddevp);
+            self->median, self->stddevp, self->mem_throughput, self->ops_throughput);
 
     if (filename) {
         fclose(ofp);
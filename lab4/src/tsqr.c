@@ -0,0 +1,179 @@
+#include "tsqr.h"
+#include "arena.h"
+
+#include <math.h>
+#include <string.h>
+
+/**
+ * Number of blocks `tsqr` splits `rows` rows into, each of them having at
+ * least `cols` rows so that its `R` factor is square.
+ **/
+static size_t tsqr_nb_blocks(size_t rows, size_t cols)
+{
+    size_t nb = rows / TSQR_BLOCK_ROWS;
+    size_t const max_nb = cols > 0 ? rows / cols : 1;
+    nb = nb < max_nb ? nb : max_nb;
+    return nb > 0 ? nb : 1;
+}
+
+size_t tsqr_workspace(size_t rows, size_t cols)
+{
+    size_t const nb = tsqr_nb_blocks(rows, cols);
+    // Block reflectors factors, stacked `R` factors and their reflectors
+    // factors, explicit `Q` of the stack and the rows being formed
+    return (nb * cols + nb * cols * cols + cols + nb * cols * cols + rows * cols) *
+               sizeof(double) +
+           5 * ALIGNMENT;
+}
+
+/**
+ * Householder QR of the column-major `m * c` matrix `A` (`m >= c`), as
+ * LAPACK `dgeqr2`: `R` is left in the upper triangle and the reflectors
+ * `H_j = I - tau_j v_j v_j^T`, with `v_j[j] = 1`, below the diagonal.
+ **/
+static void householder_qr(size_t m, size_t c, double* A, size_t lda, double* tau)
+{
+    for (size_t j = 0; j < c; ++j) {
+        double* a_j = A + j * lda;
+        double xnrm = 0.0;
+        for (size_t i = j + 1; i < m; ++i) {
+            xnrm += a_j[i] * a_j[i];
+        }
+        xnrm = sqrt(xnrm);
+
+        double const alpha = a_j[j];
+        if (xnrm == 0.0) {
+            tau[j] = 0.0;
+            continue;
+        }
+        double const beta = alpha >= 0.0 ? -hypot(alpha, xnrm) : hypot(alpha, xnrm);
+        tau[j] = (beta - alpha) / beta;
+        double const scale = 1.0 / (alpha - beta);
+        for (size_t i = j + 1; i < m; ++i) {
+            a_j[i] *= scale;
+        }
+        a_j[j] = beta;
+
+        // A[j:, j+1:] -= tau v (v^T A[j:, j+1:])
+        for (size_t l = j + 1; l < c; ++l) {
+            double* a_l = A + l * lda;
+            double dot = a_l[j];
+            for (size_t i = j + 1; i < m; ++i) {
+                dot += a_j[i] * a_l[i];
+            }
+            dot *= tau[j];
+            a_l[j] -= dot;
+            for (size_t i = j + 1; i < m; ++i) {
+                a_l[i] -= dot * a_j[i];
+            }
+        }
+    }
+}
+
+/**
+ * Computes `C = H_0 H_1 ... H_c-1 C` for the `m * c` column-major matrix
+ * `C`, with the reflectors stored by `householder_qr` in `A`.
+ **/
+static void householder_apply(size_t m, size_t c, double const* A, size_t lda,
+                              double const* tau, double* C, size_t ldc)
+{
+    for (size_t j = c; j-- > 0;) {
+        if (tau[j] == 0.0)
+            continue;
+        double const* a_j = A + j * lda;
+        for (size_t l = 0; l < c; ++l) {
+            double* c_l = C + l * ldc;
+            double dot = c_l[j];
+            for (size_t i = j + 1; i < m; ++i) {
+                dot += a_j[i] * c_l[i];
+            }
+            dot *= tau[j];
+            c_l[j] -= dot;
+            for (size_t i = j + 1; i < m; ++i) {
+                c_l[i] -= dot * a_j[i];
+            }
+        }
+    }
+}
+
+int tsqr(size_t rows, size_t cols, double* V, size_t ldv, double* R, size_t ldr, arena_t* ws)
+{
+    if (rows < cols)
+        return -1;
+    if (cols == 0)
+        return 0;
+
+    arena_t* tmp_ws = ws ? NULL : arena_init(tsqr_workspace(rows, cols));
+    arena_t* arena = ws ? ws : tmp_ws;
+    if (!arena)
+        return -1;
+    size_t const mark = arena_mark(arena);
+
+    int ret = -1;
+    size_t const nb = tsqr_nb_blocks(rows, cols);
+    size_t const block_rows = rows / nb;
+    size_t const lds = nb * cols;
+    double* tau = arena_alloc(arena, nb * cols * sizeof(double));
+    double* S = arena_alloc(arena, lds * cols * sizeof(double));
+    double* tau_s = arena_alloc(arena, cols * sizeof(double));
+    double* Q_s = arena_alloc(arena, lds * cols * sizeof(double));
+    double* C = arena_alloc(arena, rows * cols * sizeof(double));
+    if (!tau || !S || !tau_s || !Q_s || !C)
+        goto cleanup;
+
+    // Local factorizations, the last block taking the remaining rows
+#pragma omp parallel for schedule(static)
+    for (size_t b = 0; b < nb; ++b) {
+        size_t const first = b * block_rows;
+        size_t const m = b + 1 < nb ? block_rows : rows - first;
+        householder_qr(m, cols, V + first, ldv, tau + b * cols);
+        for (size_t j = 0; j < cols; ++j) {
+            for (size_t i = 0; i < cols; ++i) {
+                S[j * lds + b * cols + i] = i <= j ? V[j * ldv + first + i] : 0.0;
+            }
+        }
+    }
+
+    // Factorization of the stacked `R` factors, whose explicit `Q` is the
+    // product of `Q_s` with the block diagonal of the local `Q` factors
+    householder_qr(lds, cols, S, lds, tau_s);
+    memset(Q_s, 0, lds * cols * sizeof(double));
+    for (size_t j = 0; j < cols; ++j) {
+        Q_s[j * lds + j] = 1.0;
+    }
+    householder_apply(lds, cols, S, lds, tau_s, Q_s, lds);
+
+#pragma omp parallel for schedule(static)
+    for (size_t b = 0; b < nb; ++b) {
+        size_t const first = b * block_rows;
+        size_t const m = b + 1 < nb ? block_rows : rows - first;
+        double* C_b = C + first;
+        for (size_t j = 0; j < cols; ++j) {
+            memset(C_b + j * rows, 0, m * sizeof(double));
+            memcpy(C_b + j * rows, Q_s + j * lds + b * cols, cols * sizeof(double));
+        }
+        householder_apply(m, cols, V + first, ldv, tau + b * cols, C_b, rows);
+        for (size_t j = 0; j < cols; ++j) {
+            memcpy(V + j * ldv + first, C_b + j * rows, m * sizeof(double));
+        }
+    }
+
+    // Flip the signs so that the diagonal of `R` is nonnegative
+    for (size_t i = 0; i < cols; ++i) {
+        double const sign = S[i * lds + i] < 0.0 ? -1.0 : 1.0;
+        for (size_t j = 0; j < cols; ++j) {
+            R[i * ldr + j] = j >= i ? sign * S[j * lds + i] : 0.0;
+        }
+        if (sign < 0.0) {
+            for (size_t r = 0; r < rows; ++r) {
+                V[i * ldv + r] = -V[i * ldv + r];
+            }
+        }
+    }
+    ret = 0;
+
+cleanup:
+    arena_reset(arena, mark);
+    arena_deinit(tmp_ws);
+    return ret;
+}